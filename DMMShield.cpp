@@ -104,6 +104,7 @@ void DMMShield::end()
 {
 }
 
+#if DMMCONFIG_CMD
 /* ------------------------------------------------------------ */
 /***	void DMMShield::CheckForCommand(void)
 **
@@ -146,7 +147,7 @@ void DMMShield::ProcessIndividualCmd(char *szCmd)
 {
 	DMMCMD_ProcessIndividualCmd(szCmd);
 }
-
+#endif
 
 /***	SetScale
 **
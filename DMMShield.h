@@ -24,6 +24,7 @@
 #if !defined(DMMShield_H)
 #define DMMShield_H
 #include "HardwareSerial.h"
+#include "dmmconfig.h"
 /* ------------------------------------------------------------ */
 /*					Miscellaneous Declarations					*/
 /* ------------------------------------------------------------ */
@@ -53,8 +54,10 @@ class DMMShield
     void begin(HardwareSerial *phwSerial);
 	void end(void);
 	
+#if DMMCONFIG_CMD
 	void CheckForCommand();	
 	void ProcessIndividualCmd(char *szCmd);	
+#endif
 	uint8_t SetScale(int idxScale);
 	uint8_t GetFormattedValue(char *pString);
 };
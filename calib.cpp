@@ -20,6 +20,7 @@
         The data from factory calibration area of EPROM can be later restored and saved in the user calibration area of EPROM.
         The "Interface functions" section groups functions that can also be called by User. These are initialization functions, 
         EPROM functions and calibration procedure functions. 
+        When DMMCONFIG_CALIB is 0 (dmmconfig.h), only the reading of the calibration from EPROM is built.
 
   @Author
     Cristian Fatu 
@@ -34,12 +35,17 @@
 /* ************************************************************************** */
 #include <stdio.h>
 #include <string.h>
+#include "dmmconfig.h"
 #include "dmm.h"
 #include "eprom.h"
 #include "math.h"
 #include "calib.h"
 #include "errors.h"
 #include "utils.h"
+#include "filter.h"
+
+// the calibration measurements are averaged by DMM_DGetAvgValue, which filters at most FILTER_MAX_SAMPLES samples
+static_assert(MEASURE_CNT_AVG <= FILTER_MAX_SAMPLES, "MEASURE_CNT_AVG exceeds the averaging filter buffer");
 
 /* ************************************************************************** */
 /* ************************************************************************** */
@@ -50,6 +56,7 @@
 
 uint8_t CALIB_MeasureForCalibZeroVal(double *pMeasuredVal);
 void CALIB_InitPartCalibData();
+PARTCALIB *CALIB_GetPartCalib(int idxScale);
 uint8_t CALIB_WriteAllCalibsToEPROM_Raw(uint8_t baseAddr);
 uint8_t CALIB_ReadAllCalibsFromEPROM_Raw(CALIBDATA *pCalib, uint8_t baseAddr);
 uint8_t CALIB_VerifyEPROM_Raw(CALIBDATA *pCalib, uint8_t baseAddr);
@@ -72,7 +79,7 @@ uint8_t DMM_FResistorScale(int idxScale);
 uint8_t DMM_FDiodeScale(int idxScale);
 uint8_t DMM_FContinuityScale(int idxScale);
 // errors 
-uint8_t DMM_ERR_CheckIdxCalib(int idxScale);
+uint8_t DMM_ERR_CheckCalibScale(int idxScale);
 // utils
 uint8_t DMM_IsNotANumber(double dVal);
 
@@ -84,7 +91,10 @@ uint8_t DMM_IsNotANumber(double dVal);
 CALIBDATA calib;    // global variable - also visible in dmm.c (where declared as extern)
 
 // global variables - local to this module
-PARTCALIBDATA partCalib;    // partCalib is used to store calibration related values, until all the needed calibration data is present and calibration can be finalized.
+uint8_t bCalibGen = 0;      // incremented each time the calibration coefficients in calib change, it identifies the coefficients used to convert raw codes
+#if DMMCONFIG_CALIB
+PARTCALIBDATA partCalib;    // partCalib is used to store calibration related values for the scale being calibrated, until all the needed calibration data is present and calibration can be finalized.
+#endif
 
 /* ************************************************************************** */
 /* ************************************************************************** */
@@ -118,8 +128,10 @@ uint8_t CALIB_Init()
     // initialize EPROM
     EPROM_Init();
 
+#if DMMCONFIG_CALIB
     // initialize partial calibration data
     CALIB_InitPartCalibData();
+#endif
     
 
     bResult = CALIB_ReadAllCalibsFromEPROM_User();
@@ -129,6 +141,7 @@ uint8_t CALIB_Init()
 
 // EPROM functions
 
+#if DMMCONFIG_CALIB
 /***	CALIB_WriteAllCalibsToEPROM_User
 **
 **	Parameters:
@@ -161,6 +174,8 @@ uint8_t CALIB_WriteAllCalibsToEPROM_User()
     return bResult;
 }
 
+#endif
+
 /***	CALIB_ReadAllCalibsFromEPROM_User
 **
 **	Parameters:
@@ -184,6 +199,7 @@ uint8_t CALIB_ReadAllCalibsFromEPROM_User()
 {
 	uint8_t bResult = CALIB_ReadAllCalibsFromEPROM_Raw(&calib, (uint8_t)ADR_EPROM_CALIB);
 	CALIB_ReplaceCalibNullValues();
+    bCalibGen++;
     return bResult;
 }
 
@@ -209,9 +225,11 @@ uint8_t CALIB_ReadAllCalibsFromEPROM_User()
 */
 uint8_t CALIB_ReadAllCalibsFromEPROM_Factory()
 {
+    bCalibGen++;
     return CALIB_ReadAllCalibsFromEPROM_Raw(&calib, (uint8_t)ADR_EPROM_FACTCALIB);
 }
 
+#if DMMCONFIG_CALIB
 /***	CALIB_RestoreAllCalibsFromEPROM_Factory
 **
 **	Parameters:
@@ -275,19 +293,19 @@ float CALIB_ComputeMult(int idxScale)
     if(fAC)
     {
         // 2 points calib AC
-        fResult = (float)((partCalib.DmmPartCalib[idxScale].Calib_Ref_ValP) / sqrt(pow(partCalib.DmmPartCalib[idxScale].Calib_Ms_ValP, 2) - pow(partCalib.DmmPartCalib[idxScale].Calib_Ms_Zero, 2)) - 1.0);        
+        fResult = (float)((partCalib.DmmPartCalib.Calib_Ref_ValP) / sqrt(pow(partCalib.DmmPartCalib.Calib_Ms_ValP, 2) - pow(partCalib.DmmPartCalib.Calib_Ms_Zero, 2)) - 1.0);        
     }
     else
     {
         if(fDC)
         {
             // 3 points calib DC
-            fResult = (float)((partCalib.DmmPartCalib[idxScale].Calib_Ref_ValP - partCalib.DmmPartCalib[idxScale].Calib_Ref_ValN) / (partCalib.DmmPartCalib[idxScale].Calib_Ms_ValP - partCalib.DmmPartCalib[idxScale].Calib_Ms_ValN) - 1.0);
+            fResult = (float)((partCalib.DmmPartCalib.Calib_Ref_ValP - partCalib.DmmPartCalib.Calib_Ref_ValN) / (partCalib.DmmPartCalib.Calib_Ms_ValP - partCalib.DmmPartCalib.Calib_Ms_ValN) - 1.0);
         }
         if(fResistance || fDiode || fContinuity)
         {
             // 2 points calib Diode, Resistance
-            fResult = (float)(((fResistance || fContinuity? CALIB_RES_ZERO_REFVAL: 0) - partCalib.DmmPartCalib[idxScale].Calib_Ref_ValP) / (partCalib.DmmPartCalib[idxScale].Calib_Ms_Zero - partCalib.DmmPartCalib[idxScale].Calib_Ms_ValP) - 1.0);
+            fResult = (float)(((fResistance || fContinuity? CALIB_RES_ZERO_REFVAL: 0) - partCalib.DmmPartCalib.Calib_Ref_ValP) / (partCalib.DmmPartCalib.Calib_Ms_Zero - partCalib.DmmPartCalib.Calib_Ms_ValP) - 1.0);
         }
     }
     if(DMM_IsNotANumber(fResult))
@@ -324,19 +342,19 @@ float CALIB_ComputeAdd(int idxScale)
     if(fAC)
     {
         // 2 points calib AC
-        fResult = partCalib.DmmPartCalib[idxScale].Calib_Ms_Zero;
+        fResult = partCalib.DmmPartCalib.Calib_Ms_Zero;
     }
     else
     {
         if(fDC)
         {
             // 3 points calib DC
-            fResult = (float)(0 - partCalib.DmmPartCalib[idxScale].Calib_Ms_Zero)*(1.0 + CALIB_ComputeMult(idxScale));
+            fResult = (float)(0 - partCalib.DmmPartCalib.Calib_Ms_Zero)*(1.0 + CALIB_ComputeMult(idxScale));
         }
         if(fResistance || fDiode || fContinuity)
         {
             // 2 points calib Diode, Resistance
-            fResult = (float)((fResistance || fContinuity? CALIB_RES_ZERO_REFVAL: 0) - partCalib.DmmPartCalib[idxScale].Calib_Ms_Zero)*(1.0 + CALIB_ComputeMult(idxScale));
+            fResult = (float)((fResistance || fContinuity? CALIB_RES_ZERO_REFVAL: 0) - partCalib.DmmPartCalib.Calib_Ms_Zero)*(1.0 + CALIB_ComputeMult(idxScale));
         }
     }
     if(DMM_IsNotANumber(fResult))
@@ -356,6 +374,7 @@ float CALIB_ComputeAdd(int idxScale)
 **          ERRVAL_SUCCESS                  0       // success
 **          ERRVAL_DMM_IDXCONFIG            0xFC    // wrong scale index
 **          ERRVAL_DMM_VALIDDATATIMEOUT     0xFA    // valid data DMM timeout
+**          ERRVAL_DMM_OVERLOAD             0xEC    // the measured value is outside the convertor range
 **
 **	Description:
 **		This function performs the measurement for calibration on zero, for the currently selected scale.
@@ -363,6 +382,7 @@ float CALIB_ComputeAdd(int idxScale)
 **      When success, the measured value is stored in the Calib_Ms_Zero field of partCalibData, and it's set as measured value.
 **      If there is no valid current configuration selected, the function returns ERRVAL_DMM_IDXCONFIG and the measured value is set to NAN. 
 **      If a valid measurement cannot be performed, the function returns ERRVAL_DMM_VALIDDATATIMEOUT and the measured value is set to NAN. 
+**      If any of the averaged samples is outside the convertor range, the function returns ERRVAL_DMM_OVERLOAD and the measured value is set to NAN. 
 **      This function is normally called by the CALIB_CalibOnZero function but it can also be called directly by the user.
 **                
 */
@@ -370,17 +390,22 @@ uint8_t CALIB_MeasureForCalibZeroVal(double *pMeasuredVal)
 {
     double dVal;
     int idxScale = DMM_GetCurrentScale();
-	uint8_t bResult = DMM_ERR_CheckIdxCalib(idxScale);
+	uint8_t bResult = DMM_ERR_CheckCalibScale(idxScale);
     if(bResult == ERRVAL_SUCCESS)
     {
         DMM_SetUseCalib(0);
         dVal = DMM_DGetAvgValue(MEASURE_CNT_AVG, &bResult);   // compute average value
         DMM_SetUseCalib(1);
+        if(bResult == ERRVAL_SUCCESS && (dVal == INFINITY || dVal == -INFINITY))
+        {
+            // an overloaded average cannot be used as calibration measurement
+            bResult = ERRVAL_DMM_OVERLOAD;
+        }
 
         if(bResult == ERRVAL_SUCCESS)
         {
             // store the measured value
-            partCalib.DmmPartCalib[idxScale].Calib_Ms_Zero = dVal;
+            CALIB_GetPartCalib(idxScale)->Calib_Ms_Zero = dVal;
         }
     }
     if(bResult != ERRVAL_SUCCESS)
@@ -410,6 +435,7 @@ uint8_t CALIB_MeasureForCalibZeroVal(double *pMeasuredVal)
 **          ERRVAL_SUCCESS                  0       // success
 **          ERRVAL_DMM_IDXCONFIG            0xFC    // wrong scale index
 **          ERRVAL_DMM_VALIDDATATIMEOUT     0xFA    // valid data DMM timeout
+**          ERRVAL_DMM_OVERLOAD             0xEC    // the measured value is outside the convertor range
 **          ERRVAL_DMM_MEASUREDISPERSION    0xF1    // The calibration measurement dispersion exceeds accepted range
 **
 **	Description:
@@ -423,12 +449,13 @@ uint8_t CALIB_MeasureForCalibZeroVal(double *pMeasuredVal)
 **      If dispersion is not in the accepted range then calibration is not finalized, and ERRVAL_DMM_MEASUREDISPERSION is returned.
 **      If there is no valid current configuration selected, the function returns ERRVAL_DMM_IDXCONFIG and the measured value is set to NAN. 
 **      If a valid measurement cannot be performed, the function returns ERRVAL_DMM_VALIDDATATIMEOUT and the measured value is set to NAN. 
+**      If any of the averaged samples is outside the convertor range, the function returns ERRVAL_DMM_OVERLOAD and the measured value is set to NAN. 
 **                
 */
 uint8_t CALIB_CalibOnZero(double *pMeasuredVal)
 {
     int idxScale = DMM_GetCurrentScale();
-	uint8_t bResult = DMM_ERR_CheckIdxCalib(idxScale);
+	uint8_t bResult = DMM_ERR_CheckCalibScale(idxScale);
     // do the measurement now
     if(bResult == ERRVAL_SUCCESS)
     {
@@ -444,7 +471,7 @@ uint8_t CALIB_CalibOnZero(double *pMeasuredVal)
             else
             {
                 // remove the measurement data
-                partCalib.DmmPartCalib[idxScale].Calib_Ms_Zero = NAN;
+                partCalib.DmmPartCalib.Calib_Ms_Zero = NAN;
             }
         }
     }
@@ -461,6 +488,7 @@ uint8_t CALIB_CalibOnZero(double *pMeasuredVal)
 **          ERRVAL_SUCCESS                  0       // success
 **          ERRVAL_DMM_IDXCONFIG            0xFC    // wrong scale index
 **          ERRVAL_DMM_VALIDDATATIMEOUT     0xFA    // valid data DMM timeout
+**          ERRVAL_DMM_OVERLOAD             0xEC    // the measured value is outside the convertor range
 **
 **	Description:
 **		This function performs the measurement for the calibration on positive value procedure, for the currently selected scale.
@@ -468,6 +496,7 @@ uint8_t CALIB_CalibOnZero(double *pMeasuredVal)
 **      When success, the measured value is stored in the Calib_Ms_ValP field of partCalibData structure, and it's set as measured value.
 **      If there is no valid current configuration selected, the function returns ERRVAL_DMM_IDXCONFIG and the measured value is set to NAN. 
 **      If a valid measurement cannot be performed, the function returns ERRVAL_DMM_VALIDDATATIMEOUT and the measured value is set to NAN. 
+**      If any of the averaged samples is outside the convertor range, the function returns ERRVAL_DMM_OVERLOAD and the measured value is set to NAN. 
 **      This function can be called by CALIB_CalibOnPositive or can be called directly, before CALIB_CalibOnPositive (this is considered early measurement).
 **     
 **                
@@ -476,17 +505,22 @@ uint8_t CALIB_MeasureForCalibPositiveVal(double *pMeasuredVal)
 {
     double dVal;
     int idxScale = DMM_GetCurrentScale();
-	uint8_t bResult = DMM_ERR_CheckIdxCalib(idxScale);
+	uint8_t bResult = DMM_ERR_CheckCalibScale(idxScale);
     if(bResult == ERRVAL_SUCCESS)
     {
         DMM_SetUseCalib(0);
         dVal = DMM_DGetAvgValue(MEASURE_CNT_AVG, &bResult);   // compute and get average value
         DMM_SetUseCalib(1);
+        if(bResult == ERRVAL_SUCCESS && (dVal == INFINITY || dVal == -INFINITY))
+        {
+            // an overloaded average cannot be used as calibration measurement
+            bResult = ERRVAL_DMM_OVERLOAD;
+        }
 
         if(bResult == ERRVAL_SUCCESS)
         {
 			// store the measured value
-			partCalib.DmmPartCalib[idxScale].Calib_Ms_ValP = dVal;             
+			CALIB_GetPartCalib(idxScale)->Calib_Ms_ValP = dVal;             
         }
     }
     if(bResult != ERRVAL_SUCCESS)
@@ -512,6 +546,7 @@ uint8_t CALIB_MeasureForCalibPositiveVal(double *pMeasuredVal)
 **          ERRVAL_SUCCESS                  0       // success
 **          ERRVAL_DMM_IDXCONFIG            0xFC    // wrong scale index
 **          ERRVAL_DMM_VALIDDATATIMEOUT     0xFA    // valid data DMM timeout
+**          ERRVAL_DMM_OVERLOAD             0xEC    // the measured value is outside the convertor range
 **          ERRVAL_CALIB_MISSINGMEASUREMENT 0xF0    // A measurement must be performed before calling the finalize calibration function.
 **
 **	Description:
@@ -530,12 +565,13 @@ uint8_t CALIB_MeasureForCalibPositiveVal(double *pMeasuredVal)
 **      When success, the function calls local function CALIB_CheckCompleteCalib, to check if the calibration process is complete.
 **      If there is no valid current configuration selected, the function returns ERRVAL_DMM_IDXCONFIG and the measured value is set to NAN. 
 **      If a valid measurement cannot be performed, the function returns ERRVAL_DMM_VALIDDATATIMEOUT and the measured value is set to NAN. 
+**      If any of the averaged samples is outside the convertor range, the function returns ERRVAL_DMM_OVERLOAD and the measured value is set to NAN. 
 **                
 */
 uint8_t CALIB_CalibOnPositive(double dRefVal, double *pMeasuredVal, uint8_t bEarlyMeasurement)
 {
     int idxScale = DMM_GetCurrentScale();
-	uint8_t bResult = DMM_ERR_CheckIdxCalib(idxScale);
+	uint8_t bResult = DMM_ERR_CheckCalibScale(idxScale);
     if(!bEarlyMeasurement)
     {
         // no early measurement has been done, do the measurement now
@@ -546,9 +582,9 @@ uint8_t CALIB_CalibOnPositive(double dRefVal, double *pMeasuredVal, uint8_t bEar
         // just inform the caller about the existing measurement
         if(pMeasuredVal)
         {
-            *pMeasuredVal = partCalib.DmmPartCalib[idxScale].Calib_Ms_ValP;
+            *pMeasuredVal = CALIB_GetPartCalib(idxScale)->Calib_Ms_ValP;
         }        
-        if(DMM_IsNotANumber(partCalib.DmmPartCalib[idxScale].Calib_Ms_ValP))
+        if(DMM_IsNotANumber(CALIB_GetPartCalib(idxScale)->Calib_Ms_ValP))
         {
             bResult = ERRVAL_CALIB_MISSINGMEASUREMENT;
         }        
@@ -558,7 +594,7 @@ uint8_t CALIB_CalibOnPositive(double dRefVal, double *pMeasuredVal, uint8_t bEar
         bResult = CALIB_ERR_CheckDoubleVal(dRefVal);
         if(bResult == ERRVAL_SUCCESS)
         {
-            partCalib.DmmPartCalib[idxScale].Calib_Ref_ValP = dRefVal;            
+            partCalib.DmmPartCalib.Calib_Ref_ValP = dRefVal;            
         }
         if(bResult == ERRVAL_SUCCESS)
         {
@@ -568,7 +604,7 @@ uint8_t CALIB_CalibOnPositive(double dRefVal, double *pMeasuredVal, uint8_t bEar
         else
         {
             // remove the reference data
-            partCalib.DmmPartCalib[idxScale].Calib_Ref_ValP = NAN;
+            partCalib.DmmPartCalib.Calib_Ref_ValP = NAN;
         }       
     }
     return bResult;
@@ -584,6 +620,7 @@ uint8_t CALIB_CalibOnPositive(double dRefVal, double *pMeasuredVal, uint8_t bEar
 **          ERRVAL_SUCCESS                  0       // success
 **          ERRVAL_DMM_IDXCONFIG            0xFC    // wrong scale index
 **          ERRVAL_DMM_VALIDDATATIMEOUT     0xFA    // valid data DMM timeout
+**          ERRVAL_DMM_OVERLOAD             0xEC    // the measured value is outside the convertor range
 **
 **	Description:
 **		This function performs the measurement for the calibration on negative value procedure, for the currently selected scale.
@@ -591,23 +628,29 @@ uint8_t CALIB_CalibOnPositive(double dRefVal, double *pMeasuredVal, uint8_t bEar
 **      When success, the measured value is stored in the Calib_Ms_ValN field of partCalibData, and it's set as measured value.
 **      If there is no valid current configuration selected, the function returns ERRVAL_DMM_IDXCONFIG and the measured value is set to NAN. 
 **      If a valid measurement cannot be performed, the function returns ERRVAL_DMM_VALIDDATATIMEOUT and the measured value is set to NAN. 
+**      If any of the averaged samples is outside the convertor range, the function returns ERRVAL_DMM_OVERLOAD and the measured value is set to NAN. 
 **                
 */
 uint8_t CALIB_MeasureForCalibNegativeVal(double *pMeasuredVal)
 {
     double dVal;
     int idxScale = DMM_GetCurrentScale();
-	uint8_t bResult = DMM_ERR_CheckIdxCalib(idxScale);
+	uint8_t bResult = DMM_ERR_CheckCalibScale(idxScale);
     if(bResult == ERRVAL_SUCCESS)
     {
         DMM_SetUseCalib(0);
-        dVal = DMM_DGetAvgValue(20, &bResult);   // aquire average value
+        dVal = DMM_DGetAvgValue(MEASURE_CNT_AVG, &bResult);   // aquire average value
         DMM_SetUseCalib(1);
+        if(bResult == ERRVAL_SUCCESS && (dVal == INFINITY || dVal == -INFINITY))
+        {
+            // an overloaded average cannot be used as calibration measurement
+            bResult = ERRVAL_DMM_OVERLOAD;
+        }
 
         if(bResult == ERRVAL_SUCCESS)
         {
 			// store the measured value
-			partCalib.DmmPartCalib[idxScale].Calib_Ms_ValN = dVal;          
+			CALIB_GetPartCalib(idxScale)->Calib_Ms_ValN = dVal;          
         }
     }
     if(bResult != ERRVAL_SUCCESS)
@@ -634,6 +677,7 @@ uint8_t CALIB_MeasureForCalibNegativeVal(double *pMeasuredVal)
 **          ERRVAL_SUCCESS                  0       // success
 **          ERRVAL_DMM_IDXCONFIG            0xFC    // wrong scale index
 **          ERRVAL_DMM_VALIDDATATIMEOUT     0xFA    // valid data DMM timeout
+**          ERRVAL_DMM_OVERLOAD             0xEC    // the measured value is outside the convertor range
 **          ERRVAL_CALIB_MISSINGMEASUREMENT 0xF0    // A measurement must be performed before calling the finalize calibration.
 **
 **	Description:
@@ -649,6 +693,7 @@ uint8_t CALIB_MeasureForCalibNegativeVal(double *pMeasuredVal)
 **      The dispersion is checked to be in the accepted range using DMM_CheckAcceptedMeasurementDispersion function.
 **      If there is no valid current configuration selected, the function returns ERRVAL_DMM_IDXCONFIG and the measured value is set to NAN. 
 **      If a valid measurement cannot be performed, the function returns ERRVAL_DMM_VALIDDATATIMEOUT and the measured value is set to NAN. 
+**      If any of the averaged samples is outside the convertor range, the function returns ERRVAL_DMM_OVERLOAD and the measured value is set to NAN. 
 **      When success, the reference value is stored in the Calib_Ref_ValN field of partCalibData.
 **      When success, the function calls local function CALIB_CheckCompleteCalib, to check if the calibration process is complete.
 **                
@@ -657,7 +702,7 @@ uint8_t CALIB_CalibOnNegative(double dRefVal, double *pMeasuredVal, uint8_t bEar
 {
     int idxScale = DMM_GetCurrentScale();
 
-	uint8_t bResult = DMM_ERR_CheckIdxCalib(idxScale);
+	uint8_t bResult = DMM_ERR_CheckCalibScale(idxScale);
     if(!bEarlyMeasurement)
     {
         // no early measurement has been done, do the measurement now
@@ -668,9 +713,9 @@ uint8_t CALIB_CalibOnNegative(double dRefVal, double *pMeasuredVal, uint8_t bEar
         // just inform the caller about the existing measurement
         if(pMeasuredVal)
         {
-            *pMeasuredVal = partCalib.DmmPartCalib[idxScale].Calib_Ms_ValN;
+            *pMeasuredVal = CALIB_GetPartCalib(idxScale)->Calib_Ms_ValN;
         }
-        if (DMM_IsNotANumber(partCalib.DmmPartCalib[idxScale].Calib_Ms_ValN)) 
+        if (DMM_IsNotANumber(CALIB_GetPartCalib(idxScale)->Calib_Ms_ValN)) 
         {
             bResult = ERRVAL_CALIB_MISSINGMEASUREMENT;
         }
@@ -680,7 +725,7 @@ uint8_t CALIB_CalibOnNegative(double dRefVal, double *pMeasuredVal, uint8_t bEar
         bResult = CALIB_ERR_CheckDoubleVal(dRefVal);
         if(bResult == ERRVAL_SUCCESS)
         {
-            partCalib.DmmPartCalib[idxScale].Calib_Ref_ValN = dRefVal;            
+            partCalib.DmmPartCalib.Calib_Ref_ValN = dRefVal;            
         }
         if(bResult == ERRVAL_SUCCESS)
         {        
@@ -690,7 +735,7 @@ uint8_t CALIB_CalibOnNegative(double dRefVal, double *pMeasuredVal, uint8_t bEar
         else
         {
             // remove the reference data
-            partCalib.DmmPartCalib[idxScale].Calib_Ref_ValN = NAN;
+            partCalib.DmmPartCalib.Calib_Ref_ValN = NAN;
         }
     }
     return bResult;
@@ -772,16 +817,39 @@ uint8_t CALIB_ExportCalibs_Factory(char *szLine, uint8_t idxScale)
 */
 uint8_t CALIB_ImportCalibCoefficients(int idxScale, float fMult, float fAdd)
 {
-    uint8_t bResult = DMM_ERR_CheckIdxCalib(idxScale);
+    uint8_t bResult = DMM_ERR_CheckCalibScale(idxScale);
     if(bResult == ERRVAL_SUCCESS)
     {
         calib.Dmm[idxScale].Mult = fMult;
         calib.Dmm[idxScale].Add = fAdd;
-        partCalib.DmmPartCalib[idxScale].fCalibDirty = 1;   // needs to be written to EPROM  
+        bCalibGen++;
+        partCalib.dwCalibDirty |= ((uint32_t)1 << idxScale);   // needs to be written to EPROM  
     }
     return bResult;
 }
 
+#endif
+
+/***	CALIB_GetCalibGeneration
+**
+**	Parameters:
+**      none
+**
+**	Return Value:
+**		uint8_t     - the calibration generation
+**
+**	Description:
+**		This function returns the calibration generation, a counter incremented each time the calibration coefficients 
+**      are changed (read from EPROM, imported or computed by a calibration). 
+**      It is attached to the raw codes returned by DMM_GetRawCode, so that the codes converted later 
+**      can be matched with the calibration coefficients that were in use when they were acquired.
+**                    
+*/
+uint8_t CALIB_GetCalibGeneration()
+{
+    return bCalibGen;
+}
+
 
 /***	CALIB_VerifyEPROM
 **
@@ -820,6 +888,7 @@ uint8_t CALIB_VerifyEPROM()
 /* ************************************************************************** */
 /* ************************************************************************** */
 
+#if DMMCONFIG_CALIB
 /***	CALIB_InitPartCalibData()
 **
 **	Parameters:
@@ -831,6 +900,8 @@ uint8_t CALIB_VerifyEPROM()
 **	Description:
 **		This function initializes the partCalib data, used to store calibration  
 **      values, to be used when all the needed calibration will be present.
+**      The working set is released (not assigned to any scale) and it is going to be 
+**      assigned to a scale by the first calibration measurement, see CALIB_GetPartCalib.
 **      It also clears the dirty flags, used to mark configurations that were calibrated since last save to EPROM.
 **      This function is intended to be called when the application starts 
 **      and every time the calibration data is saved to user space in EPROM
@@ -838,16 +909,38 @@ uint8_t CALIB_VerifyEPROM()
 */
 void CALIB_InitPartCalibData()
 {
-    int idxScale;
-    for(idxScale = 0; idxScale < DMM_CNTSCALES; idxScale++)
+    partCalib.idxScale = -1;
+    partCalib.dwCalibDirty = 0;
+}
+
+/***	CALIB_GetPartCalib
+**
+**	Parameters:
+**		int idxScale    - the Scale index
+**
+**	Return Value:
+**		PARTCALIB *     - pointer to the calibration working set of the specified scale
+**
+**	Description:
+**		This function returns the calibration working set for the specified scale.
+**      Only one scale is calibrated at a time, so the working set is kept for a single scale. 
+**      If the working set belongs to a different scale (or to no scale), it is reassigned to the specified scale 
+**      and all the measured and reference values are set to NAN, meaning that the partial calibration data  
+**      collected for the previous scale is discarded. 
+**          
+*/
+PARTCALIB *CALIB_GetPartCalib(int idxScale)
+{
+    if(partCalib.idxScale != idxScale)
     {
-        partCalib.DmmPartCalib[idxScale].Calib_Ms_Zero = NAN;
-        partCalib.DmmPartCalib[idxScale].Calib_Ms_ValN  = NAN;
-        partCalib.DmmPartCalib[idxScale].Calib_Ref_ValN = NAN;
-        partCalib.DmmPartCalib[idxScale].Calib_Ms_ValP  = NAN;
-        partCalib.DmmPartCalib[idxScale].Calib_Ref_ValP = NAN;
-        partCalib.DmmPartCalib[idxScale].fCalibDirty = 0;
+        partCalib.DmmPartCalib.Calib_Ms_Zero = NAN;
+        partCalib.DmmPartCalib.Calib_Ms_ValN  = NAN;
+        partCalib.DmmPartCalib.Calib_Ref_ValN = NAN;
+        partCalib.DmmPartCalib.Calib_Ms_ValP  = NAN;
+        partCalib.DmmPartCalib.Calib_Ref_ValP = NAN;
+        partCalib.idxScale = idxScale;
     }
+    return &partCalib.DmmPartCalib;
 }
 
 /***	CALIB_WriteAllCalibsToEPROM_Raw
@@ -884,6 +977,8 @@ uint8_t CALIB_WriteAllCalibsToEPROM_Raw(uint8_t baseAddr)
     return bResult;
 }
 
+#endif
+
 /***	CALIB_ReadAllCalibsFromEPROM_Raw
 **
 **	Parameters:
@@ -979,7 +1074,7 @@ uint8_t CALIB_VerifyEPROM_Raw(CALIBDATA *pCalib, uint8_t baseAddr)
     if(bResult == ERRVAL_SUCCESS)
     {
         // success
-        for(i = 0; (i < DMM_CNTSCALES) && (bResult == ERRVAL_SUCCESS); i++)
+        for(i = 0; (i < DMM_CNTCALIBSCALES) && (bResult == ERRVAL_SUCCESS); i++)
         {
             if((calib1.Dmm[i].Add != pCalib->Dmm[i].Add)||(calib1.Dmm[i].Mult != pCalib->Dmm[i].Mult))
             {
@@ -990,6 +1085,7 @@ uint8_t CALIB_VerifyEPROM_Raw(CALIBDATA *pCalib, uint8_t baseAddr)
     return bResult;
 }
 
+#if DMMCONFIG_CALIB
 /***	CALIB_ExportCalibs_Raw
 **
 **	Parameters:
@@ -1004,6 +1100,7 @@ uint8_t CALIB_VerifyEPROM_Raw(CALIBDATA *pCalib, uint8_t baseAddr)
 **          ERRVAL_SUCCESS                  0       // success
 **          ERRVAL_EPROM_MAGICNO            0xFD    // wrong Magic No. when reading data from EPROM
 **          ERRVAL_EPROM_CRC                0xFE    // wrong CRC when reading data from EPROM
+**          ERRVAL_DMM_IDXCONFIG            0xFC    // the scale has no calibration coefficients
 **
 **	Description:
 **		This function is a system function that exports calibration data from a specific location in EPROM for a specific scale.  
@@ -1022,6 +1119,10 @@ uint8_t CALIB_ExportCalibs_Raw(char *szLine, uint8_t baseAddr, uint8_t idxScale)
     uint8_t bResult = 0, curPos;
 	
     CALIBDATA calib1;
+    if(DMM_ERR_CheckCalibScale(idxScale) != ERRVAL_SUCCESS)
+    {
+        return ERRVAL_DMM_IDXCONFIG;
+    }
     // 1. Read data from eprom to calib1
     bResult = CALIB_ReadAllCalibsFromEPROM_Raw(&calib1, baseAddr);
     
@@ -1076,7 +1177,8 @@ uint8_t CALIB_ERR_CheckDoubleVal(double dVal)
 **      For example, for DC configurations, a calibration is complete if 
 **      Calib_Ms_Zero (zero measurement), Calib_Ms_ValP (positive measurement), Calib_Ref_ValP (positive reference), 
 **      Calib_Ms_ValN (negative measurement) and Calib_Ref_ValN (negative reference)
-**      are present. They were previously filled by calls to CALIB_CalibOnZero (or CALIB_MeasureForCalibZeroVal), 
+**      are present in the calibration working set, and the working set belongs to the currently selected scale. 
+**      They were previously filled by calls to CALIB_CalibOnZero (or CALIB_MeasureForCalibZeroVal), 
 **      CALIB_CalibOnPositive (or CALIB_MeasureForCalibPositiveVal) and CALIB_CalibOnNegative (or CALIB_MeasureForCalibNegativeVal).
 **      If the calibration is found to be complete, the calibration coefficients are computed using CALIB_ComputeMult and CALIB_ComputeAdd functions, 
 **      and the scale index is marked as dirty, meaning that calibrations should be written to EPROM user space. 
@@ -1090,13 +1192,13 @@ uint8_t CALIB_CheckCompleteCalib()
     int idxScale = DMM_GetCurrentScale();
 
     
-    if(idxScale >= 0 && idxScale < DMM_CNTSCALES)
+    if(idxScale >= 0 && idxScale < DMM_CNTCALIBSCALES && idxScale == partCalib.idxScale)
     {
-        fCalibZ = !DMM_IsNotANumber(partCalib.DmmPartCalib[idxScale].Calib_Ms_Zero);
-        fCalibP = !DMM_IsNotANumber(partCalib.DmmPartCalib[idxScale].Calib_Ms_ValP) && \
-               !DMM_IsNotANumber(partCalib.DmmPartCalib[idxScale].Calib_Ref_ValP);
-        fCalibN = !DMM_IsNotANumber(partCalib.DmmPartCalib[idxScale].Calib_Ms_ValN) && \
-               !DMM_IsNotANumber(partCalib.DmmPartCalib[idxScale].Calib_Ref_ValN);
+        fCalibZ = !DMM_IsNotANumber(partCalib.DmmPartCalib.Calib_Ms_Zero);
+        fCalibP = !DMM_IsNotANumber(partCalib.DmmPartCalib.Calib_Ms_ValP) && \
+               !DMM_IsNotANumber(partCalib.DmmPartCalib.Calib_Ref_ValP);
+        fCalibN = !DMM_IsNotANumber(partCalib.DmmPartCalib.Calib_Ms_ValN) && \
+               !DMM_IsNotANumber(partCalib.DmmPartCalib.Calib_Ref_ValN);
         fAC = DMM_FACScale(idxScale);
         fDC = DMM_FDCScale(idxScale);
         fDiode = DMM_FDiodeScale(idxScale);
@@ -1109,7 +1211,8 @@ uint8_t CALIB_CheckCompleteCalib()
         {
             calib.Dmm[idxScale].Mult = CALIB_ComputeMult(idxScale);            
             calib.Dmm[idxScale].Add = CALIB_ComputeAdd(idxScale);
-            partCalib.DmmPartCalib[idxScale].fCalibDirty = 1;   // needs to be written to EPROM
+            bCalibGen++;
+            partCalib.dwCalibDirty |= ((uint32_t)1 << idxScale);   // needs to be written to EPROM
             // fill information text
             sprintf(ERRORS_GetszLastError(), "Coeff: %.6f, %.6f", calib.Dmm[idxScale].Mult, calib.Dmm[idxScale].Add);            
         }
@@ -1134,14 +1237,16 @@ uint8_t CALIB_CntCalibDirty()
 {
     uint8_t bResult = 0;
     int idxScale;
-    for(idxScale = 0; idxScale < DMM_CNTSCALES; idxScale++)
+    for(idxScale = 0; idxScale < DMM_CNTCALIBSCALES; idxScale++)
     {
-        bResult += partCalib.DmmPartCalib[idxScale].fCalibDirty;
-        partCalib.DmmPartCalib[idxScale].fCalibDirty = 0; // reset
+        bResult += (partCalib.dwCalibDirty >> idxScale) & 1;
     }
+    partCalib.dwCalibDirty = 0; // reset
     return bResult;
 }
 
+#endif
+
 /***	CALIB_ReplaceCalibNullValues()
 **
 **	Parameters:
@@ -1158,7 +1263,7 @@ uint8_t CALIB_CntCalibDirty()
 void CALIB_ReplaceCalibNullValues()
 {
     int idxScale;
-	for(idxScale = 0; idxScale < DMM_CNTSCALES; idxScale++)
+	for(idxScale = 0; idxScale < DMM_CNTCALIBSCALES; idxScale++)
 	{
 		if(DMM_IsNotANumber(calib.Dmm[idxScale].Add))
 		{
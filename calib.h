@@ -45,6 +45,7 @@ uint8_t CALIB_VerifyEPROM();
 uint8_t CALIB_ExportCalibs_User(char *szLine, uint8_t idxScale);
 uint8_t CALIB_ExportCalibs_Factory(char *szLine, uint8_t idxScale);
 uint8_t CALIB_ImportCalibCoefficients(int idxScale, float fMult, float fAdd);
+uint8_t CALIB_GetCalibGeneration();
 
 // Calibration procedure functions
 uint8_t CALIB_CalibOnZero(double *pMeasuredVal);
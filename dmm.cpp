@@ -35,14 +35,22 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <stddef.h>
 #include <avr/pgmspace.h>
 #include "math.h"
+#include "dmmconfig.h"
 #include "dmm.h"
+#include "dmmconv.h"
+#include "dmmscales.h"
 #include "calib.h"
 #include "gpio.h"
 #include "spi.h"
 #include "errors.h"
+#include "filter.h"
 #include "utils.h"
+#include "dmmtrace.h"
+#include "perfcnt.h"
+#include "idle.h"
 
 /* ************************************************************************** */
 /* ************************************************************************** */
@@ -57,16 +65,35 @@ void DMM_SendCmdSPI(uint8_t bCmd, int bytesNumber, uint8_t *pbWrData);
 void DMM_GetCmdSPI(uint8_t bCmd, int bytesNumber, uint8_t *pbRdData);
 
 // retrieve value from DMM
-double DMM_DGetStatus(uint8_t *pbErr);
+void DMM_ReadStatus(DMMSTS *pDmmSts);
+double DMM_DWaitValue(DMMSTS *pDmmSts, uint8_t *pbErr);
+double DMM_DReadValue(DMMSTS *pDmmSts, uint8_t *pbErr);
+double DMM_DConvertStatus(DMMSTS *pDmmSts, uint8_t fCntNew);
+int32_t DMM_GetSigned24(uint8_t *pbVal);
+double DMM_DConvertAD1(int32_t vad);
+uint32_t DMM_GetUnsigned24(uint8_t *pbVal);
+uint8_t DMM_UpdateCounters(DMMSTS *pDmmSts);
+double DMM_DGetCounterValue();
+double DMM_DGetFilteredValue(int cbSamples, uint8_t *pbErr);
+uint16_t DMM_WaitConversion();
+uint8_t DMM_ReadIntf(uint8_t bFlag);
+void DMM_LearnConvPeriod(uint32_t dwTime);
+void DMM_UpdateConvState(uint8_t fResult);
 
 // value format
-uint8_t DMM_GetScaleUnit(int idxScale, double *pdScaleFact, char *szUnitPrefix, char *szUnit);
+uint8_t DMM_GetScaleUnit(int idxScale, double *pdScaleFact, char *pcUnitPrefix, PGM_P *pszUnit);
+PGM_P DMM_GetUnitString(int idxScale);
+void DMM_UpdateFormat();
+char *DMM_PrintEng(char *pDst, double dVal, uint8_t cDigits);
 
 // configuration functions
 uint8_t DMM_FACScale(int idxScale);
+uint8_t DMM_GetScaleFamily(int idxScale);
+uint8_t DMM_GetScaleClass(int idxScale);
 double DMM_CompensateVoltage50DCLinear(double dVal);
 // errors 
 uint8_t DMM_ERR_CheckIdxCalib(int idxScale);
+uint8_t DMM_ERR_CheckCalibScale(int idxScale);
 
 // utils
 uint8_t DMM_IsNotANumber(double dVal);
@@ -82,41 +109,44 @@ extern CALIBDATA calib; // defined in calib.c
 // mask unused register bits on configuration verification
 const static uint8_t dmmcfgmask[]={0x1F, 0xFE, 0xFF, 0xFF, 0x9F, 0xFF, 0xFF, 0xBF, 0xFF, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xBC, 0xFC, 0xFF};
 
-// configuration, contains scale specific data
-const static PROGMEM DMMCFG dmmcfg[] = {
-//                                 0,    1,    2,    3,    4,    5,    6,    7,    8,    9,   10,   11,   12,   13,   14,   15,   16,   17,   18,   19,   20,   21,   22,   23,
-//                              INTE,  R20,  R21,  R22,  R23,  R24,  R25,  R26,  R27,  R28,  R29,  R2A,  R2B,  R2C,  R2D,  R2E,  R2F,  R30,  R31,  R32,  R33,  R34,  R35,  R36
-{DmmResistance, 5e7,     1, {0x00, 0xC0, 0xCF, 0x17, 0x93, 0x85, 0x00, 0x00, 0x55, 0x55, 0x00, 0x00, 0x08, 0x00, 0x00, 0x80, 0x86, 0x80, 0xD1, 0x3C, 0xA0, 0x00, 0x00, 0x00}, 6e7 /0.9/8388608      }, // 0 "50M Ohm"
-{DmmResistance, 5e6,     1, {0x00, 0xC0, 0xCF, 0x17, 0x93, 0x85, 0x00, 0x00, 0x55, 0x55, 0x00, 0x00, 0x08, 0x00, 0x80, 0x80, 0x86, 0x80, 0xD1, 0x3C, 0xA0, 0x00, 0x00, 0x00}, 6e6 /0.9/8388608      }, // 1 "5M Ohm"
-{DmmResistance, 5e5,     1, {0x00, 0xC0, 0xCF, 0x17, 0x93, 0x85, 0x00, 0x00, 0x55, 0x55, 0x00, 0x00, 0x08, 0x00, 0x08, 0x80, 0x86, 0x80, 0xD1, 0x33, 0x20, 0x00, 0x00, 0x00}, 6e5 /0.9/8388608      }, // 2 "500k Ohm"
-{DmmResistance, 5e4,     1, {0x00, 0xC0, 0xCF, 0x17, 0x83, 0x85, 0x00, 0x00, 0x55, 0x00, 0x00, 0x00, 0x40, 0x00, 0x06, 0x44, 0x94, 0x80, 0xD3, 0x33, 0x20, 0x00, 0x00, 0x00}, 1e5 /0.9/8388608      }, // 3 "50k Ohm"
-{DmmResistance, 5e3,     1, {0x00, 0xC0, 0xCF, 0x17, 0x83, 0x85, 0x00, 0x00, 0x55, 0x00, 0x00, 0x00, 0x40, 0x60, 0x00, 0x44, 0x94, 0x80, 0xD3, 0x33, 0x20, 0x00, 0x00, 0x00}, 1e4 /0.9/8388608      }, // 4 "5k Ohm"
-{DmmResistance, 5e2,     1, {0x00, 0xC0, 0xCF, 0x17, 0x83, 0x35, 0x00, 0x00, 0x55, 0x00, 0x00, 0x00, 0x40, 0x06, 0x00, 0x44, 0x94, 0x80, 0xD2, 0x3C, 0xA0, 0x00, 0x00, 0x00}, 1e3 /0.9/8388608      }, // 5 "500 Ohm"
-{DmmResistance, 5e1,     1, {0x00, 0xC0, 0xCF, 0x17, 0x83, 0x35, 0x01, 0x00, 0x55, 0x00, 0x00, 0x00, 0x40, 0x06, 0x00, 0x44, 0x94, 0x80, 0xD2, 0x3C, 0xA0, 0x00, 0x00, 0x00}, 1e2 /0.9/8388608      }, // 6 "50 Ohm"
-{DmmDCVoltage, 5e1,      2, {0x00, 0x60, 0x00, 0x17, 0x8B, 0x01, 0x11, 0x00, 0x55, 0x31, 0x00, 0x22, 0x00, 0x00, 0x09, 0x28, 0xA0, 0x80, 0xC7, 0x33, 0x20, 0x00, 0x00, 0x00}, 125e0 /1.8/8388608    }, // 7 "50 V DC",
-{DmmDCVoltage, 5e0,      2, {0x00, 0x60, 0x00, 0x17, 0x8B, 0x01, 0x11, 0x00, 0x55, 0x31, 0x00, 0x22, 0x00, 0x00, 0x90, 0x28, 0xA0, 0x80, 0xC7, 0x33, 0x20, 0x00, 0x00, 0x00}, 125e-1/1.8/8388608    }, //8 "5 V DC",
-{DmmDCVoltage, 5e-1,     1, {0x00, 0xC0, 0x00, 0x17, 0x8B, 0x85, 0x11, 0x00, 0x55, 0x31, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x90, 0x80, 0xC7, 0x33, 0x28, 0x00, 0x00, 0x00}, 125e-2/1.8/8388608    }, //9 "500 mV DC"
-{DmmDCVoltage, 5e-2,     1, {0x00, 0x00, 0x00, 0x17, 0x8B, 0x35, 0x11, 0x00, 0x55, 0x31, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x90, 0x80, 0xC7, 0x3C, 0x60, 0x00, 0x00, 0x00}, 125e-3/1.8/8388608    }, //10 "50 mV DC"
-{DmmACVoltage, 5e1,      2, {0x00, 0xF2, 0xDD, 0x07, 0x03, 0x52, 0x10, 0x80, 0x25, 0x31, 0xF8, 0x22, 0x00, 0x00, 0x0D, 0x28, 0xA0, 0xFF, 0xC7, 0x38, 0x20, 0x00, 0x00, 0x00}, 1e-3                  }, //11 "30 V AC"
-{DmmACVoltage, 5e0,      2, {0x00, 0xF2, 0xDD, 0x07, 0x03, 0x52, 0x10, 0x80, 0x25, 0x31, 0xF8, 0x22, 0x00, 0x00, 0xD0, 0x88, 0xA0, 0xFF, 0xC7, 0x38, 0x20, 0x02, 0x50, 0x0C}, 1e-4                  }, //12 "5 V AC"
-{DmmACVoltage, 5e-1,     1, {0x00, 0x92, 0xDD, 0x07, 0x03, 0x52, 0x10, 0x80, 0x25, 0x11, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x90, 0x80, 0xC7, 0x3A, 0x28, 0x00, 0x00, 0x00}, 1e-5                  }, //13 "500 mV AC"
-{DmmACVoltage, 5e-2,     1, {0x00, 0x52, 0xDD, 0x07, 0x03, 0x00, 0x13, 0x80, 0x25, 0x11, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x90, 0x80, 0xC7, 0x3A, 0x28, 0x00, 0x00, 0x00}, 1e-6                  }, //14 "50 mV AC"
-{DmmDCCurrent, 5e0,      0, {0x00, 0x00, 0x00, 0x17, 0x8B, 0x95, 0x11, 0x00, 0x55, 0x31, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0xC7, 0x33, 0x20, 0x00, 0x00, 0x00}, 125e0/3.6/8388608     }, //15 "5 A DC"
-{DmmACCurrent, 5e0,      0, {0x00, 0x52, 0xDD, 0x07, 0x03, 0x00, 0x13, 0x80, 0x25, 0x11, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x90, 0x80, 0xC7, 0x3D, 0x28, 0x00, 0x00, 0x00}, 1e-4/2.16             }, //16 "5 A AC" 
-{DmmContinuity,500,      1, {0x00, 0x74, 0xCF, 0x17, 0x83, 0x35, 0x10, 0x00, 0x55, 0x00, 0x00, 0x00, 0x00, 0x0A, 0x00, 0x40, 0x86, 0x80, 0xD2, 0x3C, 0xA0, 0x00, 0x00, 0x00}, 666e-7                }, //17 "Continuity
-{DmmDiode,     3.0,      1, {0x00, 0xC0, 0xCF, 0x17, 0x8B, 0x8D, 0x10, 0x00, 0x55, 0x31, 0x00, 0x00, 0x00, 0x08, 0x00, 0x40, 0x86, 0x80, 0xE2, 0x33, 0xA0, 0x00, 0x00, 0x00}, 666e-6                }, //18 "Diode
-{DmmDCLowCurrent, 5e-1,  0, {0x00, 0x00, 0x00, 0x17, 0x8B, 0x95, 0x11, 0x00, 0x55, 0x31, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0xC7, 0x33, 0x20, 0x00, 0x00, 0x00}, 125e-2/1.8/8388608    }, //19 "500 mA DC"
-{DmmDCLowCurrent, 5e-2,  0, {0x00, 0x00, 0x00, 0x17, 0x8B, 0x35, 0x11, 0x00, 0x55, 0x31, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0xC7, 0x3D, 0xA0, 0x00, 0x00, 0x00}, 125e-3/1.8/8388608    }, //20 "50 mA DC"
-{DmmDCLowCurrent, 5e-3,  4, {0x00, 0x00, 0x00, 0x17, 0x8B, 0x95, 0x11, 0x00, 0x55, 0x31, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0xC7, 0x33, 0x20, 0x00, 0x00, 0x00}, 125e-4/1.8/8388608    }, //21 "5 mA DC"
-{DmmDCLowCurrent, 5e-4,  4, {0x00, 0x00, 0x00, 0x17, 0x8B, 0x35, 0x11, 0x00, 0x55, 0x31, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0xC7, 0x3D, 0xA0, 0x00, 0x00, 0x00}, 125e-5/1.8/8388608    }, //22 "500 uA DC"
-{DmmACLowCurrent, 5e-1,  0, {0x00, 0x92, 0xDD, 0x07, 0x03, 0x52, 0x10, 0x80, 0x25, 0x11, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x90, 0x80, 0xC7, 0x3D, 0x28, 0x00, 0x00, 0x00}, 1e-5/1.08             }, //23 "500 mA AC"
-{DmmACLowCurrent, 5e-2,  0, {0x00, 0x52, 0xDD, 0x07, 0x03, 0x00, 0x13, 0x80, 0x25, 0x11, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x90, 0x80, 0xC7, 0x3D, 0x28, 0x00, 0x00, 0x00}, 1e-6/1.08             }, //24 "50 mA AC"
-{DmmACLowCurrent, 5e-3,  4, {0x00, 0x92, 0xDD, 0x07, 0x03, 0x52, 0x10, 0x80, 0x25, 0x11, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x90, 0x80, 0xC7, 0x3D, 0x28, 0x00, 0x00, 0x00}, 1e-7/1.08             }, //25 "5 mA AC"
-{DmmACLowCurrent, 5e-4,  4, {0x00, 0x52, 0xDD, 0x07, 0x03, 0x00, 0x13, 0x80, 0x25, 0x11, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x90, 0x80, 0xC7, 0x3D, 0x28, 0x00, 0x00, 0x00}, 1e-8/1.08             }, //26 "500 uA AC" 
-{0}};
+// configuration, contains scale specific data: dmmcfg, dmmscaleinfo, dmmad2mul, dmmprefix and dmmunits tables, generated in dmmscales.h
+
+// conversion rate profiles, for each scale family: overlay on the AD1 output rate field (R22 bits 2:0), 
+// which is set to its maximum (slowest rate, best resolution) by all the scales in dmmcfg. 
+// The normal profile leaves the scale configuration unaltered.
+// A faster profile changes the convertor decimation, which may change its gain: the scale multipliers (mul, dmmad2mul) 
+// and the calibration are only valid at the normal rate. A profile is added here (and in DMM_RATE_xxx) only once 
+// its rate code and multipliers are measured on the hardware.
+const static PROGMEM DMMRATEOVL dmmrateovl[DMM_CNTFAMILIES][DMM_CNTRATES] = {
+//   DMM_RATE_NORMAL
+    {{3, 0x00, 0x00}},      // DMM_FAMILY_DC
+    {{3, 0x00, 0x00}},      // DMM_FAMILY_AC
+    {{3, 0x00, 0x00}},      // DMM_FAMILY_RES
+};
 DMMCFG curCfg;
 int idxCurrentScale = -1;   // stores the current selected scale
+uint8_t idxPrefix = 2;      // index in dmmprefix of the current scale unit prefix, set by DMM_SetScale
+PGM_P szCurUnit = dmmunit_0; // base unit of the current scale (entry of dmmunits, in flash), set by DMM_SetScale
+uint8_t rgConvRate[DMM_CNTFAMILIES] = {DMM_RATE_NORMAL, DMM_RATE_NORMAL, DMM_RATE_NORMAL};  // conversion rate profile of each scale family
 char fUseCalib = 1;         // controls if calibration coefficients should be applied in DMM_DGetStatus
+uint8_t bAvgFilter = FILTER_NONE;           // the filter used by DMM_DGetAvgValue
+double rgFilterBuf[FILTER_MAX_SAMPLES];     // samples buffer used by the averaging filters
+uint32_t rgCnt[3];          // CTA, CTB, CTC counter values of the last complete gate window
+uint8_t fCntValid = 0;      // set when rgCnt contains a complete gate window, captured on the current scale
+uint32_t dwConvSeq = 0;     // number of conversion results read since DMM_Init, see DMM_GetSample
+uint32_t dwConvTime = 0;    // micros() timestamp of the last conversion result read
+// adaptive wait for the conversion results, see DMM_WaitConversion and DMM_LearnConvPeriod
+uint8_t fAdaptivePoll = 1;
+uint16_t rgwConvPeriod[DMM_CNTSCALES];  // learned conversion period of each scale (DMM_CONVPER_UNIT us), 0 when not learned
+uint32_t dwPollTime = 0;    // micros() timestamp of the last status / INTF read without conversion result
+uint8_t fPollNotReady = 0;  // set when a status / INTF read without conversion result followed the last conversion result
+uint32_t dwConvGap = 0xFFFFFFFF;    // uncertainty of dwConvTime: time since the previous read without conversion result (us)
+uint8_t bIntfPending = 0;   // INTF flags read by DMM_WaitConversion, merged in the next status read
+uint32_t dwIntfTime = 0;    // micros() timestamp of the INTF read that found the conversion result
+uint8_t fPkhCaptured = 0;   // set when an AD1 result was flagged since the peak hold registers were cleared by the DMM reset
+uint8_t bFormat = DMM_FORMAT_FIXED;         // the format used by DMM_FormatValue
+uint8_t cFmtDigits = DMM_FORMAT_DEFDIGITS;  // the number of significant digits of the DIGITS, ENG and COMPACT formats
+uint8_t cFmtDecimals = 6;                   // the number of decimals of the current scale in DIGITS format, see DMM_UpdateFormat
 
 //char sTmpDebug[100];
 //char sTmpDebug1[10];
@@ -161,10 +191,12 @@ void DMM_Init()
 **		This function configures a specific scale as the current scale.
 **      According to this scale, it uses data defined in dmmcfg structure to configure the switches and 
 **      to set the value of the registers (24 registers starting at 0x1F address).
+**      The conversion rate profile selected for the scale family (see DMM_SetConvRate) is applied over the scale registers.
 **      It also verifies the configuration setting success status by reading the values of these registers.
 **      It returns ERRVAL_SUCCESS if the operation is successful.
 **      It returns ERRVAL_DMM_CFGVERIFY if verifying fails.
-**      It returns ERRVAL_DMM_IDXCONFIG if the scale index is not valid.
+**      It returns ERRVAL_DMM_IDXCONFIG if the scale index is not valid, for the AC scales when DMMCONFIG_AC is 0 
+**      or for the counter scales when DMMCONFIG_COUNTER is 0.
 **            
 */
 uint8_t DMM_SetScale(int idxScale)
@@ -175,9 +207,29 @@ uint8_t DMM_SetScale(int idxScale)
     {
         return bResult;
     }
+#if !DMMCONFIG_AC
+    // the AC scales are not included in the build
+    if(DMM_GetScaleClass(idxScale) & DMM_CLASS_AC)
+    {
+        return ERRVAL_DMM_IDXCONFIG;
+    }
+#endif
+#if !DMMCONFIG_COUNTER
+    // the counter scales are not included in the build
+    if(DMM_GetScaleClass(idxScale) & DMM_CLASS_COUNTER)
+    {
+        return ERRVAL_DMM_IDXCONFIG;
+    }
+#endif
+    PERFCNT_TIME_START(dwStart);
 	// 1. Retrieve current Scale information from PROGMEM
 	memcpy_P(&curCfg, dmmcfg + idxScale, sizeof (DMMCFG));
 	
+	// 1.1. Apply the conversion rate overlay of the scale family
+    DMMRATEOVL ovl;
+    uint8_t bFamily = DMM_GetScaleFamily(idxScale);
+    memcpy_P(&ovl, &dmmrateovl[bFamily][rgConvRate[bFamily]], sizeof(DMMRATEOVL));
+    curCfg.cfg[ovl.idxCfg] = (curCfg.cfg[ovl.idxCfg] & ~ovl.mask) | (ovl.val & ovl.mask);
 	
     const int cbCfg = 24;
     uint8_t rgIn[24];
@@ -191,6 +243,14 @@ uint8_t DMM_SetScale(int idxScale)
 
     // Write 1 bytes, starting with 0x37 address
     DMM_SendCmdSPI(bCmd, 1, &valReset);
+    // the conversions restart after the reset: the stored counters and the previous result time cannot be used anymore,
+    // also when the configuration fails below
+    fCntValid = 0;
+    bIntfPending = 0;
+    dwIntfTime = 0;
+    fPkhCaptured = 0;
+    fPollNotReady = 0;
+    dwConvGap = 0xFFFFFFFF;
 
     // 3. Set the switches
     
@@ -224,16 +284,93 @@ uint8_t DMM_SetScale(int idxScale)
          if((rgIn[i]&dmmcfgmask[i])!=(curCfg.cfg[i]&dmmcfgmask[i]))
          {
             // DMM scale configuration verify failed;
+             PERFCNT_EVENT(PERFCNT_EV_CFGVERIFY);
              return ERRVAL_DMM_CFGVERIFY;
          }
      }
      
      // 6. Set idxScale as current scale
     idxCurrentScale = idxScale;
+    // 7. Select the unit prefix and the unit of the scale, computed from the scale range and type at compile time 
+    // (see DMMSCALES_Prefix and DMMSCALES_Unit), so that the values are formatted and interpreted without lookups
+    idxPrefix = pgm_read_byte(&dmmscaleinfo[idxScale].idxPrefix);
+    szCurUnit = DMM_GetUnitString(idxScale);
+    DMM_UpdateFormat();
+    PERFCNT_TIME_STOP(PERFCNT_SMP_SETSCALE, dwStart);
     return ERRVAL_SUCCESS;
 
 }
 
+/***	DMM_SetConvRate
+**
+**	Parameters:
+**      uint8_t bFamily		- the scale family: DMM_FAMILY_DC, DMM_FAMILY_AC or DMM_FAMILY_RES
+**      uint8_t bRate		- the conversion rate profile, one of the DMM_RATE_xxx definitions
+**
+**	Return Value:
+**		uint8_t 
+**          ERRVAL_SUCCESS            0      // success
+**          ERRVAL_DMM_CFGVERIFY     0xF5    // DMM Configuration verify error
+**          ERRVAL_DMM_WRONGPARAM    0xED    // the scale family or the rate profile is not among accepted values
+**	Description:
+**		This function selects the conversion rate profile for a scale family, trading resolution for speed.
+**      Each profile is an overlay on the scale configuration registers, stored in dmmrateovl table, 
+**      that is applied by DMM_SetScale whenever a scale of the family is selected.
+**      If the current scale belongs to the family, it is selected again so that the profile is applied immediately, 
+**      the configuration being verified as for any scale selection.
+**      The learned conversion periods are cleared when the profile changes.
+**      It returns ERRVAL_DMM_CFGVERIFY if verifying fails: then the previous profile is restored and the current scale 
+**      is selected again with it.
+**      It returns ERRVAL_DMM_WRONGPARAM if the family or rate parameters are not valid.
+**            
+*/
+uint8_t DMM_SetConvRate(uint8_t bFamily, uint8_t bRate)
+{
+    uint8_t bOldRate, bErr = ERRVAL_SUCCESS;
+    if(bFamily >= DMM_CNTFAMILIES || bRate >= DMM_CNTRATES)
+    {
+        return ERRVAL_DMM_WRONGPARAM;
+    }
+    bOldRate = rgConvRate[bFamily];
+    if(bRate == bOldRate)
+    {
+        return ERRVAL_SUCCESS;
+    }
+    rgConvRate[bFamily] = bRate;
+    if(DMM_ERR_CheckIdxCalib(idxCurrentScale) == ERRVAL_SUCCESS && DMM_GetScaleFamily(idxCurrentScale) == bFamily)
+    {
+        // apply the profile on the current scale
+        bErr = DMM_SetScale(idxCurrentScale);
+        if(bErr != ERRVAL_SUCCESS)
+        {
+            // keep the chip and the selected profile consistent: restore the previous profile on the current scale
+            rgConvRate[bFamily] = bOldRate;
+            DMM_SetScale(idxCurrentScale);
+            return bErr;
+        }
+    }
+    // the conversion periods change with the rate profile, they are learned again
+    memset(rgwConvPeriod, 0, sizeof(rgwConvPeriod));
+    return bErr;
+}
+
+/***	DMM_GetConvRate
+**
+**	Parameters:
+**      uint8_t bFamily		- the scale family: DMM_FAMILY_DC, DMM_FAMILY_AC or DMM_FAMILY_RES
+**
+**	Return Value:
+**		uint8_t     - the conversion rate profile selected for the family, DMM_RATE_NORMAL for invalid families
+**
+**	Description:
+**		This function returns the conversion rate profile selected for a scale family using DMM_SetConvRate.
+**            
+*/
+uint8_t DMM_GetConvRate(uint8_t bFamily)
+{
+    return (bFamily < DMM_CNTFAMILIES) ? rgConvRate[bFamily] : DMM_RATE_NORMAL;
+}
+
 /***	DMM_ERR_CheckIdxCalib
 **
 **	Parameters:
@@ -256,6 +393,28 @@ uint8_t DMM_ERR_CheckIdxCalib(int idxScale)
     return bResult;
 }
 
+/***	DMM_ERR_CheckCalibScale
+**
+**	Parameters:
+**      uint8_t idxScale		- the scale index
+**
+**	Return Value:
+**		uint8_t 
+**          ERRVAL_SUCCESS            0       // success
+**          ERRVAL_DMM_IDXCONFIG     0xFC    // error, wrong scale index or scale without calibration
+**
+**	Description:
+**		This function checks that the scale index refers a scale having calibration coefficients. 
+**      If it is valid (between 0 and DMM_CNTCALIBSCALES - 1), the function returns ERRVAL_SUCCESS  
+**      If it is not valid (including the counter scales), the function returns ERRVAL_DMM_IDXCONFIG.  
+**            
+*/
+uint8_t DMM_ERR_CheckCalibScale(int idxScale)
+{
+    uint8_t bResult = (idxScale >= 0) && (idxScale < DMM_CNTCALIBSCALES) ? ERRVAL_SUCCESS: ERRVAL_DMM_IDXCONFIG;
+    return bResult;
+}
+
 /***	DMM_DGetValue
 **
 **	Parameters:
@@ -271,7 +430,9 @@ uint8_t DMM_ERR_CheckIdxCalib(int idxScale)
 **          +/- INFINITY if the convertor / RMS registers values are outside the expected range.
 **	Description:
 **		This function repeatedly retrieves the value from the convertor / RMS registers 
-**      by calling private private function DMM_DGetStatus, until a valid value is detected.
+**      by calling private function DMM_DWaitValue, until a valid value is detected.
+**      Before, it waits for the conversion result using DMM_WaitConversion, which only reads the INTF register
+**      and sleeps until shortly before the result is expected, according to the learned conversion period of the scale.
 **      It returns INFINITY when measured values are outside the expected convertor range.
 **      If there is no valid current scale selected, the function sets the error value to ERRVAL_DMM_IDXCONFIG and NAN value is returned. 
 **      If there is no valid value retrieved within a specific timeout period, the error is set to ERRVAL_DMM_VALIDDATATIMEOUT.
@@ -281,19 +442,48 @@ uint8_t DMM_ERR_CheckIdxCalib(int idxScale)
 **            
 */
 double DMM_DGetValue(uint8_t *pbErr)
+{
+    DMMSTS dmmsts; // registers 0x00 - 0x1F
+    return DMM_DWaitValue(&dmmsts, pbErr);
+}
+
+/***	DMM_DWaitValue
+**
+**	Parameters:
+**      DMMSTS *pDmmSts - Pointer to the structure receiving the registers values of the status read returning the value
+**      uint8_t *pbErr  - Pointer to the error parameter, set as for DMM_DGetValue
+**
+**	Return Value:
+**		double 
+**          the value, as returned by DMM_DGetValue
+**	Description:
+**		This function implements DMM_DGetValue: it waits for the conversion result (DMM_WaitConversion), 
+**      then repeatedly reads the status registers (DMM_DReadValue) until a valid value is detected or the timeout.
+**      The status registers the value was computed from are left in the structure pointed by pDmmSts,
+**      so that the other registers of the same conversion (AD2 with the RMS value) can be used (see DMM_DGetDualValue).
+**            
+*/
+double DMM_DWaitValue(DMMSTS *pDmmSts, uint8_t *pbErr)
 {
     uint8_t bErr = ERRVAL_SUCCESS;
     // valid data timeout counter 
     unsigned long cntTimeout = 0;
     
     double dVal;
+    PERFCNT_TIME_START(dwStart);
+    // wait for the conversion result polling only the INTF register, as long as expected for the scale
+    uint16_t cntIntfPolls = DMM_WaitConversion();
     // wait until a valid value is retrieved or the timeout counter exceeds threshold
-    while(DMM_IsNotANumber(dVal = DMM_DGetStatus(&bErr)) && (cntTimeout++ < DMM_VALIDDATA_CNTTIMEOUT) && (bErr == ERRVAL_SUCCESS));
+    while(DMM_IsNotANumber(dVal = DMM_DReadValue(pDmmSts, &bErr)) && (cntTimeout++ < DMM_VALIDDATA_CNTTIMEOUT) && (bErr == ERRVAL_SUCCESS));
     // detect timeout 
     if((bErr == ERRVAL_SUCCESS) && (cntTimeout >=  DMM_VALIDDATA_CNTTIMEOUT))
     {
         bErr = ERRVAL_DMM_VALIDDATATIMEOUT;
+        PERFCNT_EVENT(PERFCNT_EV_DATATIMEOUT);
     }
+    PERFCNT_SAMPLE(PERFCNT_SMP_POLLS, cntIntfPolls + cntTimeout + 1);
+    (void)cntIntfPolls; // only used by the instrumentation counters
+    PERFCNT_TIME_STOP(PERFCNT_SMP_GETVALUE, dwStart);
     if(bErr == ERRVAL_SUCCESS && DMM_GetCurrentScale() == DMMVoltageDC50Scale)
     {
         // compensate the not linear scale behavior
@@ -308,6 +498,38 @@ double DMM_DGetValue(uint8_t *pbErr)
     return dVal;
 }
 
+/***	DMM_GetSample
+**
+**	Parameters:
+**      DMMSAMPLE *pSample  - Pointer to the structure receiving the sample
+**
+**	Return Value:
+**		uint8_t     - the error code, as returned by DMM_DGetValue
+**          ERRVAL_SUCCESS              0       // success
+**          ERRVAL_DMM_VALIDDATATIMEOUT 0xFA    // valid data DMM timeout
+**          ERRVAL_DMM_IDXCONFIG        0xFC    // error, wrong current scale index
+**	Description:
+**		This function acquires a value using DMM_DGetValue and fills the structure pointed by pSample with the value, 
+**      the micros() timestamp taken when the conversion result was read and the conversion sequence number.
+**      The sequence number counts the conversion results read since DMM_Init, including the ones consumed 
+**      by averaging and statistics functions, so a gap between two samples shows how many results were not reported.
+**      The timestamp wraps around after about 71 minutes, differences between timestamps must be computed modulo 2^32.
+**      When errors are detected, the value is NAN and the timestamp and sequence number are those of the last conversion result.
+**            
+*/
+uint8_t DMM_GetSample(DMMSAMPLE *pSample)
+{
+    uint8_t bErr;
+    pSample->dVal = DMM_DGetValue(&bErr);
+    if(bErr != ERRVAL_SUCCESS)
+    {
+        pSample->dVal = NAN;
+    }
+    pSample->dwTime = dwConvTime;
+    pSample->dwSeq = dwConvSeq;
+    return bErr;
+}
+
 /***	DMM_DGetAvgValue
 **
 **	Parameters:
@@ -326,9 +548,14 @@ double DMM_DGetValue(uint8_t *pbErr)
 **      returned by DMM_DGetValue, for the specified number of samples. 
 **      The function uses Arithmetic mean average value method for all but AC scales, 
 **      and RMS (Quadratic mean) Average value method for for AC scales.
+**      The samples are acquired using DMM_DGetStats, so the samples that cannot be acquired are counted and skipped, 
+**      the average being computed on the valid samples.
+**      If an averaging filter was selected using DMM_SetAvgFilter, the samples are acquired and filtered by DMM_DGetFilteredValue,
+**      then at most FILTER_MAX_SAMPLES samples can be requested (otherwise the error is set to ERRVAL_DMM_WRONGPARAM).
 **      If there is no valid current scale selected, the error is set to ERRVAL_DMM_IDXCONFIG. 
-**      If there is no valid value retrieved within a specific timeout period, the error is set to ERRVAL_DMM_VALIDDATATIMEOUT.
-**      It returns INFINITY when measured values are outside the expected convertor range.
+**      If no valid value was retrieved, the error is set to the error of the last invalid sample (for example ERRVAL_DMM_VALIDDATATIMEOUT).
+**      It returns INFINITY when any of the measured values is outside the expected convertor range, as DMM_DGetValue does 
+**      for a single value: the average of the other samples is not the value of an input that overloads part of the time.
 **      When no error is detected, the error is set to ERRVAL_SUCCESS.
 **      The error is copied on the byte pointed by pbErr, if pbErr is not null.
 **      When errors are detected, the function returns NAN.
@@ -336,55 +563,35 @@ double DMM_DGetValue(uint8_t *pbErr)
 */
 double DMM_DGetAvgValue(int cbSamples, uint8_t *pbErr)
 {
-    uint8_t fValid = 1;
-    double dValAvg = 0.0, dVal;
-    int i;
-    int idxScale = DMM_GetCurrentScale();
-	uint8_t bErr  = DMM_ERR_CheckIdxCalib(idxScale);    
-    uint8_t fAC;
+    double dValAvg = NAN;
+    DMMSTATACC acc;
+    uint8_t bErr;
+    if(bAvgFilter != FILTER_NONE)
+    {
+        return DMM_DGetFilteredValue(cbSamples, pbErr);
+    }
+    bErr = DMM_DGetStats(cbSamples, &acc);
     if(bErr == ERRVAL_SUCCESS)
     {
-        fAC = DMM_FACScale(idxScale);
-        if(fAC)
+        if(acc.cntOverload)
         {
-            // use RMS (Quadratic mean) Average value for AC
-            for(i = 0; (i < cbSamples) && fValid; i++)
-            {
-                dVal = DMM_DGetValue(&bErr);
-                fValid = (bErr == ERRVAL_SUCCESS) && (dVal != INFINITY) && (dVal != -INFINITY )&& !DMM_IsNotANumber(dVal);
-                if(fValid)
-                {
-                    dValAvg += pow(dVal, 2);
-                }
-            }
-            if(fValid && cbSamples)
-            {
-                dValAvg /= cbSamples;                
-                dValAvg = sqrt(dValAvg);
-            }            
+            // some values are outside the convertor range
+            dValAvg = INFINITY;
         }
-        else
+        else if(acc.cnt)
         {
-            // use normal (Arithmetic mean) Average value for other than AC.
-            for(i = 0; (i < cbSamples) && fValid; i++)
+            if(DMM_FACScale(idxCurrentScale))
             {
-                dVal = DMM_DGetValue(&bErr);
-                fValid = (bErr == ERRVAL_SUCCESS) && (dVal != INFINITY) && (dVal != -INFINITY )&& !DMM_IsNotANumber(dVal);
-                if(fValid)
-                {
-                    dValAvg += dVal;
-                }
+                // use RMS (Quadratic mean) Average value for AC
+                dValAvg = DMM_StatAccGetRMS(&acc);
             }
-            if(fValid && cbSamples)
+            else
             {
-                dValAvg /= cbSamples;                
+                // use normal (Arithmetic mean) Average value for other than AC.
+                dValAvg = acc.dMean;
             }
         }
     }
-    if(bErr != ERRVAL_SUCCESS)
-    {
-        dValAvg = NAN;
-    }
     if(pbErr)
     {
         *pbErr = bErr;
@@ -392,141 +599,618 @@ double DMM_DGetAvgValue(int cbSamples, uint8_t *pbErr)
     return dValAvg;
 }
 
-
-/***	DMM_GetCurrentScale
+/***	DMM_DGetStats
 **
 **	Parameters:
-**      none
+**      int cbSamples           - The number of values to be acquired
+**      DMMSTATACC *pAcc        - Pointer to the statistics accumulator to be filled
 **
 **	Return Value:
-**		int     - current scale index
-**              - -1 if no current scale was selected
-**
+**		uint8_t 
+**          ERRVAL_SUCCESS              0       // success
+**          ERRVAL_DMM_VALIDDATATIMEOUT 0xFA    // valid data DMM timeout
+**          ERRVAL_DMM_IDXCONFIG        0xFC    // error, wrong current scale index
 **	Description:
-**		This function returns the current scale index. 
-**      This is the last scale index selected using the DMM_SetScale function.
-**      In case no current scale was selected, the function returns -1.
+**		This function acquires the specified number of samples using DMM_DGetValue and 
+**      accumulates them in the statistics accumulator pointed by pAcc (count, mean, M2, min and max). 
+**      The accumulator is initialized by the function.
+**      Samples that cannot be acquired (errors, not a number) or that are outside the expected convertor range
+**      are counted as invalid and the acquisition continues. The samples outside the convertor range are also counted in cntOverload:
+**      the statistics then only describe the samples within the range, the caller must check cntOverload 
+**      before using them as the input value (DMM_DGetAvgValue returns INFINITY).
+**      If there is no valid current scale selected, the function returns ERRVAL_DMM_IDXCONFIG. 
+**      If none of the samples is valid, the function returns the error of the last sample, 
+**      or ERRVAL_SUCCESS if all the samples were outside the convertor range (see cntOverload).
 **            
 */
-int DMM_GetCurrentScale()
+uint8_t DMM_DGetStats(int cbSamples, DMMSTATACC *pAcc)
 {
-    return idxCurrentScale;
+    double dVal;
+    int i;
+    uint8_t bErrSample = ERRVAL_SUCCESS;
+    uint8_t bErr = DMM_ERR_CheckIdxCalib(idxCurrentScale);    
+    DMM_StatAccInit(pAcc);
+    if(bErr == ERRVAL_SUCCESS)
+    {
+        for(i = 0; i < cbSamples; i++)
+        {
+            dVal = DMM_DGetValue(&bErrSample);
+            if(bErrSample == ERRVAL_SUCCESS)
+            {
+                DMM_StatAccAdd(pAcc, dVal);
+            }
+            else
+            {
+                pAcc->cntInvalid++;
+                bErr = bErrSample;
+            }
+        }
+        if(pAcc->cnt)
+        {
+            // at least one valid sample, errors on other samples are tolerated
+            bErr = ERRVAL_SUCCESS;
+        }
+    }
+    return bErr;
 }
 
-/***	DMM_GetCurrentScale
+/***	DMM_DGetLastFrequency
 **
 **	Parameters:
-**      none
+**      uint8_t *pbErr    - Pointer to the error parameter, the error can be set to:
+**          ERRVAL_SUCCESS              0       // success
+**          ERRVAL_DMM_IDXCONFIG        0xFC    // error, wrong current scale index
 **
 **	Return Value:
-**		int     - current scale index
-**              - -1 if no current scale was selected
-**
+**		double
+**          the input signal frequency (Hz), or
+**          NAN (not a number) value if no counter gate window was completed or if errors were detected
 **	Description:
-**		This function returns the current scale index. 
-**      This is the last scale index selected using the DMM_SetScale function.
-**      In case no current scale was selected, the function returns -1.
+**		This function returns the input signal frequency computed from the counter registers 
+**      captured by the last status read (DMM_DGetValue, DMM_DGetAvgValue, etc).
+**      This way, on AC scales the line frequency is available together with the RMS value, without an additional read.
+**      It returns NAN if no gate window was completed since the current scale was selected, 
+**      or if the current scale does not use the AC input configuration.
+**      It always returns NAN when the counter is not included in the build (DMMCONFIG_COUNTER is 0).
+**      If there is no valid current scale selected, the error is set to ERRVAL_DMM_IDXCONFIG. 
+**      The error is copied on the byte pointed by pbErr, if pbErr is not null.
 **            
 */
-double DMM_GetScaleRange(int idxScale)
+double DMM_DGetLastFrequency(uint8_t *pbErr)
 {
-    double range = curCfg.range;
-    return range;
+    double dFreq = NAN;
+    uint8_t bErr = DMM_ERR_CheckIdxCalib(idxCurrentScale);
+#if DMMCONFIG_COUNTER
+    if(bErr == ERRVAL_SUCCESS && fCntValid && DMM_GetScaleFamily(idxCurrentScale) == DMM_FAMILY_AC)
+    {
+        dFreq = (float)rgCnt[1] * ((float)DMM_CNT_REFCLK / (float)rgCnt[0]);
+    }
+#endif
+    if(pbErr)
+    {
+        *pbErr = bErr;
+    }
+    return dFreq;
 }
-/***	DMM_SetUseCalib
+
+/***	DMM_GetRawCode
 **
 **	Parameters:
-**      uint8_t f  
-**              1 if calibrations coefficients should be applied in future DMM_DGetStatus calls
-**              0 if calibrations coefficients should not be applied in future DMM_DGetStatus calls
+**      DMMRAW *pRaw    - Pointer to the structure receiving the raw codes
 **
 **	Return Value:
-**		none
-**
+**		uint8_t 
+**          ERRVAL_SUCCESS              0       // success
+**          ERRVAL_DMM_IDXCONFIG        0xFC    // error, wrong current scale index
 **	Description:
-**		This function sets the parameter that will determine whether or not the 
-**      calibration coefficients will be applied when value is computed in 
-**      subsequent DMM_DGetStatus calls. 
-**      The default value for this parameter is 1.
+**		This function reads the status registers and fills the structure pointed by pRaw with the raw codes, 
+**      without any floating point conversion: the signed AD1 code, the 40 bits RMS accumulator, the interrupt flags, 
+**      the current scale index and the calibration generation (see CALIB_GetCalibGeneration).
+**      It does not wait for a conversion to be done, the intf flags tell if AD1 (0x04) or RMS (0x10) values are ready.
+**      As for DMM_DGetValue, a result of the current scale counts in the conversion sequence and in the conversion period learning 
+**      (see DMM_UpdateConvState), as the status read clears the INTF flags.
+**      The codes can be converted later (for example on host, using the extras/host decoding library) 
+**      with the same math as DMM_DGetValue, defined in dmmconv.h.
+**      If there is no valid current scale selected, the function returns ERRVAL_DMM_IDXCONFIG. 
 **            
 */
-void DMM_SetUseCalib(uint8_t f)
+uint8_t DMM_GetRawCode(DMMRAW *pRaw)
 {
-    fUseCalib = f;
+    DMMSTS dmmsts; // registers 0x00 - 0x1F
+    uint8_t fCntNew;
+    uint8_t bErr = DMM_ERR_CheckIdxCalib(idxCurrentScale);
+    if(bErr == ERRVAL_SUCCESS)
+    {
+        DMM_ReadStatus(&dmmsts);
+        fCntNew = DMM_UpdateCounters(&dmmsts);
+        DMM_UpdateConvState(DMM_FCounterScale(idxCurrentScale) ? fCntNew: 
+                            (dmmsts.intf & (DMM_FACScale(idxCurrentScale) ? DMM_INTF_RMS: DMM_INTF_AD1)));
+        pRaw->ad1 = DMM_GetSigned24(dmmsts.ad1);
+        memcpy(pRaw->rms, dmmsts.rms, sizeof(pRaw->rms));
+        pRaw->intf = dmmsts.intf;
+        pRaw->idxScale = idxCurrentScale;
+        pRaw->bCalibGen = CALIB_GetCalibGeneration();
+    }
+    return bErr;
 }
 
-/***	DMM_FACScale
+/***	DMM_DGetDualValue
 **
 **	Parameters:
-**      int idxScale  - the scale index
-**              
+**      double *pdVal2    - Pointer to the variable receiving the AD2 convertor value
+**      uint8_t *pbErr    - Pointer to the error parameter, the error can be set to:
+**          ERRVAL_SUCCESS              0       // success
+**          ERRVAL_DMM_VALIDDATATIMEOUT 0xFA    // valid data DMM timeout
+**          ERRVAL_DMM_IDXCONFIG        0xFC    // error, wrong current scale index
+**          ERRVAL_DMM_SCALEFUNCTION    0xEF    // the function is not available on the current scale
 **
 **	Return Value:
-**		1 if the specified scale is a AC (alternating current) scale.
-**		0 if the specified scale is not a AC (alternating current) scale.
-**
+**		double
+**          the DMM value, as returned by DMM_DGetValue, or
+**          NAN (not a number) value if errors were detected
 **	Description:
-**		This function checks if the specified scale is an AC (alternating current) scale.
-**      It returns 1 for the AC Voltage, AC current and AC Low current type scales, and 0 otherwise.
-**      The scale type is checked using the mode field in DMMCFG structure.
+**		This function returns two measurements from the same status registers read: the DMM value 
+**      (the RMS value on AC scales, calibrated as DMM_DGetValue does) and, in the variable pointed by pdVal2, 
+**      the AD2 convertor value (the DC component on AC scales), scaled using the dmmad2mul factor of the current scale.
+**      No calibration is applied on the AD2 value.
+**      The values are read as DMM_DGetValue does (see DMM_DWaitValue): it waits until a valid value is retrieved 
+**      or a timeout occurs (ERRVAL_DMM_VALIDDATATIMEOUT), and the read counts as a conversion result (see DMM_GetSample).
+**      If the current scale does not use AD2, the error is set to ERRVAL_DMM_SCALEFUNCTION.
+**      If there is no valid current scale selected, the error is set to ERRVAL_DMM_IDXCONFIG. 
+**      When errors are detected, NAN is returned and placed in the variable pointed by pdVal2.
+**      The error is copied on the byte pointed by pbErr, if pbErr is not null.
 **            
 */
-uint8_t DMM_FACScale(int idxScale)
+double DMM_DGetDualValue(double *pdVal2, uint8_t *pbErr)
 {
-    int mode = curCfg.mode;
-    return (mode == DmmACVoltage) || (mode == DmmACCurrent) || (mode == DmmACLowCurrent);
+    DMMSTS dmmsts; // registers 0x00 - 0x1F
+    double dVal = NAN;
+    float fMul2;
+    uint8_t bErr = DMM_ERR_CheckIdxCalib(idxCurrentScale);
+    *pdVal2 = NAN;
+    if(bErr == ERRVAL_SUCCESS)
+    {
+        fMul2 = pgm_read_float(&dmmad2mul[idxCurrentScale]);
+        if(fMul2 == 0)
+        {
+            bErr = ERRVAL_DMM_SCALEFUNCTION;
+        }
+        else
+        {
+            // AD2 is taken from the status read returning the value
+            dVal = DMM_DWaitValue(&dmmsts, &bErr);
+            if(bErr == ERRVAL_SUCCESS)
+            {
+                *pdVal2 = fMul2 * DMM_GetSigned24(dmmsts.ad2);
+            }
+        }
+    }
+    if(pbErr)
+    {
+        *pbErr = bErr;
+    }
+    return dVal;
 }
 
-/* ************************************************************************** */
-/***	DMM_FDCScale
+/***	DMM_DGetLPFValue
 **
 **	Parameters:
-**      int idxScale  - the scale index
-**              
+**      uint8_t *pbErr    - Pointer to the error parameter, the error can be set to:
+**          ERRVAL_SUCCESS              0       // success
+**          ERRVAL_DMM_IDXCONFIG        0xFC    // error, wrong current scale index
+**          ERRVAL_DMM_SCALEFUNCTION    0xEF    // the function is not available on the current scale
 **
 **	Return Value:
-**		1 if the specified scale is a DC (direct current) type scale.
-**		0 if the specified scale is not a DC (direct current) type scale.
-**
+**		double
+**          the low pass filtered DMM value, or
+**          +/- INFINITY if the value is outside the expected convertor range, or
+**          NAN (not a number) value if errors were detected
 **	Description:
-**		This function checks if the specified scale is a DC (direct current) type scale.
-**      It returns 1 for the DC Voltage, DC current and DC Low current type scales, and 0 otherwise.
-**      The scale type is checked using the mode field in DMMCFG structure.
+**		This function reads the on-chip low pass filter register (LPF), which holds the AD1 convertor output 
+**      averaged by the chip. It is a cheap alternative to DMM_DGetAvgValue when only a settled value is needed: 
+**      a single 3 bytes SPI read, instead of reading the whole status block for each of the averaged samples.
+**      The value is converted according to the current scale, applying the calibration as DMM_DGetValue does 
+**      (including the VoltageDC50 scale compensation). 
+**      The filter needs time to settle after a scale selection or an input change.
+**      The LPF register follows the AD1 convertor, so it is only available on DC, resistance, continuity and diode scales, 
+**      otherwise the error is set to ERRVAL_DMM_SCALEFUNCTION.
+**      If there is no valid current scale selected, the error is set to ERRVAL_DMM_IDXCONFIG. 
+**      The error is copied on the byte pointed by pbErr, if pbErr is not null.
 **            
 */
-uint8_t DMM_FDCScale(int idxScale)
+double DMM_DGetLPFValue(uint8_t *pbErr)
 {
-    int mode = curCfg.mode;
-    return (mode == DmmDCVoltage) || (mode == DmmDCCurrent) || (mode == DmmDCLowCurrent);
+    double dVal = NAN;
+    uint8_t rgLPF[3];
+    uint8_t bErr = DMM_ERR_CheckIdxCalib(idxCurrentScale);
+    if(bErr == ERRVAL_SUCCESS)
+    {
+        if(DMM_FACScale(idxCurrentScale) || DMM_FCounterScale(idxCurrentScale))
+        {
+            bErr = ERRVAL_DMM_SCALEFUNCTION;
+        }
+        else
+        {
+            // Build command:
+            //  MSB: 7 bits address: 0x06 (LPF)
+            //  LSB: 1 for read
+            uint8_t bCmd = (0x06 << 1) | 1;
+            DMM_GetCmdSPI(bCmd, sizeof(rgLPF), rgLPF);
+            dVal = DMM_DConvertAD1(DMM_GetSigned24(rgLPF));
+            if(idxCurrentScale == DMMVoltageDC50Scale)
+            {
+                // compensate the not linear scale behavior
+                dVal = DMM_CompensateVoltage50DCLinear(dVal);
+            }
+        }
+    }
+    if(pbErr)
+    {
+        *pbErr = bErr;
+    }
+    return dVal;
 }
 
-/***	DMM_FResistorScale
+/***	DMM_ResetPeakHold
 **
 **	Parameters:
-**      int idxScale  - the scale index
-**              
+**      
 **
 **	Return Value:
-**		1 if the specified scale is a Resistor type scale.
-**		0 if the specified scale is not a Resistor type scale.
-**
+**		uint8_t 
+**          ERRVAL_SUCCESS              0       // success
+**          ERRVAL_DMM_IDXCONFIG        0xFC    // error, wrong current scale index
+**          ERRVAL_DMM_SCALEFUNCTION    0xEF    // the function is not available on the current scale
+**          ERRVAL_DMM_CFGVERIFY        0xF5    // DMM Configuration verify error
 **	Description:
-**		This function checks if the specified scale is a Resistor type scale.
-**      It returns 1 for the Resistor and Continuity type scales, and 0 otherwise.
-**      The scale type is checked using the mode field in DMMCFG structure.
+**		This function restarts the peak hold capture, clearing the PKHMIN and PKHMAX registers.
+**      The peak hold registers are only cleared by the DMM reset, so the current scale is selected again using DMM_SetScale:
+**      the reset, the 24 configuration registers written and read back (about 50 SPI bytes) and the switches setting.
+**      The conversions restart after the reset, so the next value is only available after a full conversion period, 
+**      and its wait cannot use the learned conversion period (see DMM_WaitConversion), it polls INTF instead.
+**      Avoid calling it between the values of a fast acquisition.
+**      Peak hold follows the AD1 convertor, so it is not available on AC scales, which use the RMS value, nor on counter scales.
+**      If there is no valid current scale selected, the function returns ERRVAL_DMM_IDXCONFIG. 
 **            
 */
-uint8_t DMM_FResistorScale(int idxScale)
+uint8_t DMM_ResetPeakHold()
 {
-    int mode = curCfg.mode;
-    return (mode == DmmResistance) || (mode == DmmContinuity);
-}
-
-/***	DMM_FDiodeScale
-**
-**	Parameters:
-**      int idxScale  - the scale index
-**              
+    uint8_t bErr = DMM_ERR_CheckIdxCalib(idxCurrentScale);
+    if(bErr == ERRVAL_SUCCESS)
+    {
+        if(DMM_FACScale(idxCurrentScale) || DMM_FCounterScale(idxCurrentScale))
+        {
+            bErr = ERRVAL_DMM_SCALEFUNCTION;
+        }
+        else
+        {
+            bErr = DMM_SetScale(idxCurrentScale);
+        }
+    }
+    return bErr;
+}
+
+/***	DMM_GetPeakHold
+**
+**	Parameters:
+**      double *pdMin           - Pointer to the variable receiving the minimum value captured since the last reset
+**      double *pdMax           - Pointer to the variable receiving the maximum value captured since the last reset
+**
+**	Return Value:
+**		uint8_t 
+**          ERRVAL_SUCCESS              0       // success
+**          ERRVAL_DMM_IDXCONFIG        0xFC    // error, wrong current scale index
+**          ERRVAL_DMM_SCALEFUNCTION    0xEF    // the function is not available on the current scale
+**	Description:
+**		This function reads the PKHMIN and PKHMAX registers, which hold the signed extremes of the AD1 convertor 
+**      at the chip internal conversion rate, since the last DMM_ResetPeakHold (or scale selection).
+**      Only the 6 bytes of these registers are read, so the other registers (INTF, the counters) are not consumed.
+**      The values are converted according to the current scale, applying the calibration as DMM_DGetValue does 
+**      (including the VoltageDC50 scale compensation). 
+**      They are +/- INFINITY when outside the expected convertor range, 
+**      and NAN when no AD1 result was flagged in INTF since the registers were cleared, as their content is not defined until then.
+**      When no result was seen yet, INTF is read once (see DMM_ReadIntf), its flags being kept for the next status read.
+**      Peak hold follows the AD1 convertor, so it is not available on AC scales, which use the RMS value, nor on counter scales.
+**      If there is no valid current scale selected, the function returns ERRVAL_DMM_IDXCONFIG. 
+**            
+*/
+uint8_t DMM_GetPeakHold(double *pdMin, double *pdMax)
+{
+    uint8_t rgPkh[6];   // PKHMIN and PKHMAX registers
+    int32_t vMin, vMax;
+    uint8_t bErr = DMM_ERR_CheckIdxCalib(idxCurrentScale);
+    *pdMin = NAN;
+    *pdMax = NAN;
+    if(bErr == ERRVAL_SUCCESS)
+    {
+        if(DMM_FACScale(idxCurrentScale) || DMM_FCounterScale(idxCurrentScale))
+        {
+            return ERRVAL_DMM_SCALEFUNCTION;
+        }
+        if(!fPkhCaptured && !(DMM_ReadIntf(DMM_INTF_AD1) & DMM_INTF_AD1))
+        {
+            // no conversion since the reset, the registers are not valid yet
+            return bErr;
+        }
+        fPkhCaptured = 1;
+        // Build command:
+        //  MSB: 7 bits address: PKHMIN
+        //  LSB: 1 for read
+        uint8_t bCmd = (offsetof(DMMSTS, pkhmin) << 1) | 1;
+        DMM_GetCmdSPI(bCmd, sizeof(rgPkh), rgPkh);
+        vMin = DMM_GetSigned24(rgPkh);
+        vMax = DMM_GetSigned24(rgPkh + 3);
+        *pdMin = DMM_DConvertAD1(vMin);
+        *pdMax = DMM_DConvertAD1(vMax);
+        if(idxCurrentScale == DMMVoltageDC50Scale)
+        {
+            // compensate the not linear scale behavior
+            *pdMin = DMM_CompensateVoltage50DCLinear(*pdMin);
+            *pdMax = DMM_CompensateVoltage50DCLinear(*pdMax);
+        }
+    }
+    return bErr;
+}
+
+/***	DMM_SetAvgFilter
+**
+**	Parameters:
+**      uint8_t bFilter     - the filter: FILTER_NONE, FILTER_MEDIAN, FILTER_TRIMMEDMEAN or FILTER_HAMPEL
+**
+**	Return Value:
+**		uint8_t 
+**          ERRVAL_SUCCESS              0       // success
+**          ERRVAL_DMM_WRONGPARAM       0xED    // the provided filter is not among accepted values
+**
+**	Description:
+**		This function selects the filter applied by DMM_DGetAvgValue on the acquired samples, 
+**      and therefore by the calibration measurement functions.
+**      The default filter is FILTER_NONE (plain average).
+**            
+*/
+uint8_t DMM_SetAvgFilter(uint8_t bFilter)
+{
+    if(bFilter >= FILTER_CNT)
+    {
+        return ERRVAL_DMM_WRONGPARAM;
+    }
+    bAvgFilter = bFilter;
+    return ERRVAL_SUCCESS;
+}
+
+/***	DMM_GetAvgFilter
+**
+**	Parameters:
+**      none
+**
+**	Return Value:
+**		uint8_t     - the filter selected using DMM_SetAvgFilter
+**
+**	Description:
+**		This function returns the filter applied by DMM_DGetAvgValue on the acquired samples.
+**            
+*/
+uint8_t DMM_GetAvgFilter()
+{
+    return bAvgFilter;
+}
+
+/***	DMM_GetCurrentScale
+**
+**	Parameters:
+**      none
+**
+**	Return Value:
+**		int     - current scale index
+**              - -1 if no current scale was selected
+**
+**	Description:
+**		This function returns the current scale index. 
+**      This is the last scale index selected using the DMM_SetScale function.
+**      In case no current scale was selected, the function returns -1.
+**            
+*/
+int DMM_GetCurrentScale()
+{
+    return idxCurrentScale;
+}
+
+/***	DMM_GetCurrentScale
+**
+**	Parameters:
+**      none
+**
+**	Return Value:
+**		int     - current scale index
+**              - -1 if no current scale was selected
+**
+**	Description:
+**		This function returns the current scale index. 
+**      This is the last scale index selected using the DMM_SetScale function.
+**      In case no current scale was selected, the function returns -1.
+**            
+*/
+double DMM_GetScaleRange(int idxScale)
+{
+    double range = curCfg.range;
+    return range;
+}
+/***	DMM_SetUseCalib
+**
+**	Parameters:
+**      uint8_t f  
+**              1 if calibrations coefficients should be applied in future DMM_DGetStatus calls
+**              0 if calibrations coefficients should not be applied in future DMM_DGetStatus calls
+**
+**	Return Value:
+**		none
+**
+**	Description:
+**		This function sets the parameter that will determine whether or not the 
+**      calibration coefficients will be applied when value is computed in 
+**      subsequent DMM_DGetStatus calls. 
+**      The default value for this parameter is 1.
+**            
+*/
+void DMM_SetUseCalib(uint8_t f)
+{
+    fUseCalib = f;
+}
+
+/***	DMM_SetAdaptivePoll
+**
+**	Parameters:
+**      uint8_t f  
+**              1 if DMM_DGetValue waits for the conversion results according to the learned conversion periods (default)
+**              0 if DMM_DGetValue polls the status registers back to back
+**
+**	Return Value:
+**		none
+**
+**	Description:
+**		This function enables or disables the adaptive wait for the conversion results (see DMM_WaitConversion).
+**      The conversion periods are learned in both cases.
+**            
+*/
+void DMM_SetAdaptivePoll(uint8_t f)
+{
+    fAdaptivePoll = f;
+}
+
+/***	DMM_GetConvPeriod
+**
+**	Parameters:
+**      int idxScale  - the scale index
+**
+**	Return Value:
+**		uint32_t    - the learned conversion period of the scale (us), 0 if it is not learned or for a wrong scale index
+**
+**	Description:
+**		This function returns the conversion period learned from the conversion results read on the scale,
+**      with the current conversion rate profile, for diagnostics.
+**            
+*/
+uint32_t DMM_GetConvPeriod(int idxScale)
+{
+    return (idxScale >= 0 && idxScale < DMM_CNTSCALES) ? (uint32_t)rgwConvPeriod[idxScale] * DMM_CONVPER_UNIT: 0;
+}
+
+/***	DMM_FACScale
+**
+**	Parameters:
+**      int idxScale  - the scale index
+**              
+**
+**	Return Value:
+**		1 if the specified scale is a AC (alternating current) scale.
+**		0 if the specified scale is not a AC (alternating current) scale.
+**
+**	Description:
+**		This function checks if the specified scale is an AC (alternating current) scale.
+**      It returns 1 for the AC Voltage, AC current and AC Low current type scales, and 0 otherwise.
+**      The scale type is checked using the scale class (see DMM_GetScaleClass).
+**      It always returns 0 when the AC scales are not included in the build (DMMCONFIG_AC is 0).
+**            
+*/
+uint8_t DMM_FACScale(int idxScale)
+{
+#if DMMCONFIG_AC
+    return (DMM_GetScaleClass(idxScale) & DMM_CLASS_AC) ? 1: 0;
+#else
+    return 0;
+#endif
+}
+
+/***	DMM_GetScaleFamily
+**
+**	Parameters:
+**      int idxScale  - the scale index
+**              
+**
+**	Return Value:
+**		uint8_t - the scale family: DMM_FAMILY_DC, DMM_FAMILY_AC or DMM_FAMILY_RES
+**
+**	Description:
+**		This function returns the family of a scale, used to select the conversion rate profile.
+**      AC Voltage, AC current, AC Low current and counter type scales belong to DMM_FAMILY_AC, 
+**      Resistance, Continuity and Diode scales belong to DMM_FAMILY_RES, and the other scales to DMM_FAMILY_DC.
+**      The family is read from the scale descriptors table (dmmscaleinfo), computed at compile time.
+**      The function returns DMM_FAMILY_DC for an invalid scale index.
+**            
+*/
+uint8_t DMM_GetScaleFamily(int idxScale)
+{
+    return (DMM_ERR_CheckIdxCalib(idxScale) == ERRVAL_SUCCESS) ? pgm_read_byte(&dmmscaleinfo[idxScale].bFamily): DMM_FAMILY_DC;
+}
+
+/***	DMM_GetScaleClass
+**
+**	Parameters:
+**      int idxScale  - the scale index
+**              
+**
+**	Return Value:
+**		uint8_t - the scale class, a combination of DMM_CLASS_xxx bits, 0 for an invalid scale index
+**
+**	Description:
+**		This function returns the class of a scale, read from the scale descriptors table (dmmscaleinfo), 
+**      computed at compile time from the scale type (see DMMSCALES_Class). 
+**      The DMM_Fxxx scale type functions test its bits.
+**            
+*/
+uint8_t DMM_GetScaleClass(int idxScale)
+{
+    return (DMM_ERR_CheckIdxCalib(idxScale) == ERRVAL_SUCCESS) ? pgm_read_byte(&dmmscaleinfo[idxScale].bClass): 0;
+}
+
+/* ************************************************************************** */
+/***	DMM_FDCScale
+**
+**	Parameters:
+**      int idxScale  - the scale index
+**              
+**
+**	Return Value:
+**		1 if the specified scale is a DC (direct current) type scale.
+**		0 if the specified scale is not a DC (direct current) type scale.
+**
+**	Description:
+**		This function checks if the specified scale is a DC (direct current) type scale.
+**      It returns 1 for the DC Voltage, DC current and DC Low current type scales, and 0 otherwise.
+**      The scale type is checked using the scale class (see DMM_GetScaleClass).
+**            
+*/
+uint8_t DMM_FDCScale(int idxScale)
+{
+    return (DMM_GetScaleClass(idxScale) & DMM_CLASS_DC) ? 1: 0;
+}
+
+/***	DMM_FResistorScale
+**
+**	Parameters:
+**      int idxScale  - the scale index
+**              
+**
+**	Return Value:
+**		1 if the specified scale is a Resistor type scale.
+**		0 if the specified scale is not a Resistor type scale.
+**
+**	Description:
+**		This function checks if the specified scale is a Resistor type scale.
+**      It returns 1 for the Resistor and Continuity type scales, and 0 otherwise.
+**      The scale type is checked using the scale class (see DMM_GetScaleClass).
+**            
+*/
+uint8_t DMM_FResistorScale(int idxScale)
+{
+    return (DMM_GetScaleClass(idxScale) & DMM_CLASS_RES) ? 1: 0;
+}
+
+/***	DMM_FDiodeScale
+**
+**	Parameters:
+**      int idxScale  - the scale index
+**              
 **
 **	Return Value:
 **		1 if the specified scale is a Diode type scale.
@@ -535,13 +1219,12 @@ uint8_t DMM_FResistorScale(int idxScale)
 **	Description:
 **		This function checks if the specified scale is a Diode type scale.
 **      It returns 1 for the Diode and Continuity type scales, and 0 otherwise.
-**      The scale type is checked using the mode field in DMMCFG structure.
+**      The scale type is checked using the scale class (see DMM_GetScaleClass).
 **            
 */
 uint8_t DMM_FDiodeScale(int idxScale)
 {
-    int mode = curCfg.mode;
-    return (mode == DmmDiode);
+    return (DMM_GetScaleClass(idxScale) & DMM_CLASS_DIODE) ? 1: 0;
 }
 
 /***	DMM_FContinuityScale
@@ -557,13 +1240,38 @@ uint8_t DMM_FDiodeScale(int idxScale)
 **	Description:
 **		This function checks if the specified scale is a Continuity type scale.
 **      It returns 1 for the Continuity and Continuity type scales, and 0 otherwise.
-**      The scale type is checked using the mode field in DMMCFG structure.
+**      The scale type is checked using the scale class (see DMM_GetScaleClass).
 **            
 */
 uint8_t DMM_FContinuityScale(int idxScale)
 {
-    int mode = curCfg.mode;
-    return (mode == DmmContinuity);
+    return (DMM_GetScaleClass(idxScale) & DMM_CLASS_CONT) ? 1: 0;
+}
+
+/***	DMM_FCounterScale
+**
+**	Parameters:
+**      int idxScale  - the scale index
+**              
+**
+**	Return Value:
+**		1 if the specified scale is a counter type scale.
+**		0 if the specified scale is not a counter type scale.
+**
+**	Description:
+**		This function checks if the specified scale is a counter type scale.
+**      It returns 1 for the Frequency, Period and Duty cycle type scales, and 0 otherwise.
+**      The scale type is checked using the scale class (see DMM_GetScaleClass).
+**      It always returns 0 when the counter scales are not included in the build (DMMCONFIG_COUNTER is 0).
+**            
+*/
+uint8_t DMM_FCounterScale(int idxScale)
+{
+#if DMMCONFIG_COUNTER
+    return (DMM_GetScaleClass(idxScale) & DMM_CLASS_COUNTER) ? 1: 0;
+#else
+    return 0;
+#endif
 }
 
 /***	DMM_IsNotANumber
@@ -592,8 +1300,9 @@ uint8_t DMM_IsNotANumber(double dVal)
 **	Parameters:
 **		int idxScale        - the Scale index
 **      double *pdScaleFact - pointer to a variable to get the scale factor value
-**      char *szUnitPrefix  - string to get the Unit prefix corresponding to the multiple / submultiple
-**      char *szUnit        - string to get the Unit 
+**      char *pcUnitPrefix  - pointer to a variable to get the Unit prefix character corresponding to the multiple / submultiple, 
+**                            0 for the base Unit. It can be NULL.
+**      PGM_P *pszUnit      - pointer to a variable to get the Unit string, placed in flash. It can be NULL.
 **
 **	Return Value:
 **		uint8_t 
@@ -602,82 +1311,158 @@ uint8_t DMM_IsNotANumber(double dVal)
 **
 **	Description:
 **		The function identifies the Measuring unit data (scale factor, Unit prefix and Unit) for the specified scale.
-**      It uses scale type to identify the Unit. 
-**      It uses scale range to identify the Unit prefix (u, m, k, M) and the corresponding scale factor. 
+**      The Unit prefix (u, m, k, M) and the Unit are read from the scale descriptors table (dmmscaleinfo), 
+**      computed at compile time from the scale range and type. The Unit string is returned without copying it, 
+**      it is placed in flash, so it must be accessed with the _P functions (strcpy_P, strcmp_P, etc).
 **      The scale factor is the value that must multiply the value to convert from the base Unit to the prefixed unit (for example from V to mV)
 **      The function returns ERRVAL_DMM_IDXCONFIG if the provided Scale is not valid. 
 **                
 */
-uint8_t DMM_GetScaleUnit(int idxScale, double *pdScaleFact, char *szUnitPrefix, char *szUnit)
+uint8_t DMM_GetScaleUnit(int idxScale, double *pdScaleFact, char *pcUnitPrefix, PGM_P *pszUnit)
 {
     uint8_t bResult = DMM_ERR_CheckIdxCalib(idxScale);
     if(bResult == ERRVAL_SUCCESS)
     {
         // valid idxScale
-        if(pdScaleFact && szUnit)
+        uint8_t idxScalePrefix = pgm_read_byte(&dmmscaleinfo[idxScale].idxPrefix);
+        if(pdScaleFact)
         {
-            // the pointers are not null
-            if(curCfg.range < 1e-3)
-            {
-                // micro
-                strcpy(szUnitPrefix, "u");
-                *pdScaleFact = 1e6;
-            }
-            else
+            *pdScaleFact = pgm_read_float(&dmmprefix[idxScalePrefix].fact);
+        }
+        if(pcUnitPrefix)
+        {
+            *pcUnitPrefix = pgm_read_byte(&dmmprefix[idxScalePrefix].prefix);
+        }
+        if(pszUnit)
+        {
+            *pszUnit = DMM_GetUnitString(idxScale);
+        }
+    }
+    return bResult;
+}
+
+/***	DMM_GetUnitString
+**
+**	Parameters:
+**		int idxScale        - the scale index
+**
+**	Return Value:
+**		PGM_P               - the measuring unit string, placed in flash, empty for an invalid scale index
+**
+**	Description:
+**		The function returns the base measuring unit of the specified scale, read from the scale descriptors table (dmmscaleinfo), 
+**      without copying it, so that it can be appended directly to a formatted value using strcpy_P.
+**                
+*/
+PGM_P DMM_GetUnitString(int idxScale)
+{
+    return (PGM_P)pgm_read_ptr(&dmmunits[(DMM_ERR_CheckIdxCalib(idxScale) == ERRVAL_SUCCESS) ? pgm_read_byte(&dmmscaleinfo[idxScale].idxUnit): DMM_UNIT_NONE]);
+}
+
+/***	DMM_UpdateFormat
+**
+**	Parameters:
+**		none
+**
+**	Return Value:
+**		none
+**
+**	Description:
+**		The function computes the number of decimals used by the DMM_FORMAT_DIGITS format on the current scale: 
+**      the number of significant digits minus the number of integer digits of the scale range, in the prefixed unit 
+**      (for example 3 decimals for 5 significant digits on the 50 mV scale).
+**      It is called when the scale or the format are changed, so that DMM_FormatValue does not compute it for each value.
+**                
+*/
+void DMM_UpdateFormat()
+{
+    uint8_t cInt = 1;
+    uint32_t range = (uint32_t)(curCfg.range * pgm_read_float(&dmmprefix[idxPrefix].fact));
+    while(range >= 10)
+    {
+        range /= 10;
+        cInt++;
+    }
+    cFmtDecimals = (cFmtDigits > cInt) ? (cFmtDigits - cInt): 0;
+}
+
+/***	DMM_PrintEng
+**
+**	Parameters:
+**		char *pDst          - the string where the value is printed
+**		double dVal         - the value to be printed
+**		uint8_t cDigits     - the number of significant digits
+**
+**	Return Value:
+**		char *              - the position of the terminating 0 of the printed string
+**
+**	Description:
+**		The function prints the value in engineering notation: a mantissa between 1 and 1000 with cDigits significant digits,
+**      followed by a power of 10 exponent multiple of 3 (for example "24.679e-3"). The exponent is omitted when it is 0.
+**      The mantissa is scaled by powers of 1000 and printed by SPrintfDouble, no floating point printf is used.
+**                
+*/
+char *DMM_PrintEng(char *pDst, double dVal, uint8_t cDigits)
+{
+    int8_t bExp = 0;
+    uint8_t cInt = 1;   // the number of integer digits of the mantissa
+    double dAbs = fabs(dVal);
+    double dScale = 1;  // 10 power the number of decimals
+    double dLimit = 1;  // the first rounded value having an additional integer digit, scaled by dScale
+    uint8_t i;
+    if(dAbs != 0)
+    {
+        // scale the mantissa in [1, 1000)
+        while(dAbs >= 1000)
+        {
+            dAbs *= 1e-3;
+            dVal *= 1e-3;
+            bExp += 3;
+        }
+        while(dAbs < 1)
+        {
+            dAbs *= 1e3;
+            dVal *= 1e3;
+            bExp -= 3;
+        }
+        cInt = (dAbs >= 100) ? 3: ((dAbs >= 10) ? 2: 1);
+        // the rounding to cDigits digits can carry into a new integer digit (9.99996 -> 10.0000)
+        for(i = 0; i < cDigits || i < cInt; i++)
+        {
+            dLimit *= 10;
+            if(i >= cInt)
             {
-                if((curCfg.range >= 1e-3) && (curCfg.range < 1))
-                {
-                    // mili
-                    strcpy(szUnitPrefix, "m");
-                    *pdScaleFact = 1e3;
-                }
-                else
-                {
-                    if((curCfg.range >= 1) && (curCfg.range < 1e3))
-                    {
-                        // unit
-                        szUnitPrefix[0] = 0; // empty string
-                        *pdScaleFact = 1;
-                    }
-                    else
-                    {
-                        if((curCfg.range >= 1e3) && (curCfg.range < 1e6))
-                        {
-                            // kilo
-                            strcpy(szUnitPrefix, "k");
-                            *pdScaleFact = 1e-3;
-                        }
-                        else
-                        {
-                            // Mega
-                            strcpy(szUnitPrefix, "M");
-                            *pdScaleFact = 1e-6;
-                        }
-                    }
-                }
+                dScale *= 10;
             }
-            // detect measuring unit, depending on type
-            switch(curCfg.mode)
+        }
+        if(floor(dAbs * dScale + 0.5) >= dLimit)
+        {
+            if(++cInt > 3)
             {
-                case DmmDCVoltage:
-                case DmmACVoltage:
-                case DmmDiode:
-                    strcpy(szUnit, "V");
-                    break;
-                case DmmDCCurrent:
-                case DmmACCurrent:
-                case DmmDCLowCurrent:
-                case DmmACLowCurrent:
-                    strcpy(szUnit, "A");
-                    break;
-                case DmmResistance:
-                case DmmContinuity:               
-                    strcpy(szUnit, "Ohm");
-                    break;
+                // 999.996 -> 1.00000e3
+                dVal *= 1e-3;
+                bExp += 3;
+                cInt = 1;
             }
         }
     }
-    return bResult;
+    pDst += SPrintfDouble(pDst, dVal, (cDigits > cInt) ? (cDigits - cInt): 0);
+    if(bExp)
+    {
+        *pDst++ = 'e';
+        if(bExp < 0)
+        {
+            *pDst++ = '-';
+            bExp = -bExp;
+        }
+        if(bExp >= 10)
+        {
+            *pDst++ = '0' + bExp / 10;
+        }
+        *pDst++ = '0' + bExp % 10;
+    }
+    *pDst = 0;
+    return pDst;
 }
 
 
@@ -700,8 +1485,13 @@ uint8_t DMM_GetScaleUnit(int idxScale, double *pdScaleFact, char *szUnitPrefix,
 **		The function formats a value according to the current selected scale.
 **      The parameter value dVal must correspond to the base Unit (V, A or Ohm), mainly the value returned by DMM_DGetValue.
 **      The function multiplies the value according to the scale specific multiple / submultiple.
-**      It formats the value with 6 decimals.
-**      If fUnit is not 0 it adds the measure unit text (including multiple / submultiple) corresponding to the scale.
+**      It formats the value according to the format selected by DMM_SetFormat: 
+**      with 6 decimals (default), with the decimals giving N significant digits at full scale, 
+**      or in engineering notation with N significant digits (for example "24.679e-3 V"), 
+**      in which case the value is not multiplied and the base unit is used.
+**      If fUnit is not 0 it adds the measure unit text (including multiple / submultiple) corresponding to the scale. 
+**      The compact format never adds the unit.
+**      No floating point printf is used, the numbers are printed by SPrintfDouble.
 **      If dVal is +/- INFINITY (converter values are outside expected range), then "OVERLOAD" string is used for all scales except Continuity.
 **      If dVal is +/- INFINITY (converter values are outside expected range), then "OPEN" string is used for Continuity scale.
 **      The function returns ERRVAL_DMM_IDXCONFIG if the current scale is not valid. 
@@ -712,8 +1502,7 @@ uint8_t DMM_GetScaleUnit(int idxScale, double *pdScaleFact, char *szUnitPrefix,
 uint8_t DMM_FormatValue(double dVal, char *pString, uint8_t fUnit)
 {
     // default 6 decimals
-    double dScaleFact;
-    char szUnitPrefix[2], szUnit[5];
+    char *pDst;
     uint8_t bResult = DMM_ERR_CheckIdxCalib(idxCurrentScale);
     if(bResult == ERRVAL_SUCCESS)
     {
@@ -743,22 +1532,34 @@ uint8_t DMM_FormatValue(double dVal, char *pString, uint8_t fUnit)
             }
             else
             {
-                bResult = DMM_GetScaleUnit(idxCurrentScale, &dScaleFact, szUnitPrefix, szUnit);
-                if(bResult == ERRVAL_SUCCESS)
+                if(bFormat == DMM_FORMAT_ENG || bFormat == DMM_FORMAT_COMPACT)
                 {
-                    // valid idxScale
-                    dVal *= dScaleFact;
-                    //sprintf(pString, "%.6lf", dVal);
-					SPrintfDouble(pString, dVal, 6);
+                    // engineering notation, base unit
+                    pDst = DMM_PrintEng(pString, dVal, cFmtDigits);
+                    if(fUnit && bFormat == DMM_FORMAT_ENG)
+                    {
+                        *pDst++ = ' ';
+                        strcpy_P(pDst, szCurUnit);
+                    }
+                }
+                else
+                {
+                    dVal *= pgm_read_float(&dmmprefix[idxPrefix].fact);
+                    // print the value, then append the unit at the known end of the string
+                    pDst = pString + SPrintfDouble(pString, dVal, (bFormat == DMM_FORMAT_DIGITS) ? cFmtDecimals: 6);
                     if(fUnit)
                     {
-                        strcat(pString, " ");
-                        strcat(pString, szUnitPrefix);
-                        strcat(pString, szUnit);
+                        *pDst++ = ' ';
+                        if((*pDst = pgm_read_byte(&dmmprefix[idxPrefix].prefix)))
+                        {
+                            pDst++;
+                        }
+                        strcpy_P(pDst, szCurUnit);
                     }
                 }
             }
         }
+        // the diode scale uses the base unit (V), the threshold applies in all formats
         if(curCfg.mode == DmmDiode && dVal > DMM_DIODEOPENTHRESHOLD )
         {
             strcpy(pString, "OPEN");        
@@ -767,6 +1568,56 @@ uint8_t DMM_FormatValue(double dVal, char *pString, uint8_t fUnit)
     return bResult;
 }
 
+/***	DMM_SetFormat
+**
+**	Parameters:
+**		uint8_t bFormat     - the format used by DMM_FormatValue, one of DMM_FORMAT_xxx
+**      uint8_t cDigits     - the number of significant digits, between 1 and DMM_FORMAT_MAXDIGITS, 
+**                            not used by the DMM_FORMAT_FIXED format
+**
+**	Return Value:
+**		uint8_t 
+**          ERRVAL_SUCCESS                  0       // success
+**          ERRVAL_CMD_WRONGPARAMS          0xF9    // wrong format or number of digits
+**
+**	Description:
+**		The function selects the format used by DMM_FormatValue to print the values.
+**      Shorter formats reduce the number of characters sent over the serial line for each value.
+**      The function returns ERRVAL_CMD_WRONGPARAMS if the format or the number of digits are not valid.
+**                
+*/
+uint8_t DMM_SetFormat(uint8_t bFmt, uint8_t cDigits)
+{
+    if(bFmt >= DMM_CNTFORMATS || ((bFmt != DMM_FORMAT_FIXED) && (cDigits < 1 || cDigits > DMM_FORMAT_MAXDIGITS)))
+    {
+        return ERRVAL_CMD_WRONGPARAMS;
+    }
+    bFormat = bFmt;
+    if(bFmt != DMM_FORMAT_FIXED)
+    {
+        cFmtDigits = cDigits;
+    }
+    DMM_UpdateFormat();
+    return ERRVAL_SUCCESS;
+}
+
+/***	DMM_GetFormat
+**
+**	Parameters:
+**		none
+**
+**	Return Value:
+**		uint8_t             - the format used by DMM_FormatValue, one of DMM_FORMAT_xxx
+**
+**	Description:
+**		The function returns the format used by DMM_FormatValue to print the values.
+**                
+*/
+uint8_t DMM_GetFormat()
+{
+    return bFormat;
+}
+
 /***	DMM_InterpretValue
 **
 **	Parameters:
@@ -795,7 +1646,8 @@ uint8_t DMM_InterpretValue(char *pString, double *pdVal)
 {
     double dScaleFact;
     int szLen = strlen(pString), szLenUnit;
-    char szUnitPrefix[2], szUnit[5];
+    PGM_P szUnit;
+    uint8_t idx;
     uint8_t bResult = ERRVAL_SUCCESS;
     // trim the blank values at the end of the string
     while(pString[szLen - 1] == ' ')
@@ -809,7 +1661,7 @@ uint8_t DMM_InterpretValue(char *pString, double *pdVal)
     }
     else
     {
-        bResult = DMM_GetScaleUnit(idxCurrentScale, &dScaleFact, szUnitPrefix, szUnit);
+        bResult = DMM_GetScaleUnit(idxCurrentScale, &dScaleFact, NULL, &szUnit);
         if(bResult == ERRVAL_SUCCESS)
         {
             // valid idxScale
@@ -818,29 +1670,20 @@ uint8_t DMM_InterpretValue(char *pString, double *pdVal)
                 // the string does not end with numeric char, it contains Unit.
                 dScaleFact = 1;
                 // look for the szUnit at the end of the provided string
-                szLenUnit = strlen(szUnit);
-                if(!strcmp(szUnit, pString + szLen - szLenUnit))
+                szLenUnit = strlen_P(szUnit);
+                if(szLen >= szLenUnit && !strcmp_P(pString + szLen - szLenUnit, szUnit))
                 {
                     szLen -= szLenUnit; // remove Unit length
-                    // look for any multiple / submultiple prefix before the Unit
-                    switch(pString[szLen - 1])
+                    // look for any multiple / submultiple prefix before the Unit, in the unit prefixes table
+                    for(idx = 0; szLen > 0 && idx < sizeof(dmmprefix)/sizeof(dmmprefix[0]); idx++)
                     {
-                        case 'u':
-                            dScaleFact = 1e6;
-                            szLen--;    // remove prefix length
-                            break;
-                        case 'm':
-                            dScaleFact = 1e3;
-                            szLen--;    // remove prefix length
-                            break;
-                        case 'k':
-                            dScaleFact = 1e-3;
-                            szLen--;    // remove prefix length
-                            break;
-                        case 'M':
-                            dScaleFact = 1e-6;
+                        char cPrefix = pgm_read_byte(&dmmprefix[idx].prefix);
+                        if(cPrefix && cPrefix == pString[szLen - 1])
+                        {
+                            dScaleFact = pgm_read_float(&dmmprefix[idx].fact);
                             szLen--;    // remove prefix length
                             break;
+                        }
                     }
                 }
                 else
@@ -870,30 +1713,211 @@ uint8_t DMM_InterpretValue(char *pString, double *pdVal)
             }
         }
     }
-    return bResult;
+    return bResult;
+}
+
+/***	DMM_FDCCurrentScale
+**
+**	Parameters:
+**      < none>
+**              
+**
+**	Return Value:
+**		1 if the current scale is a DC Current type scale.
+**		0 if the current scale is not a DC Current type scale.
+**
+**	Description:
+**		This function checks if the specified scale is a DC Current type scale.
+**      It returns 1 for the DC Current type scales, and 0 otherwise.
+**      The scale type is checked using the scale class (see DMM_GetScaleClass).
+**            
+*/
+uint8_t DMM_FDCCurrentScale()
+{
+    uint8_t bClass = DMM_GetScaleClass(idxCurrentScale);
+    return ((bClass & DMM_CLASS_DC) && (bClass & DMM_CLASS_CURRENT)) ? 1: 0;
+}
+
+/***	DMM_DGetFilteredValue
+**
+**	Parameters:
+**      int cbSamples           - The number of values to be acquired, at most FILTER_MAX_SAMPLES
+**      uint8_t *pbErr    - Pointer to the error parameter, the error can be set to:
+**          ERRVAL_SUCCESS              0       // success
+**          ERRVAL_DMM_VALIDDATATIMEOUT 0xFA    // valid data DMM timeout
+**          ERRVAL_DMM_IDXCONFIG        0xFC    // error, wrong current scale index
+**          ERRVAL_DMM_WRONGPARAM       0xED    // more samples than FILTER_MAX_SAMPLES were requested
+**
+**	Return Value:
+**		double
+**          the filtered DMM value, or
+**          NAN (not a number) value if errors were detected
+**	Description:
+**		This function acquires the specified number of samples using DMM_DGetValue in the rgFilterBuf buffer, 
+**      and applies the filter selected by DMM_SetAvgFilter on them. 
+**      The filter computes the RMS (Quadratic mean) for AC scales and the Arithmetic mean for the other scales.
+**      The number of samples must not exceed the size of the buffer (FILTER_MAX_SAMPLES), 
+**      otherwise no sample is acquired and the error is set to ERRVAL_DMM_WRONGPARAM.
+**      Samples that cannot be acquired are skipped, the same way as in DMM_DGetStats.
+**      It returns INFINITY when any of the measured values is outside the expected convertor range.
+**      The error is copied on the byte pointed by pbErr, if pbErr is not null.
+**            
+*/
+double DMM_DGetFilteredValue(int cbSamples, uint8_t *pbErr)
+{
+    double dVal = NAN;
+    int i, cVals = 0;
+    uint8_t fOverload = 0;
+    uint8_t bErrSample = ERRVAL_SUCCESS;
+    uint8_t bErr = DMM_ERR_CheckIdxCalib(idxCurrentScale);    
+    if(bErr == ERRVAL_SUCCESS && cbSamples > FILTER_MAX_SAMPLES)
+    {
+        // the samples buffer cannot hold the requested samples
+        bErr = ERRVAL_DMM_WRONGPARAM;
+    }
+    if(bErr == ERRVAL_SUCCESS)
+    {
+        for(i = 0; i < cbSamples; i++)
+        {
+            dVal = DMM_DGetValue(&bErrSample);
+            if(bErrSample != ERRVAL_SUCCESS || DMM_IsNotANumber(dVal))
+            {
+                bErr = bErrSample;
+            }
+            else
+            {
+                if(dVal == INFINITY || dVal == -INFINITY)
+                {
+                    fOverload = 1;
+                }
+                else
+                {
+                    rgFilterBuf[cVals++] = dVal;
+                }
+            }
+        }
+        dVal = NAN;
+        if(fOverload)
+        {
+            // the input was outside the convertor range for some samples, the other samples do not give its value
+            bErr = ERRVAL_SUCCESS;
+            dVal = INFINITY;
+        }
+        else if(cVals)
+        {
+            // at least one valid sample, errors on other samples are tolerated
+            bErr = ERRVAL_SUCCESS;
+            dVal = FILTER_Apply(bAvgFilter, rgFilterBuf, cVals, DMM_FACScale(idxCurrentScale));
+        }
+    }
+    if(pbErr)
+    {
+        *pbErr = bErr;
+    }
+    return dVal;
+}
+
+/***	DMM_StatAccInit
+**
+**	Parameters:
+**      DMMSTATACC *pAcc  - Pointer to the statistics accumulator
+**
+**	Return Value:
+**		none
+**
+**	Description:
+**		This function initializes the statistics accumulator, so that no sample is accumulated.
+**            
+*/
+void DMM_StatAccInit(DMMSTATACC *pAcc)
+{
+    pAcc->cnt = 0;
+    pAcc->cntInvalid = 0;
+    pAcc->cntOverload = 0;
+    pAcc->dMean = 0;
+    pAcc->dM2 = 0;
+    pAcc->dMin = INFINITY;
+    pAcc->dMax = -INFINITY;
+}
+
+/***	DMM_StatAccAdd
+**
+**	Parameters:
+**      DMMSTATACC *pAcc  - Pointer to the statistics accumulator
+**      double dVal       - the sample value
+**
+**	Return Value:
+**		1 if the sample was accumulated.
+**		0 if the sample was counted as invalid.
+**
+**	Description:
+**		This function adds a sample to the statistics accumulator. 
+**      The mean and the sum of squared differences from the mean (M2) are updated using Welford's method,
+**      which avoids the loss of precision of the sum of squares method. Minimum and maximum values are also updated.
+**      Not a number and +/- INFINITY values are not accumulated, they are counted as invalid 
+**      (+/- INFINITY values are also counted as overload).
+**            
+*/
+uint8_t DMM_StatAccAdd(DMMSTATACC *pAcc, double dVal)
+{
+    double dDelta;
+    if(DMM_IsNotANumber(dVal) || dVal == INFINITY || dVal == -INFINITY)
+    {
+        pAcc->cntInvalid++;
+        if(!DMM_IsNotANumber(dVal))
+        {
+            pAcc->cntOverload++;
+        }
+        return 0;
+    }
+    pAcc->cnt++;
+    dDelta = dVal - pAcc->dMean;
+    pAcc->dMean += dDelta / pAcc->cnt;
+    pAcc->dM2 += dDelta * (dVal - pAcc->dMean);
+    if(dVal < pAcc->dMin)
+    {
+        pAcc->dMin = dVal;
+    }
+    if(dVal > pAcc->dMax)
+    {
+        pAcc->dMax = dVal;
+    }
+    return 1;
 }
 
-/***	DMM_FDCCurrentScale
+/***	DMM_StatAccGetStdDev
 **
 **	Parameters:
-**      < none>
-**              
+**      DMMSTATACC *pAcc  - Pointer to the statistics accumulator
 **
 **	Return Value:
-**		1 if the current scale is a DC Current type scale.
-**		0 if the current scale is not a DC Current type scale.
+**		double - the sample standard deviation, or NAN if less than 2 samples were accumulated
 **
 **	Description:
-**		This function checks if the specified scale is a DC Current type scale.
-**      It returns 1 for the DC Current type scales, and 0 otherwise.
-**      The scale type is checked using the mode field in DMMCFG structure.
+**		This function returns the sample standard deviation (sqrt(M2 / (n - 1))) of the accumulated samples.
 **            
 */
-uint8_t DMM_FDCCurrentScale()
+double DMM_StatAccGetStdDev(DMMSTATACC *pAcc)
+{
+    return (pAcc->cnt > 1) ? sqrt(pAcc->dM2 / (pAcc->cnt - 1)) : NAN;
+}
+
+/***	DMM_StatAccGetRMS
+**
+**	Parameters:
+**      DMMSTATACC *pAcc  - Pointer to the statistics accumulator
+**
+**	Return Value:
+**		double - the RMS (quadratic mean) value, or NAN if no sample was accumulated
+**
+**	Description:
+**		This function returns the RMS (quadratic mean) value of the accumulated samples.
+**      It is computed from the mean and M2 as sqrt(mean^2 + M2 / n), so no separate sum of squares is needed.
+**            
+*/
+double DMM_StatAccGetRMS(DMMSTATACC *pAcc)
 {
-    int idxScale = DMM_GetCurrentScale();
-    int mode = curCfg.mode;
-    return (mode == DmmDCCurrent || mode == DmmDCCurrent || mode == DmmDCLowCurrent);
+    return pAcc->cnt ? sqrt(pAcc->dMean * pAcc->dMean + pAcc->dM2 / pAcc->cnt) : NAN;
 }
 
 /* ************************************************************************** */
@@ -942,7 +1966,7 @@ void DMM_ConfigSwitches(uint8_t sw)
 **		This function sends data on a DMM command over the SPI. 
 **      It activates DMM Slave Select pin, sends the command byte, and the specified 
 **      number of bytes from pbWrData, using the SPI_CoreTransferByte function.
-**      Finally it deactivates the DMM Slave Select pin.
+**      Finally it deactivates the DMM Slave Select pin and records the transaction in the trace (see DMMTRACE_Record).
 **          
 */
 void DMM_SendCmdSPI(uint8_t bCmd, int bytesNumber, uint8_t *pbWrData)
@@ -961,6 +1985,7 @@ void DMM_SendCmdSPI(uint8_t bCmd, int bytesNumber, uint8_t *pbWrData)
     }
 //    DelayAprox10Us(10);    
     GPIO_SetValue_CS_DMM(1); // Deactivate CS_DMM
+    DMMTRACE_RECORD(bCmd, pbWrData, bytesNumber);
 }
 
 
@@ -978,7 +2003,7 @@ void DMM_SendCmdSPI(uint8_t bCmd, int bytesNumber, uint8_t *pbWrData)
 **		This function retrieves data on a DMM command over the SPI. 
 **      It activates DMM Slave Select pin, sends the command byte, 
 **      and then retrieves the specified number of bytes into pbRdData, using the SPI_CoreTransferByte function.      
-**      Finally it deactivates the DMM Slave Select pin.
+**      Finally it deactivates the DMM Slave Select pin and records the transaction in the trace (see DMMTRACE_Record).
 **          
 */
 void DMM_GetCmdSPI(uint8_t bCmd, int bytesNumber, uint8_t *pbRdData)
@@ -1004,6 +2029,7 @@ void DMM_GetCmdSPI(uint8_t bCmd, int bytesNumber, uint8_t *pbRdData)
     }
 //    DelayAprox10Us(10);
     GPIO_SetValue_CS_DMM(1); // Deactivate CS_DMM
+    DMMTRACE_RECORD(bCmd, pbRdData, bytesNumber);
 }
 
 double DMM_TmpDebugDGetStatus(uint8_t *pbErr, char *pString)
@@ -1038,7 +2064,27 @@ double DMM_TmpDebugDGetStatus(uint8_t *pbErr, char *pString)
 */
 double DMM_DGetStatus(uint8_t *pbErr)
 {
-    int i;
+    DMMSTS dmmsts; // registers 0x00 - 0x1F
+    return DMM_DReadValue(&dmmsts, pbErr);
+}
+
+/***	DMM_DReadValue
+**
+**	Parameters:
+**      DMMSTS *pDmmSts - Pointer to the structure receiving the registers values
+**      uint8_t *pbErr  - Pointer to the error parameter, set as for DMM_DGetStatus
+**
+**	Return Value:
+**		double 
+**          the value, as returned by DMM_DGetStatus
+**	Description:
+**		This function implements DMM_DGetStatus, reading the status registers in the structure pointed by pDmmSts.
+**      When a conversion result is read, it updates the conversion sequence, the result time and the learned 
+**      conversion period, and counts the status read (PERFCNT_EV_CONVREADY or PERFCNT_EV_CONVNOTREADY).
+**            
+*/
+double DMM_DReadValue(DMMSTS *pDmmSts, uint8_t *pbErr)
+{
     double v;
     v = NAN;
     // 1. Verify index
@@ -1052,122 +2098,414 @@ double DMM_DGetStatus(uint8_t *pbErr)
         return NAN;
     }
     // 2. read registers 0x00 - 0x1F values
-    DMMSTS dmmsts; // registers 0x00 - 0x1F
-    
-    // Build command:
-    //  MSB: 7 bits address: 0
-    //  LSB: 1 for read
-    uint8_t bCmd = 1;
-    
-    // Read 32 bytes, starting with 0 address, values placed in dmmsts
-    DMM_GetCmdSPI(bCmd, sizeof(dmmsts), (uint8_t *)&dmmsts);
+    DMM_ReadStatus(pDmmSts);
+    uint8_t fCntNew = DMM_UpdateCounters(pDmmSts);
     
     // 3. Compute value, according to the specific scale
-    
-    // AD1 signed value
-    int32_t vad1 = ((int32_t)dmmsts.ad1[2]<<24)|((int32_t)dmmsts.ad1[1]<<16)|((int32_t)dmmsts.ad1[0]<<8);
-    vad1 /= 256;
-
-   // RMS for AC
-	uint8_t rms32;
-#if defined (__arm__) && defined (__SAM3X8E__) // Arduino Due compatible
-	// for 32 bits architecture, do not use 4 bytes RMS.
-	rms32 = 0;
-#else
-	// if MS Byte is 0, use only 4 bytes RMS
-	rms32 = (dmmsts.rms[4-i] != 0) ? 1:0;
-#endif
-
-    int64_t vrms = 0;
-    for(i = 0; i < 5; i++)
-	{
-		vrms <<= 8;
-        vrms |= dmmsts.rms[4-i];
-    }
-	if(rms32)
-	{
-		vrms >>= 8;         
-	}
+    v = DMM_DConvertStatus(pDmmSts, fCntNew);
+    DMM_UpdateConvState(!DMM_IsNotANumber(v));
+    if(pbErr)
+    {
+        *pbErr = ERRVAL_SUCCESS;
+    }    
+    return v;
+}
 
-	
 
-    if(DMM_FACScale(idxCurrentScale))
+/***	DMM_DConvertStatus
+**
+**	Parameters:
+**      DMMSTS *pDmmSts - Pointer to the structure containing the registers values
+**      uint8_t fCntNew - 1 if a gate window completed in these registers values, as returned by DMM_UpdateCounters
+**
+**	Return Value:
+**		double 
+**          the value computed according to the convertor / RMS / counter registers values, or
+**          NAN (not a number) value if the registers value is not ready (for the counter scales, no gate window completed), or
+**          +/- INFINITY if the registers values are outside the expected range.
+**	Description:
+**		This function computes the value corresponding to the registers read by DMM_ReadStatus, according to the current selected scale. 
+**      Depending on the parameter set by DMM_SetUseCalib (default is 1), calibration parameters will be applied on the computed value.
+**      The function must only be called for a valid current scale.
+**      
+**            
+*/
+double DMM_DConvertStatus(DMMSTS *pDmmSts, uint8_t fCntNew)
+{
+    double v = NAN;
+    if(DMM_FCounterScale(idxCurrentScale))
+    { // counter scales, a value for each gate window
+        v = fCntNew ? DMM_DGetCounterValue(): NAN;
+    }
+#if DMMCONFIG_AC
+    else if(DMM_FACScale(idxCurrentScale))
     { // AC uses RMS
-        if(dmmsts.intf & 0x10)
+        if(pDmmSts->intf & 0x10)
         { // conversion done
-            if(fUseCalib)
-            { 
-                // apply calibration coefficients
-				if(rms32)
-				{
-					// ignore noise on LSB byte
-					v = sqrt(fabs((double)256*((pow(curCfg.mul,2)*(double)(vrms))) - pow(calib.Dmm[idxCurrentScale].Add,2)))*(1.0+calib.Dmm[idxCurrentScale].Mult);
-				}
-				else
-				{
-					// Arduino Due compatible or zero MS byte
-					v = sqrt(fabs(pow(curCfg.mul,2)*(double)(vrms) - pow(calib.Dmm[idxCurrentScale].Add,2)))*(1.0+calib.Dmm[idxCurrentScale].Mult);         
-				}
-
-            }
-            else
-            {
-				if(rms32)
-				{
-					// ignore noise on LSB byte
-					v = (double)16*(curCfg.mul*sqrt((double)vrms));             
-				}
-				else
-				{
-					// Arduino Due compatible or zero MS byte
-					v = curCfg.mul*sqrt((double)vrms);             
-				}
-
-            }
+            v = DMMCONV_DConvertRMS(pDmmSts->rms, curCfg.mul, fUseCalib ? &calib.Dmm[idxCurrentScale]: NULL);
         }   
         else
         {
             v = NAN; // not ready
         }
     }
+#endif
     else
     { // AD1 value
-        if(dmmsts.intf & 0x04)
+        if(pDmmSts->intf & 0x04)
         { // conversion done
-            if(vad1 >= 0x7FFFFE)
-            {
-                v = INFINITY;   // value outside convertor range
-            }
-            else
-            {
-                if(vad1 <= -0x7FFFFE)
-                {
-                   v = -INFINITY;   // value outside convertor range
-                }
-               else
-               {
-                   v = curCfg.mul*vad1;
-
-                    if(fUseCalib)
-                    {
-                       // apply calibration coefficients
-                       v = v*(1.0+calib.Dmm[idxCurrentScale].Mult) + calib.Dmm[idxCurrentScale].Add;
-                    }
-                }   
-            }
+            v = DMM_DConvertAD1(DMM_GetSigned24(pDmmSts->ad1));
         }
         else
         {
             v = NAN; // not ready
         }
     }
-    if(pbErr)
+    return v;
+}
+
+/***	DMM_ReadStatus
+**
+**	Parameters:
+**      DMMSTS *pDmmSts - Pointer to the structure receiving the registers values
+**
+**	Return Value:
+**		
+**
+**	Description:
+**		This function reads the values of the convertor / RMS / peak hold registers (0-0x1F) in the structure pointed by pDmmSts.
+**      The INTF flags already read by DMM_WaitConversion are added to the INTF value.
+**      
+**            
+*/
+void DMM_ReadStatus(DMMSTS *pDmmSts)
+{
+    // Build command:
+    //  MSB: 7 bits address: 0
+    //  LSB: 1 for read
+    uint8_t bCmd = 1;
+    
+    // Read 32 bytes, starting with 0 address, values placed in pDmmSts
+    DMM_GetCmdSPI(bCmd, sizeof(DMMSTS), (uint8_t *)pDmmSts);
+    // the flags read by DMM_WaitConversion were cleared in the register
+    pDmmSts->intf |= bIntfPending;
+    bIntfPending = 0;
+    if(pDmmSts->intf & DMM_INTF_AD1)
     {
-        *pbErr = ERRVAL_SUCCESS;
-    }    
+        // the peak hold registers follow the AD1 results
+        fPkhCaptured = 1;
+    }
+}
+
+/***	DMM_WaitConversion
+**
+**	Parameters:
+**      
+**
+**	Return Value:
+**		uint16_t    - the number of INTF reads
+**
+**	Description:
+**		This function waits for the next conversion result of the current scale, without reading the whole status block:
+**      - when the conversion period of the scale is learned, it sleeps (see IDLE_Wait) until shortly before the next result is expected:
+**        one period after the last result, minus the uncertainty of the last result time and 1/32 of the period.
+**        Then it reads the INTF register every 1/32 of the period until the result flag is set, up to 3/2 of the period 
+**        after the last result, and at least one period when the function is called later than that (a late call or a stalled chip).
+**      - otherwise, it reads the INTF register every DMM_CONVWAIT_POLLSTEP us until the result flag is set.
+**      It sleeps between the INTF reads (see IDLE_Wait) and stops after DMM_CONVWAIT_MAXPOLLS reads in both cases,
+**      so that it adds a bounded part to the DMM_VALIDDATA_CNTTIMEOUT status reads bounding the wait in DMM_DGetValue.
+**      The spacing of the reads is below 1/8 of the period, as the conversion period learning requires (see DMM_LearnConvPeriod).
+**      The INTF flags read are kept in bIntfPending and merged in the next status read, as reading INTF clears them.
+**      The function returns without reading when the adaptive wait is disabled (see DMM_SetAdaptivePoll), 
+**      for counter scales, or when a result flag is already pending.
+**      When the result is not found, DMM_DGetValue continues with its status reads.
+**            
+*/
+uint16_t DMM_WaitConversion()
+{
+    uint8_t bFlag = DMM_FACScale(idxCurrentScale) ? DMM_INTF_RMS: DMM_INTF_AD1;
+    uint8_t bIntf;
+    uint16_t cntPolls = 0;
+    uint32_t dwPeriod, dwWait, dwMaxWait, dwStep, dwNow, dwPoll, dwElapsed;
+    if(!fAdaptivePoll || DMM_FCounterScale(idxCurrentScale) || (bIntfPending & bFlag))
+    {
+        return 0;
+    }
+    dwPeriod = DMM_GetConvPeriod(idxCurrentScale);
+    if(dwPeriod && dwConvGap != 0xFFFFFFFF)
+    {
+        // the last result time is accurate, sleep until shortly before the next result: the result
+        // can come earlier by the uncertainty of the last result time, plus 1/32 of the period for the jitter
+        dwWait = dwPeriod - dwPeriod / 32;
+        dwWait = (dwWait > dwConvGap) ? dwWait - dwConvGap: 0;
+        IDLE_Wait(dwConvTime, dwWait);
+        // poll until 3/2 of the period after the last result, at least one period when already later
+        dwMaxWait = dwPeriod + dwPeriod / 2;
+        dwElapsed = micros() - dwConvTime;
+        dwMaxWait = (dwElapsed < dwMaxWait) ? dwMaxWait - dwElapsed: dwPeriod;
+        dwStep = dwPeriod / 32;
+    }
+    else
+    {
+        dwMaxWait = 0xFFFFFFFF;
+        dwStep = DMM_CONVWAIT_POLLSTEP;
+    }
+    dwNow = micros();
+    while(1)
+    {
+        dwPoll = micros();
+        bIntf = DMM_ReadIntf(bFlag);
+        cntPolls++;
+        if((bIntf & bFlag) || (micros() - dwNow) >= dwMaxWait || cntPolls >= DMM_CONVWAIT_MAXPOLLS)
+        {
+            break;
+        }
+        IDLE_Wait(dwPoll, dwStep);
+    }
+    return cntPolls;
+}
+
+/***	DMM_ReadIntf
+**
+**	Parameters:
+**      uint8_t bFlag   - the INTF flag of the conversion result of the current scale (DMM_INTF_AD1 or DMM_INTF_RMS)
+**
+**	Return Value:
+**		uint8_t     - the INTF register value, including the flags read before and not yet merged in a status read
+**
+**	Description:
+**		This function reads the INTF register, which is cleared when read, and keeps its flags in bIntfPending, 
+**      so that the next status read (DMM_ReadStatus) still sees them. 
+**      The time of the read is stored as the conversion result time when bFlag is set, 
+**      otherwise as the time of a read without result, as the conversion period learning expects (see DMM_LearnConvPeriod).
+**            
+*/
+uint8_t DMM_ReadIntf(uint8_t bFlag)
+{
+    uint8_t bIntf;
+    DMM_GetCmdSPI((DMM_ADR_INTF << 1) | 1, 1, &bIntf);
+    if(bIntf & bFlag)
+    {
+        dwIntfTime = micros();
+    }
+    else if(!(bIntfPending & bFlag))
+    {
+        dwPollTime = micros();
+        fPollNotReady = 1;
+    }
+    bIntfPending |= bIntf;
+    return bIntfPending;
+}
+
+/***	DMM_UpdateConvState
+**
+**	Parameters:
+**      uint8_t fResult - 1 if the status read contains a conversion result of the current scale, 0 otherwise
+**
+**	Return Value:
+**		
+**
+**	Description:
+**		This function updates the conversion state after a status read: for a conversion result, 
+**      the conversion period learning (at the time the result was found in INTF by DMM_WaitConversion if it did) 
+**      and the conversion sequence number (see DMM_GetSample), otherwise the time of the read without result.
+**      Each status read consumes the INTF flags, so it must be followed by this function, whatever the way the registers are used.
+**            
+*/
+void DMM_UpdateConvState(uint8_t fResult)
+{
+    if(fResult)
+    {
+        DMM_LearnConvPeriod(dwIntfTime ? dwIntfTime: micros());
+        dwIntfTime = 0;
+        dwConvSeq++;
+        PERFCNT_EVENT(PERFCNT_EV_CONVREADY);
+    }
+    else
+    {
+        dwPollTime = micros();
+        fPollNotReady = 1;
+        PERFCNT_EVENT(PERFCNT_EV_CONVNOTREADY);
+    }
+}
+
+/***	DMM_LearnConvPeriod
+**
+**	Parameters:
+**      uint32_t dwTime - micros() timestamp of the conversion result read
+**
+**	Return Value:
+**		
+**
+**	Description:
+**		This function updates the learned conversion period of the current scale when a conversion result is read,
+**      then stores dwTime as the last result time (dwConvTime).
+**      The time between two results is the conversion period when both results were read shortly after they were ready,
+**      i.e. when a read without result preceded each of them by less than 1/8 of the time between the results.
+**      The learned period follows the measured ones with a 1/4 weight, so that it tolerates the scheduling jitter.
+**            
+*/
+void DMM_LearnConvPeriod(uint32_t dwTime)
+{
+    uint32_t dwGap = fPollNotReady ? dwTime - dwPollTime: 0xFFFFFFFF;
+    uint32_t dwPeriod = dwTime - dwConvTime;
+    uint32_t dwLearned;
+    if(!DMM_FCounterScale(idxCurrentScale) && dwConvGap <= dwPeriod / 8 && dwGap <= dwPeriod / 8)
+    {
+        dwPeriod = (dwPeriod + DMM_CONVPER_UNIT / 2) / DMM_CONVPER_UNIT;
+        if(dwPeriod > 0xFFFF)
+        {
+            dwPeriod = 0xFFFF;
+        }
+        dwLearned = rgwConvPeriod[idxCurrentScale];
+        rgwConvPeriod[idxCurrentScale] = dwLearned ? (uint16_t)((3 * dwLearned + dwPeriod + 2) / 4): (uint16_t)dwPeriod;
+    }
+    dwConvGap = dwGap;
+    fPollNotReady = 0;
+    dwConvTime = dwTime;
+}
+
+/***	DMM_GetSigned24
+**
+**	Parameters:
+**      uint8_t *pbVal - Pointer to the 3 bytes of a register value, LS byte first
+**
+**	Return Value:
+**		int32_t 
+**          the sign extended value of the register
+**
+**	Description:
+**		This function builds the signed value of a 24 bits register (AD1, AD2, LPF, PKHMIN, PKHMAX).
+**      
+**            
+*/
+int32_t DMM_GetSigned24(uint8_t *pbVal)
+{
+    int32_t val = ((int32_t)pbVal[2]<<24)|((int32_t)pbVal[1]<<16)|((int32_t)pbVal[0]<<8);
+    return val / 256;
+}
+
+/***	DMM_GetUnsigned24
+**
+**	Parameters:
+**      uint8_t *pbVal - Pointer to the 3 bytes of a register value, LS byte first
+**
+**	Return Value:
+**		uint32_t 
+**          the value of the register
+**
+**	Description:
+**		This function builds the unsigned value of a 24 bits register (CTA, CTB, CTC).
+**      
+**            
+*/
+uint32_t DMM_GetUnsigned24(uint8_t *pbVal)
+{
+    return ((uint32_t)pbVal[2]<<16)|((uint32_t)pbVal[1]<<8)|(uint32_t)pbVal[0];
+}
+
+/***	DMM_UpdateCounters
+**
+**	Parameters:
+**      DMMSTS *pDmmSts - Pointer to the structure containing the registers values
+**
+**	Return Value:
+**		uint8_t     - 1 if a gate window completed in these registers values (CTSTA ready, as CTSTA is cleared when read), 0 otherwise
+**
+**	Description:
+**		This function stores the counter registers values (CTA, CTB, CTC) when a gate window is complete,  
+**      so that they are available for the counter scales and for DMM_DGetLastFrequency.
+**      The previous values are kept while the current gate window is in progress.
+**      
+**            
+*/
+uint8_t DMM_UpdateCounters(DMMSTS *pDmmSts)
+{
+    uint32_t cta;
+    if(pDmmSts->ctsta & DMM_CNT_STSREADY)
+    {
+        cta = DMM_GetUnsigned24(pDmmSts->cta);
+        if(cta)
+        {
+            rgCnt[0] = cta;
+            rgCnt[1] = DMM_GetUnsigned24(pDmmSts->ctb);
+            rgCnt[2] = DMM_GetUnsigned24(pDmmSts->ctc);
+            fCntValid = 1;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/***	DMM_DGetCounterValue
+**
+**	Parameters:
+**      
+**
+**	Return Value:
+**		double 
+**          the frequency (Hz), period (s) or duty cycle (%) value, according to the current scale, or
+**          INFINITY for the period, when no input period was counted.
+**
+**	Description:
+**		This function computes the value of the current counter scale from the last stored counter values.
+**      The counter values have 24 bits, so they are exact in float and each ratio is computed with a single rounding, 
+**      far below the resolution of the counts, without the 64 bits integer divisions.
+**      The function must only be called for a counter scale, when valid counter values are stored.
+**      
+**            
+*/
+double DMM_DGetCounterValue()
+{
+    double v;
+    switch(curCfg.mode)
+    {
+        case DmmFrequency:
+            v = (float)rgCnt[1] * ((float)DMM_CNT_REFCLK / (float)rgCnt[0]);
+            break;
+        case DmmPeriod:
+            if(rgCnt[1])
+            {
+                v = (float)rgCnt[0] / ((float)rgCnt[1] * (float)DMM_CNT_REFCLK);
+            }
+            else
+            {
+                v = INFINITY;   // no input period in the gate window
+            }
+            break;
+        default:
+            // duty cycle, %
+            v = 100.0f * (float)rgCnt[2] / (float)rgCnt[0];
+            break;
+    }
     return v;
 }
 
+/***	DMM_DConvertAD1
+**
+**	Parameters:
+**      int32_t vad - The signed 24 bits value, in the AD1 convertor units
+**
+**	Return Value:
+**		double 
+**          the value computed according to the current scale, or
+**          +/- INFINITY if the value is outside the expected convertor range.
+**
+**	Description:
+**		This function converts a value in the AD1 convertor units (AD1, LPF or peak hold registers) according to the current selected scale.
+**      Depending on the parameter set by DMM_SetUseCalib (default is 1), calibration parameters will be applied on the computed value.
+**      The conversion math is shared with the host side decoding, in dmmconv.h.
+**      It returns INFINITY when the value is outside the expected convertor range.
+**      The function must only be called for a valid current scale which is not an AC scale.
+**      
+**            
+*/
+double DMM_DConvertAD1(int32_t vad)
+{
+    // calibration coefficients only exist for the first DMM_CNTCALIBSCALES scales
+    const CALIB *pCalib = (fUseCalib && (idxCurrentScale < DMM_CNTCALIBSCALES)) ? &calib.Dmm[idxCurrentScale]: NULL;
+    return DMMCONV_DConvertAD1(vad, curCfg.mul, pCalib);
+}
 
 /***	DMM_CompensateVoltage50DCLinear
 **
@@ -1183,22 +2521,15 @@ double DMM_DGetStatus(uint8_t *pbErr)
 **      It gets as parameter the value after the normal calibration coefficients were applied. 
 **      It computes the compensated value as P3*dVal^3 + P1*dVal + P0, where P3, P2 and P0 are third power polynomial
 **      coefficients defined in dmm.h: DMM_Voltage50DCLinearCoeff_P3, DMM_Voltage50DCLinearCoeff_P1 and DMM_Voltage50DCLinearCoeff_P0.
+**      Values outside the convertor range (+/- INFINITY) are not altered.
+**      The conversion math is shared with the host side decoding, in dmmconv.h.
 **      It returns the compensated value.
 **      
 **            
 */
 double DMM_CompensateVoltage50DCLinear(double dVal)
 {
-    double dCompensatedVal;
-    if(!DMM_IsNotANumber(dVal))
-    {
-       dCompensatedVal = dVal * dVal * dVal * DMM_Voltage50DCLinearCoeff_P3 + dVal * DMM_Voltage50DCLinearCoeff_P1 + dVal * DMM_Voltage50DCLinearCoeff_P0;
-    }
-    else
-    {
-        dCompensatedVal = dVal;
-    }
-    return dCompensatedVal;
+    return DMMCONV_DCompensateVoltage50DCLinear(dVal);
 }
 /* *****************************************************************************
  End of File
@@ -55,11 +55,69 @@ extern "C" {
 #define DmmACCurrent                7
 #define DmmDCLowCurrent             8
 #define DmmACLowCurrent             9
-
-#define DMM_CNTSCALES                 27    // the number of scales
+#define DmmFrequency                10
+#define DmmPeriod                   11
+#define DmmDutyCycle                12
+
+// scale families, used to select the conversion rate
+#define DMM_FAMILY_DC               0       // DC Voltage, DC Current and DC Low Current scales
+#define DMM_FAMILY_AC               1       // AC Voltage, AC Current and AC Low Current scales
+#define DMM_FAMILY_RES              2       // Resistance, Continuity and Diode scales
+#define DMM_CNTFAMILIES             3
+
+// scale classes, bits of the class of a scale (see DMM_GetScaleClass)
+#define DMM_CLASS_DC                0x01    // DC Voltage, DC Current and DC Low Current scales
+#define DMM_CLASS_AC                0x02    // AC Voltage, AC Current and AC Low Current scales
+#define DMM_CLASS_RES               0x04    // Resistance and Continuity scales
+#define DMM_CLASS_CONT              0x08    // Continuity scale
+#define DMM_CLASS_DIODE             0x10    // Diode scale
+#define DMM_CLASS_COUNTER           0x20    // Frequency, Period and Duty cycle scales
+#define DMM_CLASS_CURRENT           0x40    // Current and Low Current scales
+
+// base units of the scales
+#define DMM_UNIT_NONE               0
+#define DMM_UNIT_V                  1
+#define DMM_UNIT_A                  2
+#define DMM_UNIT_OHM                3
+#define DMM_UNIT_HZ                 4
+#define DMM_UNIT_S                  5
+#define DMM_UNIT_PERCENT            6
+
+// conversion rate profiles
+// only the profiles measured on the hardware are listed: a faster profile changes the convertor decimation, 
+// so its scale multipliers and calibration must be characterised before it is added (see dmmrateovl in dmm.cpp)
+#define DMM_RATE_NORMAL             0       // default configuration, best resolution
+#define DMM_CNTRATES                1
+
+// value formats, see DMM_FormatValue
+#define DMM_FORMAT_FIXED            0       // 6 decimals in the prefixed unit of the scale (default)
+#define DMM_FORMAT_DIGITS           1       // the number of decimals giving N significant digits at full scale, prefixed unit
+#define DMM_FORMAT_ENG              2       // engineering notation with N significant digits, base unit
+#define DMM_FORMAT_COMPACT          3       // engineering notation with N significant digits, no unit
+#define DMM_CNTFORMATS              4
+#define DMM_FORMAT_MAXDIGITS        7       // maximum number of significant digits (float resolution)
+#define DMM_FORMAT_DEFDIGITS        5       // default number of significant digits
+
+#define DMM_CNTSCALES                 30    // the number of scales
+#define DMM_CNTCALIBSCALES            27    // the number of scales having calibration coefficients, placed first in the scales list
 #define DMM_VALIDDATA_CNTTIMEOUT    0x100   // number of valid data retrieval re-tries
+// adaptive wait for the conversion results, see DMM_DGetValue
+#define DMM_CONVPER_UNIT            16      // unit of the learned conversion periods (us), they are kept on 16 bits
+#define DMM_CONVWAIT_MAXPOLLS       0x80    // maximum number of INTF reads of a conversion wait
+#define DMM_CONVWAIT_POLLSTEP       2000    // time between the INTF reads when the conversion period of the scale is not learned (us)
 #define DMMVoltageDC50Scale          7
     
+// counter scales: CTA counts the reference clock during the gate window, CTB counts the input periods 
+// during the same window and CTC counts the reference clock while the input is high.
+// This interpretation and the reference clock are taken from the datasheet and not verified on hardware (see DMMCONFIG_COUNTER).
+#define DMM_CNT_REFCLK              4915200UL   // counter reference clock (Hz)
+#define DMM_CNT_STSREADY            0x01        // CTSTA bit set when the gate window is complete
+
+// interrupt flags register, cleared when it is read
+#define DMM_ADR_INTF                0x1E
+#define DMM_INTF_AD1                0x04        // INTF bit set when an AD1 conversion result is ready
+#define DMM_INTF_RMS                0x10        // INTF bit set when a RMS result is ready
+    
 #define DMM_Voltage50DCLinearCoeff_P3   -1.59128E-06
 #define DMM_Voltage50DCLinearCoeff_P1   1.003918916
 #define DMM_Voltage50DCLinearCoeff_P0   0.000196999
@@ -81,6 +139,27 @@ typedef struct _DMMCFG{
     double mul; // dmm measurement (ad1/rms) multiplication factor to get value in corresponding unit
 } DMMCFG;
 
+// conversion rate profile: overlay applied on one of the configuration registers
+typedef struct _DMMRATEOVL{
+    uint8_t idxCfg; // index of the register in the cfg array of DMMCFG
+    uint8_t mask;   // the register bits altered by the overlay
+    uint8_t val;    // the value of the altered bits
+} DMMRATEOVL;
+
+// unit prefix (multiple / submultiple) used to display the values of a scale
+typedef struct _DMMPREFIX{
+    char prefix;    // the prefix character, 0 for the base unit
+    float fact;     // the factor converting a value from the base unit to the prefixed unit
+} DMMPREFIX;
+
+// scale descriptor, computed at compile time from the scales list (see dmmscales.h)
+typedef struct _DMMSCALEINFO{
+    uint8_t bClass;     // DMM_CLASS_xxx bits
+    uint8_t bFamily;    // DMM_FAMILY_xxx, used to select the conversion rate
+    uint8_t idxUnit;    // the base unit, DMM_UNIT_xxx
+    uint8_t idxPrefix;  // index in dmmprefix of the unit prefix used to display the values
+} DMMSCALEINFO;
+
 // registers from 0x00 to 0x1F
 typedef struct _DMMSTS{
     uint8_t ad1[3];
@@ -106,27 +185,56 @@ typedef struct _CALIB{
     float  Add;
 } CALIB;
 
+// calibration working set, only kept for the scale being calibrated
 typedef struct _PARTCALIB{
     double Calib_Ms_Zero;
     double Calib_Ms_ValP;
     double Calib_Ref_ValP;
     double Calib_Ms_ValN;
     double Calib_Ref_ValN;
-    uint8_t fCalibDirty;
 } PARTCALIB;
 
 
 typedef struct _CALIBDATA{    //
     uint8_t magic;
-    CALIB      Dmm[DMM_CNTSCALES];    // 27*2  54
+    CALIB      Dmm[DMM_CNTCALIBSCALES];    // 27*2  54
     uint8_t crc;
 }  __attribute__((__packed__)) CALIBDATA;
 
 
 typedef struct _PARTCALIBDATA{    //
-    PARTCALIB  DmmPartCalib[DMM_CNTSCALES];    // stores the data needed to the calibration
+    int idxScale;               // the scale the working set belongs to, -1 if none
+    uint32_t dwCalibDirty;      // one bit for each scale calibrated since last save to EPROM (DMM_CNTCALIBSCALES <= 32)
+    PARTCALIB  DmmPartCalib;    // stores the data needed to the calibration of idxScale
 } PARTCALIBDATA;
 
+// raw convertor codes, converted later using the dmmconv.h functions
+typedef struct _DMMRAW{
+    int32_t ad1;            // AD1 signed 24 bits code
+    uint8_t rms[5];         // RMS 40 bits accumulator, LS byte first
+    uint8_t intf;           // interrupt flags: 0x04 AD1 conversion done, 0x10 RMS conversion done
+    uint8_t idxScale;       // the scale selected when the codes were read
+    uint8_t bCalibGen;      // the calibration generation, see CALIB_GetCalibGeneration
+} DMMRAW;
+
+// acquired value, with timing information
+typedef struct _DMMSAMPLE{
+    double dVal;            // the measured value, in the unit of the current scale
+    uint32_t dwTime;        // micros() timestamp taken when the conversion result was read
+    uint32_t dwSeq;         // conversion sequence number, counts the conversion results read since DMM_Init
+} DMMSAMPLE;
+
+// streaming statistics accumulator, updated in O(1) for each sample (Welford)
+typedef struct _DMMSTATACC{
+    uint16_t cnt;           // number of valid samples
+    uint16_t cntInvalid;    // number of rejected samples (errors, not a number, overload)
+    uint16_t cntOverload;   // number of rejected samples that were outside the convertor range
+    double dMean;           // running mean of the valid samples
+    double dM2;             // running sum of squared differences from the mean
+    double dMin;
+    double dMax;
+} DMMSTATACC;
+
 
 
 // *****************************************************************************
@@ -141,18 +249,42 @@ void DMM_Init();
 // configuration functions
 uint8_t DMM_SetScale(int idxScale);
 int DMM_GetCurrentScale();
+uint8_t DMM_SetConvRate(uint8_t bFamily, uint8_t bRate);
+uint8_t DMM_GetConvRate(uint8_t bFamily);
 double DMM_GetScaleRange(int idxScale);
 
 
 // value functions
 double DMM_DGetValue(uint8_t *pbErr);
+double DMM_DGetStatus(uint8_t *pbErr);
+uint8_t DMM_GetSample(DMMSAMPLE *pSample);
 double DMM_DGetAvgValue(int cbSamples, uint8_t *pbErr);
+uint8_t DMM_DGetStats(int cbSamples, DMMSTATACC *pAcc);
+uint8_t DMM_GetRawCode(DMMRAW *pRaw);
+double DMM_DGetDualValue(double *pdVal2, uint8_t *pbErr);
+double DMM_DGetLPFValue(uint8_t *pbErr);
+uint8_t DMM_ResetPeakHold();
+uint8_t DMM_GetPeakHold(double *pdMin, double *pdMax);
 void DMM_SetUseCalib(uint8_t f);
+void DMM_SetAdaptivePoll(uint8_t f);
+uint32_t DMM_GetConvPeriod(int idxScale);
+uint8_t DMM_SetAvgFilter(uint8_t bFilter);
+uint8_t DMM_GetAvgFilter();
 uint8_t DMM_CheckAcceptedMeasurementDispersion(double dMeasuredVal, double dRefVal, double *pDispersion);
 uint8_t DMM_FormatValue(double dVal, char *pString, uint8_t fUnit);
+uint8_t DMM_SetFormat(uint8_t bFormat, uint8_t cDigits);
+uint8_t DMM_GetFormat();
 uint8_t DMM_InterpretValue(char *pString, double *pdVal);
 
 uint8_t DMM_FDCCurrentScale();
+uint8_t DMM_FCounterScale(int idxScale);
+double DMM_DGetLastFrequency(uint8_t *pbErr);
+
+// statistics functions
+void DMM_StatAccInit(DMMSTATACC *pAcc);
+uint8_t DMM_StatAccAdd(DMMSTATACC *pAcc, double dVal);
+double DMM_StatAccGetStdDev(DMMSTATACC *pAcc);
+double DMM_StatAccGetRMS(DMMSTATACC *pAcc);
     /* Provide C++ Compatibility */
 #ifdef __cplusplus
 }
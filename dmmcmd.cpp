@@ -29,26 +29,48 @@
 /* ************************************************************************** */
 #include <stdio.h>
 #include <Arduino.h>
+#include "dmmconfig.h"
 #include "dmmcmd.h"
 #include "dmm.h"
+#include "dmmscales.h"
 #include "serialno.h"
 #include "utils.h"
 #include "calib.h"
+#include "filter.h"
+#include "trigger.h"
+#include "dmmtrace.h"
+#include "perfcnt.h"
+#include "idle.h"
 
 #include "HardwareSerial.h"
 #include "errors.h"
 
 /********************* Function Forward Declarations ***************************/
-char* DMMCMD_CmdGetNextArg();
-uint8_t DMMCMD_GetCmdIdx(char *szCmd);
-void DMMCMD_ProcessCmd(uint8_t idxCmd);
+void DMMCMD_ProcessCmd(uint8_t idxCmd, CMDTOK *pTok);
+void DMMCMD_ProcessArgs(uint8_t idxCmd, char *szArgs);
 uint8_t DMMCMD_ProcessRepeatedCmd();
 // individual commands functions
 uint8_t DMMCMD_CmdConfig(char const *arg0);
-uint8_t DMMCMD_CmdMeasureRep();
+uint8_t DMMCMD_CmdMeasureRep(char const *arg0);
 uint8_t DMMCMD_CmdMeasureStop();
-uint8_t DMMCMD_CmdMeasureRaw();
+uint8_t DMMCMD_CmdMeasureRaw(char const *arg0);
+uint8_t DMMCMD_StartRepeatedCmd(char const *arg0);
+void DMMCMD_ScheduleRepeatedCmd();
 uint8_t DMMCMD_CmdMeasureAvg();
+uint8_t DMMCMD_CmdMeasureStats(char const *arg0);
+uint8_t DMMCMD_CmdSetFilter(char const *arg0);
+uint8_t DMMCMD_CmdSetRate(char const *arg0, char const *arg1);
+uint8_t DMMCMD_CmdSetFormat(char const *arg0, char const *arg1);
+uint8_t DMMCMD_CmdPeakHold(char const *arg0);
+uint8_t DMMCMD_CmdMeasureLPF();
+uint8_t DMMCMD_CmdMeasureDual();
+uint8_t DMMCMD_CmdReadRawCode();
+uint8_t DMMCMD_CmdTrace(char const *arg0);
+uint8_t DMMCMD_CmdStats(char const *arg0);
+uint8_t DMMCMD_CmdTrigger(char const *arg0, char const *arg1, char const *arg2);
+uint8_t DMMCMD_CmdTriggerArm(char const *arg0, char const *arg1);
+uint8_t DMMCMD_CmdTriggerFire();
+uint8_t DMMCMD_ProcessTrigger();
 uint8_t DMMCMD_CmdCalibP(char const *arg0);
 uint8_t DMMCMD_CmdCalibN(char const *arg0);
 uint8_t DMMCMD_CmdCalibZ();
@@ -64,6 +86,7 @@ uint8_t DMMCMD_ProcessRepeatedCmd();
 
 /* ************************************************************************** */
 
+#if DMMCONFIG_CMD
 #define	CMD_IDX_SETSCALE   			 0
 #define	CMD_IDX_MEASUREREP			 1
 #define	CMD_IDX_MEASURESTOP			 2
@@ -77,47 +100,107 @@ uint8_t DMMCMD_ProcessRepeatedCmd();
 #define	CMD_IDX_RESTOREFACTCALIBS	10
 #define	CMD_IDX_EXPORTCALIB			11
 #define	CMD_IDX_IMPORTCALIB			12
+#define	CMD_IDX_MEASURESTATS		13
+#define	CMD_IDX_SETFILTER			14
+#define	CMD_IDX_SETRATE				15
+#define	CMD_IDX_PEAKHOLD			16
+#define	CMD_IDX_MEASURELPF			17
+#define	CMD_IDX_MEASUREDUAL			18
+#define	CMD_IDX_READRAWCODE			19
+#define	CMD_IDX_TRIGGER				20
+#define	CMD_IDX_TRIGGERARM			21
+#define	CMD_IDX_TRIGGERFIRE			22
+#define	CMD_IDX_SETFORMAT			23
+#define	CMD_IDX_TRACE				24
+#define	CMD_IDX_STATS				25
 
-#define CMDS_CNT					13
+#define CMDS_CNT					26
 #define REPEAT_THRESHOLD 5
+#define REPEAT_MININTERVAL			1000	// minimum interval of the timed repeated measurements (us)
+
+// command line parser states, see DMMCMD_CheckForCommand
+#define CMDPARSE_KEYWORD			0	// receiving the command keyword
+#define CMDPARSE_ARGS				1	// receiving the arguments
+#define CMDPARSE_DISCARD			2	// the arguments do not fit the buffer, waiting for the line terminator
+#define CMDPARSE_ALLCMDS			((CMDS_CNT < 32) ? (((uint32_t)1 << CMDS_CNT) - 1): 0xFFFFFFFF)
+#if CMDS_CNT > 32
+#error "The command parser keeps the matching commands in a 32 bits mask"
+#endif
 
 /********************* Constant Arrays Definitions, placed in Flash ***************************/
 
-const char  scale_0[] PROGMEM = "Resistance50M";   
-const char  scale_1[] PROGMEM = "Resistance5M";
-const char  scale_2[] PROGMEM = "Resistance500k";
-const char  scale_3[] PROGMEM = "Resistance50k";
-const char  scale_4[] PROGMEM = "Resistance5k";
-const char  scale_5[] PROGMEM = "Resistance500";
-const char  scale_6[] PROGMEM = "Resistance50";   
-const char  scale_7[] PROGMEM = "VoltageDC50";
-const char  scale_8[] PROGMEM = "VoltageDC5";
-const char  scale_9[] PROGMEM = "VoltageDC500m";
-const char scale_10[] PROGMEM = "VoltageDC50m";   
-const char scale_11[] PROGMEM = "VoltageAC50";
-const char scale_12[] PROGMEM = "VoltageAC5";
-const char scale_13[] PROGMEM = "VoltageAC500m";
-const char scale_14[] PROGMEM = "VoltageAC50m";
-const char scale_15[] PROGMEM = "CurrentDC5";
-const char scale_16[] PROGMEM = "CurrentAC5";   
-const char scale_17[] PROGMEM = "Continuity";
-const char scale_18[] PROGMEM = "Diode";
-const char scale_19[] PROGMEM = "CurrentDC500m";
-const char scale_20[] PROGMEM = "CurrentDC50m";   
-const char scale_21[] PROGMEM = "CurrentDC5m";
-const char scale_22[] PROGMEM = "CurrentDC500u";
-const char scale_23[] PROGMEM = "CurrentAC500m";
-const char scale_24[] PROGMEM = "CurrentAC50m";
-const char scale_25[] PROGMEM = "CurrentAC5m";
-const char scale_26[] PROGMEM = "CurrentAC500u";   
-
-
-// rgScales is a table to refer the scale strings strings.
-
-const char* const rgScales[] PROGMEM = {scale_0, scale_1, scale_2, scale_3, scale_4, scale_5, scale_6, scale_7, scale_8, scale_9,
-								scale_10, scale_11, scale_12, scale_13, scale_14, scale_15, scale_16, scale_17, scale_18, scale_19,
-								scale_20, scale_21, scale_22, scale_23, scale_24, scale_25, scale_26};
+// the scale names, generated from the scales list (dmmscales.h): scale_<name> strings
+
+#define DMMCMD_SCALENAME(name, ...)     const char scale_##name[] PROGMEM = #name;
+#define DMMCMD_SCALEREF(name, ...)      scale_##name,
+DMM_SCALES(DMMCMD_SCALENAME)
+
+// rgScales is a table to refer the scale strings strings, in the order of the scale indexes.
+
+const char* const rgScales[] PROGMEM = {DMM_SCALES(DMMCMD_SCALEREF)};
+
+
+const char filter_0[] PROGMEM = "None";
+const char filter_1[] PROGMEM = "Median";
+const char filter_2[] PROGMEM = "TrimmedMean";
+const char filter_3[] PROGMEM = "Hampel";
+
+// rgFilters is a table to refer the averaging filter strings, in the order of FILTER_xxx definitions.
+
+const char* const rgFilters[] PROGMEM = {filter_0, filter_1, filter_2, filter_3};
+
+const char family_0[] PROGMEM = "DC";
+const char family_1[] PROGMEM = "AC";
+const char family_2[] PROGMEM = "Resistance";
+
+// rgFamilies is a table to refer the scale family strings, in the order of DMM_FAMILY_xxx definitions.
+
+const char* const rgFamilies[] PROGMEM = {family_0, family_1, family_2};
+
+const char rate_0[] PROGMEM = "Normal";
+
+// rgRates is a table to refer the conversion rate strings, in the order of DMM_RATE_xxx definitions.
+
+const char* const rgRates[] PROGMEM = {rate_0};
+
+const char format_0[] PROGMEM = "Fixed";
+const char format_1[] PROGMEM = "Digits";
+const char format_2[] PROGMEM = "Eng";
+const char format_3[] PROGMEM = "Compact";
+
+// rgFormats is a table to refer the value format strings, in the order of DMM_FORMAT_xxx definitions.
 
+const char* const rgFormats[] PROGMEM = {format_0, format_1, format_2, format_3};
+
+const char trigsrc_0[] PROGMEM = "Immediate";
+const char trigsrc_1[] PROGMEM = "Pin";
+const char trigsrc_2[] PROGMEM = "Bus";
+const char trigsrc_3[] PROGMEM = "Timer";
+
+// rgTrigSources is a table to refer the trigger source strings, in the order of TRIGGER_SRC_xxx definitions.
+
+const char* const rgTrigSources[] PROGMEM = {trigsrc_0, trigsrc_1, trigsrc_2, trigsrc_3};
+
+const char perfev_0[] PROGMEM = "ConvReady";
+const char perfev_1[] PROGMEM = "ConvNotReady";
+const char perfev_2[] PROGMEM = "DataTimeout";
+const char perfev_3[] PROGMEM = "CfgVerifyFail";
+const char perfev_4[] PROGMEM = "EpromTimeout";
+const char perfev_5[] PROGMEM = "UnknownCmd";
+
+// rgPerfEvents is a table to refer the instrumentation event names, in the order of PERFCNT_EV_xxx definitions.
+
+const char* const rgPerfEvents[] PROGMEM = {perfev_0, perfev_1, perfev_2, perfev_3, perfev_4, perfev_5};
+
+const char perfsmp_0[] PROGMEM = "PollsPerValue";
+const char perfsmp_1[] PROGMEM = "GetValue(us)";
+const char perfsmp_2[] PROGMEM = "SetScale(us)";
+const char perfsmp_3[] PROGMEM = "EpromWrite(us)";
+const char perfsmp_4[] PROGMEM = "Command(us)";
+
+// rgPerfSamples is a table to refer the instrumentation sampled quantity names, in the order of PERFCNT_SMP_xxx definitions.
+
+const char* const rgPerfSamples[] PROGMEM = {perfsmp_0, perfsmp_1, perfsmp_2, perfsmp_3, perfsmp_4};
 
 								
 const char  cmd_0[] PROGMEM = "DMMSetScale";   
@@ -133,13 +216,27 @@ const char  cmd_9[] PROGMEM = "DMMSaveEPROM";
 const char cmd_10[] PROGMEM = "DMMRestoreFactCalibs";
 const char cmd_11[] PROGMEM = "DMMExportCalib";
 const char cmd_12[] PROGMEM = "DMMImportCalib";
+const char cmd_13[] PROGMEM = "DMMMeasureStats";
+const char cmd_14[] PROGMEM = "DMMSetFilter";
+const char cmd_15[] PROGMEM = "DMMSetRate";
+const char cmd_16[] PROGMEM = "DMMPeakHold";
+const char cmd_17[] PROGMEM = "DMMMeasureLPF";
+const char cmd_18[] PROGMEM = "DMMMeasureDual";
+const char cmd_19[] PROGMEM = "DMMReadRawCode";
+const char cmd_20[] PROGMEM = "DMMTrigger";
+const char cmd_21[] PROGMEM = "DMMTriggerArm";
+const char cmd_22[] PROGMEM = "DMMTriggerFire";
+const char cmd_23[] PROGMEM = "DMMSetFormat";
+const char cmd_24[] PROGMEM = "DMMTrace";
+const char cmd_25[] PROGMEM = "DMMStats";
 
 
 
 // rgcmds is a table to refer the cmd strings.
 
 const char* const rgcmds[] PROGMEM = {cmd_0, cmd_1, cmd_2, cmd_3, cmd_4, cmd_5, cmd_6, cmd_7, cmd_8, cmd_9,
-								cmd_10, cmd_11, cmd_12};
+								cmd_10, cmd_11, cmd_12, cmd_13, cmd_14, cmd_15, cmd_16, cmd_17, cmd_18, cmd_19,
+								cmd_20, cmd_21, cmd_22, cmd_23, cmd_24, cmd_25};
 								
 /* ************************************************************************** */
 /* Section: Global Data, local to this module                                 */
@@ -149,6 +246,10 @@ const char* const rgcmds[] PROGMEM = {cmd_0, cmd_1, cmd_2, cmd_3, cmd_4, cmd_5,
 // flags for repeated value and repeated raw value
 uint8_t fRepGetVal = 0;
 uint8_t fRepGetRaw = 0;
+// timed repeated measurements: interval (us), 0 when the repeated measurements are paced by REPEAT_THRESHOLD, 
+// and the scheduled time of the next measurement (micros)
+uint32_t dwRepInterval = 0;
+uint32_t dwRepNext;
 // variables used in multiple functions// allocate them only once.
 
 double dRefVal, dMeasuredVal;
@@ -158,6 +259,7 @@ char bufTxt[30];
 #define bufTxt_0	bufTxt			// character buffer in the first 10 chars of the bufRxr buffer
 #define bufTxt_1	bufTxt + 10		// character buffer in the mid 10 chars of the bufRxr buffer
 #define bufTxt_2	bufTxt + 20		// character buffer in the last 10 chars of the bufRxr buffer
+#endif
 
 /* ************************************************************************** */
 /* ************************************************************************** */
@@ -187,15 +289,21 @@ char bufTxt[30];
 uint8_t DMMCMD_Init(HardwareSerial *phwSerial)
 {
     // initializes the modules used by UART Command interpreter
-    uint8_t bErrCode;
+    uint8_t bErrCode = ERRVAL_SUCCESS;
 	DMM_Init();				// initialize the DMM module
+#if DMMCONFIG_SERIALNO
     SERIALNO_Init();		// initialize the SERIALNO module
+#endif
 	ERRORS_Init(phwSerial);	// initialize the ERRORS module
+#if DMMCONFIG_CMD
     pSerial = phwSerial;
     pszLastErr = ERRORS_GetszLastError();    
+#endif
     return bErrCode;
 }
 
+#if DMMCONFIG_CMD
+
 
 /***	DMMCMD_CheckForCommand()
 **
@@ -207,59 +315,122 @@ uint8_t DMMCMD_Init(HardwareSerial *phwSerial)
 **
 **	Description:
 **		This function checks on UART if a command was received. 
-**      It compares the received command with the commands defined in the commands array. 
-**		If recognized, its corresponding function is called with the needed parameters extracted from the command text.
+**      The received characters are parsed as they arrive, by a state machine:
+**      while the command keyword is received, the set of defined commands matching it so far is narrowed,
+**      so the keyword is recognized without being stored. Only the arguments are stored, in a CMD_MAX_LEN buffer.
+**      As soon as the line terminator arrives, the recognized command function is called with the arguments 
+**      extracted from the command text. A line whose arguments do not fit the buffer is discarded 
+**      until its terminator and an error message is sent.
+**      The received characters are processed before the repeated measurement, so that a command is dispatched
+**      in the same call its terminator is received.
+**      The repeated measurements are performed every REPEAT_THRESHOLD calls, or at the interval requested 
+**      in the DMMMeasureRep / DMMMeasureRaw command, see DMMCMD_ScheduleRepeatedCmd.
 **      
 */
 void DMMCMD_CheckForCommand()
 {
 	char c;
 	static int cntRepeat = 0;
-	static int idxChar = 0;
-	static char sCmd[CMD_MAX_LEN];
-	if(cntRepeat++ >= REPEAT_THRESHOLD)
-	{
-		DMMCMD_ProcessRepeatedCmd();
-		cntRepeat = 0;	// re-arm the repeat counter
-	}	
+	static uint8_t bState = CMDPARSE_KEYWORD;
+	static uint8_t cbKeyword = 0;
+	static uint8_t idxArgs = 0;
+	static uint32_t dwCandidates = CMDPARSE_ALLCMDS;	// one bit for each command matching the keyword received so far
+	static char sArgs[CMD_MAX_LEN];
+	uint8_t idxCmd;
+	DMMCMD_ProcessTrigger();	// an armed trigger is checked at every call, to keep its latency low
 	while(pSerial->available() > 0)
 	{
 		c = pSerial->read();
-//pSerial->print(c);
 		if(c == '\r' || c == '\n')
 		{
 			// recognize any of the line terminating chars.
-			if(idxChar > 2)
+			if(bState == CMDPARSE_DISCARD)
+			{
+				pSerial->println(F("ERROR, Command too long"));
+			}
+			else if(cbKeyword)
 			{	// ignore empty commands 
-				sCmd[idxChar++] = 0;	// terminating 0
-				// end of command, it can be found stored in the sCmd string
-				pSerial->print(F("COMMAND: "));
-				pSerial->println(sCmd);
-				DMMCMD_ProcessIndividualCmd(sCmd);
+				sArgs[idxArgs] = 0;	// terminating 0
+				// the command is the candidate whose text ends with the keyword
+				for(idxCmd = 0; idxCmd < CMDS_CNT && 
+					(!(dwCandidates & ((uint32_t)1 << idxCmd)) || pgm_read_byte((const char*)pgm_read_word(&(rgcmds[idxCmd])) + cbKeyword)); idxCmd++);
+				if(idxCmd < CMDS_CNT)
+				{
+					// the keyword is echoed from flash
+					pSerial->print(F("COMMAND: "));
+					pSerial->print((const __FlashStringHelper*)pgm_read_word(&(rgcmds[idxCmd])));
+					pSerial->print(' ');
+					pSerial->println(sArgs);
+				}
+				else
+				{
+					idxCmd = 0xFF;
+				}
+				DMMCMD_ProcessArgs(idxCmd, sArgs);
 			}
 			// prepare for the new cmd
 			while (!(*pSerial)) {
 			; // wait for serial port to connect. Needed for native USB
 			}
-			idxChar = 0;
+			bState = CMDPARSE_KEYWORD;
+			cbKeyword = 0;
+			idxArgs = 0;
+			dwCandidates = CMDPARSE_ALLCMDS;
 		}
-		else
+		else if(bState == CMDPARSE_KEYWORD)
 		{
-			// place the arrived char in the command string
-			sCmd[idxChar++] = c;		
+			if(c == ' ')
+			{
+				if(cbKeyword)
+				{
+					// end of the keyword, the arguments follow
+					bState = CMDPARSE_ARGS;
+				}
+				// the blanks before the keyword are ignored
+			}
+			else if(cbKeyword < 0xFF)
+			{
+				// keep the commands whose text continues with the received char
+				for(idxCmd = 0; idxCmd < CMDS_CNT; idxCmd++)
+				{
+					if((dwCandidates & ((uint32_t)1 << idxCmd)) && 
+						pgm_read_byte((const char*)pgm_read_word(&(rgcmds[idxCmd])) + cbKeyword) != c)
+					{
+						dwCandidates &= ~((uint32_t)1 << idxCmd);
+					}
+				}
+				cbKeyword++;
+			}
 		}
-		if(idxChar >= CMD_MAX_LEN)
+		else if(bState == CMDPARSE_ARGS)
 		{
-			// command too long; (re)start from the beginning of the buffer
-			idxChar = 0;
+			// place the arrived char in the arguments string
+			if(idxArgs < CMD_MAX_LEN - 1)
+			{
+				sArgs[idxArgs++] = c;
+			}
+			else
+			{
+				// arguments too long; discard the rest of the line
+				bState = CMDPARSE_DISCARD;
+			}
 		}
 	}
+	if(dwRepInterval)
+	{
+		DMMCMD_ScheduleRepeatedCmd();
+	}
+	else if(cntRepeat++ >= REPEAT_THRESHOLD)
+	{
+		DMMCMD_ProcessRepeatedCmd();
+		cntRepeat = 0;	// re-arm the repeat counter
+	}	
 }
 
 /***	DMMCMD_GetCmdIdx()
 **
 **	Parameters:
-**		    char *szCmd	- the string containing the command
+**		    CMDTOK *pTok	- the tokenizer, positioned at the beginning of the command string
 **
 **	Return Value:
 **          uint8_t 
@@ -267,55 +438,93 @@ void DMMCMD_CheckForCommand()
 **				- 0xFF if the command is not found among the defined commands
 **
 **	Description:
-**		This function compares the command against the defined commands. 
+**		This function compares the command keyword (the text before the first blank) against the defined commands. 
+**		The keyword is compared in place with the command texts placed in flash, without being copied.
+**		The tokenizer is advanced after the keyword, to the first argument.
 **		It returns the command index if found, otherwise returns 0xFF. 
 **      
 */
-uint8_t DMMCMD_GetCmdIdx(char *szCmd)
+uint8_t DMMCMD_GetCmdIdx(CMDTOK *pTok)
 {
-	uint8_t bResult = 0xFF;
 	uint8_t idxCmd;
-	char cmdTxt[20];
+	uint8_t cbCmd = 0;
+	char *pCmd = pTok->pNext;
+	const char *pCmdTxt;
 
-	char* szJustCmd = strtok(szCmd, " "); // the following calls to strtok function will continue from this point.
 	pszLastErr[0] = 0;  // empty last error string
-
-	if (szJustCmd)
+	if(!pCmd)
+	{
+		return 0xFF;
+	}
+	// the command keyword ends at the first blank
+	while(pCmd[cbCmd] && pCmd[cbCmd] != ' ')
 	{
-		// for each defined command
-		for(idxCmd = 0; bResult == 0xFF && idxCmd < CMDS_CNT; idxCmd++) 
+		cbCmd++;
+	}
+	// the arguments follow the blank
+	pTok->pNext = pCmd[cbCmd] ? pCmd + cbCmd + 1: NULL;
+	if(cbCmd)
+	{
+		// for each defined command, compare the keyword directly with the command text in flash
+		for(idxCmd = 0; idxCmd < CMDS_CNT; idxCmd++) 
 		{
-			// copy the command text from flash to cmdTxt
-			strcpy_P(cmdTxt, (char*)pgm_read_word(&(rgcmds[idxCmd])));					
-			
-			if(!strcmp(szJustCmd, cmdTxt)) 
+			pCmdTxt = (const char*)pgm_read_word(&(rgcmds[idxCmd]));
+			if(!strncmp_P(pCmd, pCmdTxt, cbCmd) && !pgm_read_byte(pCmdTxt + cbCmd)) 
 			{
-				bResult = idxCmd;				
+				return idxCmd;
 			}
 		}
 	}
-	return bResult;
+	return 0xFF;
 }
 
 
 /***	DMMCMD_CmdGetNextArg()
 **
 **	Parameters:
-**		    none
+**		    CMDTOK *pTok	- the tokenizer, advanced by DMMCMD_GetCmdIdx after the command keyword
 **
 **	Return Value:
-**          char *	- Zero-terminated string containing the next argument 
+**          char *	- Zero-terminated string containing the next argument, NULL if there are no more arguments
 **
 **	Description:
 **		This function tokenizes (using ',' separator) the arguments after a command. It must be called
-** 		immediately after DMMCMD_GetCmdIdx, once for every expected argument. No calls to
-** 		strtok are allowed meanwhile.
+** 		after DMMCMD_GetCmdIdx, once for every expected argument. 
+**		The argument is terminated in place (the separator is replaced by 0) and the leading blanks are skipped, 
+**		so no text is copied. All the state is kept in the tokenizer, so several command strings can be tokenized at the same time.
 **		It returns the text containing next argument. 
 **      
 */
-char* DMMCMD_CmdGetNextArg()
+char* DMMCMD_CmdGetNextArg(CMDTOK *pTok)
 {
-	return strtok(NULL, ",");
+	char *pArg = pTok->pNext;
+	char *pSep;
+	if(!pArg)
+	{
+		return NULL;
+	}
+	// skip the blanks after the separator
+	while(*pArg == ' ')
+	{
+		pArg++;
+	}
+	if(!*pArg)
+	{
+		pTok->pNext = NULL;
+		return NULL;
+	}
+	// terminate the argument in place, on the separator
+	for(pSep = pArg; *pSep && *pSep != ','; pSep++);
+	if(*pSep)
+	{
+		*pSep = 0;
+		pTok->pNext = pSep + 1;
+	}
+	else
+	{
+		pTok->pNext = NULL;
+	}
+	return pArg;
 }
 /***	DMMCMD_ProcessIndividualCmd
 **
@@ -335,14 +544,40 @@ char* DMMCMD_CmdGetNextArg()
 */	
 void DMMCMD_ProcessIndividualCmd(char *szCmd)
 {
-	DMMCMD_ProcessCmd(DMMCMD_GetCmdIdx(szCmd));
+	CMDTOK tok;
+	tok.pNext = szCmd;
+	DMMCMD_ProcessCmd(DMMCMD_GetCmdIdx(&tok), &tok);
+
+}
 
+/***	DMMCMD_ProcessArgs
+**
+**	Parameters:
+**
+**     uint8_t idxCmd        - the command index, 0xFF for an unrecognized command
+**     char *szArgs          - the string containing the command arguments
+**
+**	Return Value:
+**		none
+**
+**	Description:
+**		This function processes a command already recognized by the command line parser, 
+**		tokenizing its arguments in place.
+**
+*/	
+void DMMCMD_ProcessArgs(uint8_t idxCmd, char *szArgs)
+{
+	CMDTOK tok;
+	tok.pNext = szArgs;
+	pszLastErr[0] = 0;  // empty last error string
+	DMMCMD_ProcessCmd(idxCmd, &tok);
 }
 
 /***	DMMCMD_CMD_ProcessCmd
 **
 **	Parameters:
 **     int idxCmd           - the command index 
+**     CMDTOK *pTok         - the tokenizer, positioned at the first argument of the command
 **
 **	Return Value:
 **		none
@@ -352,234 +587,1167 @@ void DMMCMD_ProcessIndividualCmd(char *szCmd)
 **		If the command is not recognized, "Unrecognized command" message is raised.
 **
 **
-*/	
-void DMMCMD_ProcessCmd(uint8_t idxCmd)
+*/	
+void DMMCMD_ProcessCmd(uint8_t idxCmd, CMDTOK *pTok)
+{
+    PERFCNT_TIME_START(dwStart);
+    switch(idxCmd)
+    {
+        case CMD_IDX_SETSCALE:
+        	DMMCMD_CmdConfig(DMMCMD_CmdGetNextArg(pTok));
+            break;
+        case CMD_IDX_MEASUREREP:
+        	DMMCMD_CmdMeasureRep(DMMCMD_CmdGetNextArg(pTok));
+            break;
+        case CMD_IDX_MEASURESTOP:
+        	DMMCMD_CmdMeasureStop();
+            break;
+#if DMMCONFIG_CALIB
+        case CMD_IDX_CALIBP:
+        	DMMCMD_CmdCalibP(DMMCMD_CmdGetNextArg(pTok));
+            break;
+        case CMD_IDX_CALIBN:
+        	DMMCMD_CmdCalibN(DMMCMD_CmdGetNextArg(pTok));
+            break;
+        case CMD_IDX_CALIBZ:
+        	DMMCMD_CmdCalibZ();
+            break;
+#endif
+		
+        case CMD_IDX_MEASURERAW:
+        	DMMCMD_CmdMeasureRaw(DMMCMD_CmdGetNextArg(pTok));
+            break;
+
+        case CMD_IDX_MEASUREAVG:
+        	DMMCMD_CmdMeasureAvg();
+            break;	
+        case CMD_IDX_MEASURESTATS:
+        	DMMCMD_CmdMeasureStats(DMMCMD_CmdGetNextArg(pTok));
+            break;	
+        case CMD_IDX_SETFILTER:
+        	DMMCMD_CmdSetFilter(DMMCMD_CmdGetNextArg(pTok));
+            break;	
+        case CMD_IDX_SETRATE:
+		{
+			// force the evaluation order of function arguments
+			char *a0 = DMMCMD_CmdGetNextArg(pTok);
+			char *a1 = DMMCMD_CmdGetNextArg(pTok);
+        	DMMCMD_CmdSetRate(a0, a1);
+		}
+            break;	
+        case CMD_IDX_SETFORMAT:
+		{
+			// force the evaluation order of function arguments
+			char *a0 = DMMCMD_CmdGetNextArg(pTok);
+			char *a1 = DMMCMD_CmdGetNextArg(pTok);
+        	DMMCMD_CmdSetFormat(a0, a1);
+		}
+            break;	
+        case CMD_IDX_PEAKHOLD:
+        	DMMCMD_CmdPeakHold(DMMCMD_CmdGetNextArg(pTok));
+            break;	
+        case CMD_IDX_MEASURELPF:
+        	DMMCMD_CmdMeasureLPF();
+            break;	
+        case CMD_IDX_MEASUREDUAL:
+        	DMMCMD_CmdMeasureDual();
+            break;	
+        case CMD_IDX_READRAWCODE:
+        	DMMCMD_CmdReadRawCode();
+            break;	
+        case CMD_IDX_TRACE:
+        	DMMCMD_CmdTrace(DMMCMD_CmdGetNextArg(pTok));
+            break;	
+        case CMD_IDX_STATS:
+        	DMMCMD_CmdStats(DMMCMD_CmdGetNextArg(pTok));
+            break;	
+        case CMD_IDX_TRIGGER:
+		{
+			// force the evaluation order of function arguments
+			char *a0 = DMMCMD_CmdGetNextArg(pTok);
+			char *a1 = DMMCMD_CmdGetNextArg(pTok);
+			char *a2 = DMMCMD_CmdGetNextArg(pTok);
+        	DMMCMD_CmdTrigger(a0, a1, a2);
+		}
+            break;	
+        case CMD_IDX_TRIGGERARM:
+		{
+			// force the evaluation order of function arguments
+			char *a0 = DMMCMD_CmdGetNextArg(pTok);
+			char *a1 = DMMCMD_CmdGetNextArg(pTok);
+        	DMMCMD_CmdTriggerArm(a0, a1);
+		}
+            break;	
+        case CMD_IDX_TRIGGERFIRE:
+        	DMMCMD_CmdTriggerFire();
+            break;	
+#if DMMCONFIG_CALIB
+        case CMD_IDX_SAVEEPROM:
+        	DMMCMD_CmdSaveEPROM();
+            break;
+		case CMD_IDX_RESTOREFACTCALIBS:
+        	DMMCMD_CmdRestoreFactCalib();
+            break;
+#endif
+#if DMMCONFIG_SERIALNO
+        case CMD_IDX_READSERIALNO:
+        	DMMCMD_CmdReadSerialNo();
+            break;			
+#endif
+#if DMMCONFIG_CALIB
+        case CMD_IDX_EXPORTCALIB:
+        	DMMCMD_CmdExportCalib(DMMCMD_CmdGetNextArg(pTok));
+            break;
+        case CMD_IDX_IMPORTCALIB:
+		{
+			// force the evaluation order of function arguments
+			char *a0 = DMMCMD_CmdGetNextArg(pTok);
+			char *a1 = DMMCMD_CmdGetNextArg(pTok);
+			char *a2 = DMMCMD_CmdGetNextArg(pTok);
+			DMMCMD_CmdImportCalib(a0, a1, a2);
+		}
+            break;
+#endif
+		
+//
+        default:
+			pSerial->println(F("Unrecognized command"));
+			PERFCNT_EVENT(PERFCNT_EV_CMDUNKNOWN);
+            break;
+    }
+    PERFCNT_TIME_STOP(PERFCNT_SMP_CMD, dwStart);
+    IDLE_Delay(100);
+    return;
+}
+
+/***	DMMCMD_ProcessRepeatedCmd
+**
+**	Parameters:
+**     none
+**
+**	Return Value:
+**		uint8_t     - the error code
+**          ERRVAL_SUCCESS              0       // success
+**          ERRVAL_DMM_VALIDDATATIMEOUT 0xFA    // valid data DMM timeout
+**          ERRVAL_DMM_IDXCONFIG        0xFC    // error, wrong current scale index
+**
+**	Description:
+**		This function implements the repeated session functionality for DMMMeasureRep and DMMMeasureRaw text commands of DMMCMD module.
+**		The function calls the DMM_GetSample, eventually without calibration parameters being applied for DMMMeasureRaw.
+**		In case of success, the returned value is formatted and sent over UART, followed by 
+**      the conversion sequence number and the conversion timestamp (micros).
+**		In case of error, the error specific message is sent over UART.
+**      The function is called by DMMCMD_ProcessCmd function.
+*/
+uint8_t DMMCMD_ProcessRepeatedCmd()
+{
+	uint8_t bErrCode = ERRVAL_SUCCESS;
+	DMMSAMPLE sample;
+    if(fRepGetVal || fRepGetRaw)
+    {
+        if(fRepGetRaw)
+        {
+        	DMM_SetUseCalib(0);
+        }
+        bErrCode = DMM_GetSample(&sample);
+        DMM_SetUseCalib(1);
+        if(bErrCode == ERRVAL_SUCCESS)
+        {
+			DMM_FormatValue(sample.dVal, bufTxt, 1);
+			if(fRepGetRaw)
+			{
+				pSerial->print(F("Raw "));
+			}
+			pSerial->print(F("Value: "));
+            pSerial->print(bufTxt);
+			pSerial->print(F(", Seq="));
+			pSerial->print(sample.dwSeq);
+			pSerial->print(F(", T="));
+			pSerial->println(sample.dwTime);
+        }
+        else
+        {
+            ERRORS_PrintMessageString(bErrCode, "");
+        }
+    }
+    return bErrCode;
+}
+
+/***	DMMCMD_CmdConfig
+**
+**	Parameters:
+**     char const *arg0           - the character string containing the first command argument, to be interpreted as scale index (integer) 
+**
+**	Return Value:
+**		uint8_t     - the error code
+**          ERRVAL_SUCCESS            0      // success
+**          ERRVAL_DMM_IDXCONFIG     0xFC    // error, wrong scale index
+**          ERRVAL_DMM_CFGVERIFY     0xF5    // DMM Configuration verify error
+**
+**	Description:
+**		This function implements the DMMConfig text command of DMMCMD module.
+**      It searches the argument among the defined scales in order to detect the scale index, 
+**      then it calls DMM_SetScale providing the scale index as parameter.
+**      The function sends over UART the success message or the error message.
+**      The function returns the error code, which is the error code returned by the DMM_SetScale function.
+**      The function is called by DMMCMD_ProcessCmd function.
+**      
+*/
+uint8_t DMMCMD_CmdConfig(char const *arg0)
+{
+	uint8_t bErrCode = ERRVAL_SUCCESS;
+	int idxScale;
+	char scaleName[20];
+    for(idxScale = 0; idxScale < DMM_CNTSCALES; idxScale++)
+    {
+		strcpy_P(scaleName, (char*)pgm_read_word(&(rgScales[idxScale])));
+        if(!strcmp(arg0, scaleName))
+        {
+            bErrCode = DMM_SetScale(idxScale);// send the selected configuration to the DMM
+            if(bErrCode == ERRVAL_SUCCESS)
+            {
+                pSerial->print(F("OK, Selected scale index is: "));
+                pSerial->println(idxScale);
+			}
+            else
+            {
+                ERRORS_PrintMessageString(bErrCode, "");
+            }
+            return bErrCode;
+        }
+    }
+	pSerial->print(F("ERROR, Missing valid scale: "));
+	pSerial->println(arg0);	
+    return bErrCode;
+}
+
+/***	DMMCMD_CmdMeasureRep
+**
+**	Parameters:
+**     char const *arg0           - the character string containing the first command argument, optional measurement interval
+**
+**	Return Value:
+**		uint8_t     - the error code
+**          ERRVAL_SUCCESS            0      // success
+**          ERRVAL_CMD_WRONGPARAMS    0xF9   // wrong measurement interval
+**
+**	Description:
+**		This function initiates the DMMMeasureRep repeated command session of DMMCMD module. 
+**      The optional argument is the measurement interval, for example "10ms", see DMMCMD_StartRepeatedCmd.
+**      The function is called by DMMCMD_ProcessCmd function.
+**
+*/
+uint8_t DMMCMD_CmdMeasureRep(char const *arg0)
+{
+	uint8_t bErrCode = DMMCMD_StartRepeatedCmd(arg0);
+	if(bErrCode == ERRVAL_SUCCESS)
+	{
+		fRepGetVal = 1;
+		fRepGetRaw = 0;
+		pSerial->println(F("Measure repeated"));
+		DMMCMD_ScheduleRepeatedCmd();
+	}
+    return bErrCode;
+}
+
+/***	DMMCMD_CmdMeasureStop
+**
+**	Parameters:
+**     none
+**
+**	Return Value:
+**		uint8_t     - the error code
+**          ERRVAL_SUCCESS            0      // success
+**
+**	Description:
+**		This function terminates the DMMMeasureRep and DMMMeasureRaw repeated command sessions of DMMCMD module. 
+**      The function always returns success: ERRVAL_SUCCESS.
+**      The function is called by DMMCMD_ProcessCmd function.
+**
+*/
+uint8_t DMMCMD_CmdMeasureStop()
+{
+	fRepGetVal = 0;
+	fRepGetRaw = 0;
+    pSerial->println(F("Stop measurement"));
+    return ERRVAL_SUCCESS;
+}
+
+/***	DMMCMD_CmdMeasureRaw
+**
+**	Parameters:
+**     char const *arg0           - the character string containing the first command argument, optional measurement interval
+**
+**	Return Value:
+**		uint8_t     - the error code
+**          ERRVAL_SUCCESS            0      // success
+**          ERRVAL_CMD_WRONGPARAMS    0xF9   // wrong measurement interval
+**
+**	Description:
+**		This function initiates the DMMMeasureRaw repeated command session of DMMCMD module. 
+**      The optional argument is the measurement interval, for example "10ms", see DMMCMD_StartRepeatedCmd.
+**      The function is called by DMMCMD_ProcessCmd function.
+**
+*/
+uint8_t DMMCMD_CmdMeasureRaw(char const *arg0)
+{
+	uint8_t bErrCode = DMMCMD_StartRepeatedCmd(arg0);
+	if(bErrCode == ERRVAL_SUCCESS)
+	{
+		fRepGetVal = 0;
+		fRepGetRaw = 1;
+		pSerial->println(F("Measure raw"));
+		DMMCMD_ScheduleRepeatedCmd();
+	}
+    return bErrCode;
+}
+
+/***	DMMCMD_StartRepeatedCmd
+**
+**	Parameters:
+**     char const *arg0           - the character string containing the measurement interval, can be NULL
+**
+**	Return Value:
+**		uint8_t     - the error code
+**          ERRVAL_SUCCESS            0      // success
+**          ERRVAL_CMD_WRONGPARAMS    0xF9   // wrong measurement interval
+**
+**	Description:
+**		This function prepares the repeated measurements scheduling. 
+**      The interval is a number followed by an optional unit: "us", "ms" (default) or "s", for example "10ms" or "0.5 s".
+**      It must be at least REPEAT_MININTERVAL microseconds. The first measurement is scheduled immediately.
+**      When no interval is provided, the repeated measurements are performed every REPEAT_THRESHOLD calls of DMMCMD_CheckForCommand.
+**      The function sends over UART the error message if the interval is not valid.
+**      The function is called by DMMCMD_CmdMeasureRep and DMMCMD_CmdMeasureRaw functions.
+**
+*/
+uint8_t DMMCMD_StartRepeatedCmd(char const *arg0)
+{
+	char *pUnit;
+	double dInterval = 0;
+	if(arg0)
+	{
+		dInterval = strtod(arg0, &pUnit);
+		while(*pUnit == ' ')
+		{
+			pUnit++;
+		}
+		if(!strncmp(pUnit, "us", 2))
+		{
+			pUnit += 2;
+		}
+		else if(!strncmp(pUnit, "s", 1))
+		{
+			dInterval *= 1e6;
+			pUnit++;
+		}
+		else
+		{
+			// ms is the default unit
+			dInterval *= 1e3;
+			pUnit += (!strncmp(pUnit, "ms", 2)) ? 2: 0;
+		}
+		while(*pUnit == ' ')
+		{
+			pUnit++;
+		}
+		if(*pUnit || dInterval < REPEAT_MININTERVAL || dInterval > 3600e6)
+		{
+			pSerial->println(F("ERROR, Expected interval: <number>[us|ms|s], at least 1 ms"));
+			return ERRVAL_CMD_WRONGPARAMS;
+		}
+	}
+	dwRepInterval = (uint32_t)dInterval;
+	dwRepNext = micros();
+	return ERRVAL_SUCCESS;
+}
+
+/***	DMMCMD_ScheduleRepeatedCmd
+**
+**	Parameters:
+**     none
+**
+**	Return Value:
+**		none
+**
+**	Description:
+**		This function performs the timed repeated measurements, calling DMMCMD_ProcessRepeatedCmd when the scheduled time is reached. 
+**		The following measurement is scheduled one interval after the previous scheduled time (not after the actual one), 
+**      so the delays of the main loop do not accumulate as drift. 
+**      If the measurement could not keep up with the interval, the missed measurements are skipped 
+**      and an overrun message is sent over UART, with the number of skipped measurements.
+**      The function is called by DMMCMD_CheckForCommand function.
+**
+*/
+void DMMCMD_ScheduleRepeatedCmd()
+{
+	uint32_t dwNow = micros();
+	uint32_t cntMissed;
+	if(!(fRepGetVal || fRepGetRaw) || (int32_t)(dwNow - dwRepNext) < 0)
+	{
+		return;
+	}
+	DMMCMD_ProcessRepeatedCmd();
+	if(!dwRepInterval)
+	{
+		return;
+	}
+	dwRepNext += dwRepInterval;
+	dwNow = micros();
+	if((int32_t)(dwNow - dwRepNext) >= 0)
+	{
+		// overrun: skip the measurements whose scheduled time has already passed
+		cntMissed = (dwNow - dwRepNext) / dwRepInterval + 1;
+		dwRepNext += cntMissed * dwRepInterval;
+		pSerial->print(F("Overrun, skipped: "));
+		pSerial->println(cntMissed);
+	}
+}
+/***	DMMCMD_CmdMeasureAvg
+**
+**	Parameters:
+**     none
+**
+**	Return Value:
+**		uint8_t     - the error code
+**          ERRVAL_SUCCESS              0       // success
+**          ERRVAL_DMM_VALIDDATATIMEOUT 0xFA    // valid data DMM timeout
+**          ERRVAL_DMM_IDXCONFIG        0xFC    // error, wrong current scale index
+**
+**	Description:
+**		This function implements the DMMMeasureAVG text command of DMMCMD module.
+**		The function calls the DMM_DGetAvgValue.
+**		In case of success, the returned value is formatted and sent over UART.
+**		In case of error, the error specific message is sent over UART.
+**      The function returns the error code, which is the error code raised by the DMM_DGetAvgValue function.
+**      The function is called by DMMCMD_ProcessCmd function.
+**
+*/
+uint8_t DMMCMD_CmdMeasureAvg()
+{
+	uint8_t bErrCode = ERRVAL_SUCCESS;
+    dMeasuredVal = DMM_DGetAvgValue(MEASURE_CNT_AVG, &bErrCode);
+    fRepGetVal = 0;
+    fRepGetRaw = 0;
+
+	if(bErrCode == ERRVAL_SUCCESS)
+	{
+		DMM_FormatValue(dMeasuredVal, bufTxt, 1);
+		pSerial->print(F("Avg. Value: "));
+		pSerial->println(bufTxt);
+	}
+	else
+	{
+		ERRORS_PrintMessageString(bErrCode, "");
+	}
+
+    return bErrCode;
+}
+
+/***	DMMCMD_CmdMeasureLPF
+**
+**	Parameters:
+**     none
+**
+**	Return Value:
+**		uint8_t     - the error code
+**          ERRVAL_SUCCESS              0       // success
+**          ERRVAL_DMM_IDXCONFIG        0xFC    // error, wrong current scale index
+**          ERRVAL_DMM_SCALEFUNCTION    0xEF    // the function is not available on the current scale
+**
+**	Description:
+**		This function implements the DMMMeasureLPF text command of DMMCMD module.
+**		The function calls the DMM_DGetLPFValue, to get the on-chip low pass filtered value.
+**		In case of success, the returned value is formatted and sent over UART.
+**		In case of error, the error specific message is sent over UART.
+**      The function returns the error code, which is the error code raised by the DMM_DGetLPFValue function.
+**      The function is called by DMMCMD_ProcessCmd function.
+**
+*/
+uint8_t DMMCMD_CmdMeasureLPF()
+{
+	uint8_t bErrCode = ERRVAL_SUCCESS;
+    dMeasuredVal = DMM_DGetLPFValue(&bErrCode);
+    fRepGetVal = 0;
+    fRepGetRaw = 0;
+
+	if(bErrCode == ERRVAL_SUCCESS)
+	{
+		DMM_FormatValue(dMeasuredVal, bufTxt, 1);
+		pSerial->print(F("LPF Value: "));
+		pSerial->println(bufTxt);
+	}
+	else
+	{
+		ERRORS_PrintMessageString(bErrCode, "");
+	}
+
+    return bErrCode;
+}
+
+/***	DMMCMD_CmdMeasureDual
+**
+**	Parameters:
+**     none
+**
+**	Return Value:
+**		uint8_t     - the error code
+**          ERRVAL_SUCCESS              0       // success
+**          ERRVAL_DMM_VALIDDATATIMEOUT 0xFA    // valid data DMM timeout
+**          ERRVAL_DMM_IDXCONFIG        0xFC    // error, wrong current scale index
+**          ERRVAL_DMM_SCALEFUNCTION    0xEF    // the function is not available on the current scale
+**
+**	Description:
+**		This function implements the DMMMeasureDual text command of DMMCMD module.
+**		The function calls the DMM_DGetDualValue, to get the DMM value and the AD2 value from the same registers read.
+**		In case of success, the returned values are formatted and sent over UART.
+**		In case of error, the error specific message is sent over UART.
+**      The function returns the error code, which is the error code raised by the DMM_DGetDualValue function.
+**      The function is called by DMMCMD_ProcessCmd function.
+**
+*/
+uint8_t DMMCMD_CmdMeasureDual()
+{
+	uint8_t bErrCode = ERRVAL_SUCCESS;
+	double dVal2;
+    dMeasuredVal = DMM_DGetDualValue(&dVal2, &bErrCode);
+    fRepGetVal = 0;
+    fRepGetRaw = 0;
+
+	if(bErrCode == ERRVAL_SUCCESS)
+	{
+		DMM_FormatValue(dMeasuredVal, bufTxt, 1);
+		pSerial->print(F("Value: "));
+		pSerial->print(bufTxt);
+		DMM_FormatValue(dVal2, bufTxt, 1);
+		pSerial->print(F(", AD2: "));
+		pSerial->println(bufTxt);
+	}
+	else
+	{
+		ERRORS_PrintMessageString(bErrCode, "");
+	}
+
+    return bErrCode;
+}
+
+/***	DMMCMD_CmdReadRawCode
+**
+**	Parameters:
+**     none
+**
+**	Return Value:
+**		uint8_t     - the error code
+**          ERRVAL_SUCCESS              0       // success
+**          ERRVAL_DMM_IDXCONFIG        0xFC    // error, wrong current scale index
+**
+**	Description:
+**		This function implements the DMMReadRawCode text command of DMMCMD module.
+**		The function calls the DMM_GetRawCode and sends over UART, without any floating point conversion, 
+**      a line containing (comma separated) the scale index, the calibration generation, the intf flags (hex), 
+**      the signed AD1 code (decimal) and the RMS accumulator (10 hex digits, MS byte first). 
+**      The line can be decoded on host using the extras/host decoding library.
+**		In case of error, the error specific message is sent over UART.
+**      The function is called by DMMCMD_ProcessCmd function.
+**
+*/
+uint8_t DMMCMD_CmdReadRawCode()
+{
+	DMMRAW raw;
+	int i;
+	uint8_t bErrCode = DMM_GetRawCode(&raw);
+    fRepGetVal = 0;
+    fRepGetRaw = 0;
+
+	if(bErrCode == ERRVAL_SUCCESS)
+	{
+		pSerial->print(F("Raw code: "));
+		pSerial->print(raw.idxScale);
+		pSerial->print(F(", "));
+		pSerial->print(raw.bCalibGen);
+		pSerial->print(F(", "));
+		pSerial->print(raw.intf, HEX);
+		pSerial->print(F(", "));
+		pSerial->print(raw.ad1);
+		pSerial->print(F(", "));
+		for(i = 4; i >= 0; i--)
+		{
+			if(raw.rms[i] < 0x10)
+			{
+				pSerial->print('0');
+			}
+			pSerial->print(raw.rms[i], HEX);
+		}
+		pSerial->println(F(""));	// for new line
+	}
+	else
+	{
+		ERRORS_PrintMessageString(bErrCode, "");
+	}
+
+    return bErrCode;
+}
+
+/***	DMMCMD_CmdMeasureStats
+**
+**	Parameters:
+**     char const *arg0           - the character string containing the first command argument, to be interpreted as number of samples (integer).
+**                                  If missing, MEASURE_CNT_AVG samples are used.
+**
+**	Return Value:
+**		uint8_t     - the error code
+**          ERRVAL_SUCCESS              0       // success
+**          ERRVAL_DMM_VALIDDATATIMEOUT 0xFA    // valid data DMM timeout
+**          ERRVAL_DMM_IDXCONFIG        0xFC    // error, wrong current scale index
+**
+**	Description:
+**		This function implements the DMMMeasureStats text command of DMMCMD module.
+**		The function calls the DMM_DGetStats to acquire the requested number of samples.
+**		In case of success, the number of valid and invalid samples, the mean, standard deviation, 
+**		minimum, maximum and RMS values are formatted and sent over UART.
+**		In case of error, the error specific message is sent over UART.
+**      The function returns the error code, which is the error code returned by the DMM_DGetStats function.
+**      The function is called by DMMCMD_ProcessCmd function.
+**
+*/
+uint8_t DMMCMD_CmdMeasureStats(char const *arg0)
+{
+	uint8_t bErrCode = ERRVAL_SUCCESS;
+	DMMSTATACC acc;
+	int cbSamples = arg0 ? atoi(arg0) : 0;
+	if(cbSamples <= 0)
+	{
+		cbSamples = MEASURE_CNT_AVG;
+	}
+    bErrCode = DMM_DGetStats(cbSamples, &acc);
+    fRepGetVal = 0;
+    fRepGetRaw = 0;
+
+	if(bErrCode == ERRVAL_SUCCESS)
+	{
+		pSerial->print(F("Stats: N="));
+		pSerial->print(acc.cnt);
+		pSerial->print(F(", Invalid="));
+		pSerial->print(acc.cntInvalid);
+		pSerial->print(F(", Overload="));
+		pSerial->print(acc.cntOverload);
+		if(acc.cnt)
+		{
+			DMM_FormatValue(acc.dMean, bufTxt, 1);
+			pSerial->print(F(", Mean="));
+			pSerial->print(bufTxt);
+			if(acc.cnt > 1)
+			{
+				DMM_FormatValue(DMM_StatAccGetStdDev(&acc), bufTxt, 1);
+				pSerial->print(F(", StdDev="));
+				pSerial->print(bufTxt);
+			}
+			DMM_FormatValue(acc.dMin, bufTxt, 1);
+			pSerial->print(F(", Min="));
+			pSerial->print(bufTxt);
+			DMM_FormatValue(acc.dMax, bufTxt, 1);
+			pSerial->print(F(", Max="));
+			pSerial->print(bufTxt);
+			DMM_FormatValue(DMM_StatAccGetRMS(&acc), bufTxt, 1);
+			pSerial->print(F(", RMS="));
+			pSerial->print(bufTxt);
+		}
+		pSerial->println(F(""));	// for new line
+	}
+	else
+	{
+		ERRORS_PrintMessageString(bErrCode, "");
+	}
+
+    return bErrCode;
+}
+
+/***	DMMCMD_CmdSetFilter
+**
+**	Parameters:
+**     char const *arg0           - the character string containing the first command argument, to be interpreted as filter name
+**
+**	Return Value:
+**		uint8_t     - the error code
+**          ERRVAL_SUCCESS              0       // success
+**          ERRVAL_CMD_WRONGPARAMS      0xF9    // wrong parameters when sending UART commands
+**
+**	Description:
+**		This function implements the DMMSetFilter text command of DMMCMD module.
+**      It searches the argument among the defined filter names (None, Median, TrimmedMean, Hampel) in order to detect the filter, 
+**      then it calls DMM_SetAvgFilter providing the filter as parameter.
+**      The selected filter is used by DMMMeasureAvg command and by the calibration commands.
+**      The function sends over UART the success message or the error message.
+**      The function is called by DMMCMD_ProcessCmd function.
+**      
+*/
+uint8_t DMMCMD_CmdSetFilter(char const *arg0)
+{
+	uint8_t bFilter;
+	char filterName[12];
+	if(arg0)
+	{
+		for(bFilter = 0; bFilter < FILTER_CNT; bFilter++)
+		{
+			strcpy_P(filterName, (char*)pgm_read_word(&(rgFilters[bFilter])));
+			if(!strcmp(arg0, filterName))
+			{
+				DMM_SetAvgFilter(bFilter);
+				pSerial->print(F("OK, Selected filter is: "));
+				pSerial->println(filterName);
+				return ERRVAL_SUCCESS;
+			}
+		}
+	}
+	pSerial->println(F("ERROR, Expected filter: None, Median, TrimmedMean or Hampel"));
+	return ERRVAL_CMD_WRONGPARAMS;
+}
+
+/***	DMMCMD_CmdSetRate
+**
+**	Parameters:
+**     char const *arg0           - the character string containing the first command argument, to be interpreted as scale family (DC, AC, Resistance)
+**     char const *arg1           - the character string containing the second command argument, to be interpreted as rate profile (Normal)
+**
+**	Return Value:
+**		uint8_t     - the error code
+**          ERRVAL_SUCCESS              0       // success
+**          ERRVAL_CMD_WRONGPARAMS      0xF9    // wrong parameters when sending UART commands
+**          ERRVAL_DMM_CFGVERIFY        0xF5    // DMM Configuration verify error
+**
+**	Description:
+**		This function implements the DMMSetRate text command of DMMCMD module.
+**      It searches the arguments among the defined scale families and rate profiles, 
+**      then it calls DMM_SetConvRate providing the family and the rate profile as parameters.
+**      The function sends over UART the success message or the error message.
+**      The function returns the error code, which is the error code returned by the DMM_SetConvRate function.
+**      The function is called by DMMCMD_ProcessCmd function.
+**      
+*/
+uint8_t DMMCMD_CmdSetRate(char const *arg0, char const *arg1)
+{
+	uint8_t bErrCode = ERRVAL_CMD_WRONGPARAMS;
+	uint8_t bFamily, bRate;
+	if(arg0 && arg1)
+	{
+		// skip the blanks after the ',' separator
+		while(*arg1 == ' ')
+		{
+			arg1++;
+		}
+		for(bFamily = 0; bFamily < DMM_CNTFAMILIES && strcmp_P(arg0, (char*)pgm_read_word(&(rgFamilies[bFamily]))); bFamily++);
+		for(bRate = 0; bRate < DMM_CNTRATES && strcmp_P(arg1, (char*)pgm_read_word(&(rgRates[bRate]))); bRate++);
+		if(bFamily < DMM_CNTFAMILIES && bRate < DMM_CNTRATES)
+		{
+			bErrCode = DMM_SetConvRate(bFamily, bRate);
+			if(bErrCode == ERRVAL_SUCCESS)
+			{
+				pSerial->print(F("OK, Selected rate: "));
+				pSerial->print(arg0);
+				pSerial->print(F(", "));
+				pSerial->println(arg1);
+			}
+			else
+			{
+				ERRORS_PrintMessageString(bErrCode, "");
+			}
+			return bErrCode;
+		}
+	}
+	pSerial->println(F("ERROR, Expected <DC|AC|Resistance>, <Normal>"));
+	return bErrCode;
+}
+
+/***	DMMCMD_CmdSetFormat
+**
+**	Parameters:
+**     char const *arg0           - the character string containing the first command argument, to be interpreted as value format (Fixed, Digits, Eng, Compact)
+**     char const *arg1           - the character string containing the second command argument, optional number of significant digits
+**
+**	Return Value:
+**		uint8_t     - the error code
+**          ERRVAL_SUCCESS              0       // success
+**          ERRVAL_CMD_WRONGPARAMS      0xF9    // wrong parameters when sending UART commands
+**
+**	Description:
+**		This function implements the DMMSetFormat text command of DMMCMD module.
+**      It searches the first argument among the defined value formats, 
+**      then it calls DMM_SetFormat providing the format and the number of significant digits (default DMM_FORMAT_DEFDIGITS).
+**      The format is used for all the values sent over UART.
+**      The function sends over UART the success message or the error message.
+**      The function is called by DMMCMD_ProcessCmd function.
+**      
+*/
+uint8_t DMMCMD_CmdSetFormat(char const *arg0, char const *arg1)
+{
+	uint8_t bErrCode = ERRVAL_CMD_WRONGPARAMS;
+	uint8_t bFormat;
+	int cDigits = arg1 ? atoi(arg1) : DMM_FORMAT_DEFDIGITS;
+	if(arg0 && cDigits > 0 && cDigits <= DMM_FORMAT_MAXDIGITS)
+	{
+		for(bFormat = 0; bFormat < DMM_CNTFORMATS && strcmp_P(arg0, (char*)pgm_read_word(&(rgFormats[bFormat]))); bFormat++);
+		if(bFormat < DMM_CNTFORMATS)
+		{
+			bErrCode = DMM_SetFormat(bFormat, cDigits);
+		}
+	}
+	if(bErrCode == ERRVAL_SUCCESS)
+	{
+		pSerial->print(F("OK, Selected format: "));
+		pSerial->println(arg0);
+	}
+	else
+	{
+		pSerial->println(F("ERROR, Expected <Fixed|Digits|Eng|Compact>[, <digits 1..7>]"));
+	}
+	return bErrCode;
+}
+
+/***	DMMCMD_CmdPeakHold
+**
+**	Parameters:
+**     char const *arg0           - the character string containing the first command argument, optional "Reset"
+**
+**	Return Value:
+**		uint8_t     - the error code
+**          ERRVAL_SUCCESS              0       // success
+**          ERRVAL_DMM_IDXCONFIG        0xFC    // error, wrong current scale index
+**          ERRVAL_DMM_SCALEFUNCTION    0xEF    // the function is not available on the current scale
+**          ERRVAL_DMM_CFGVERIFY        0xF5    // DMM Configuration verify error
+**
+**	Description:
+**		This function implements the DMMPeakHold text command of DMMCMD module.
+**      When the argument is "Reset", it calls DMM_ResetPeakHold to restart the peak hold capture.
+**      Otherwise, it calls DMM_GetPeakHold and sends over UART the minimum and maximum values 
+**      captured since the last reset, formatted according to the current scale.
+**      Repeated measurements are stopped.
+**      The function sends over UART the error message if errors are detected.
+**      The function is called by DMMCMD_ProcessCmd function.
+**      
+*/
+uint8_t DMMCMD_CmdPeakHold(char const *arg0)
 {
-    switch(idxCmd)
-    {
-        case CMD_IDX_SETSCALE:
-        	DMMCMD_CmdConfig(DMMCMD_CmdGetNextArg());
-            break;
-        case CMD_IDX_MEASUREREP:
-        	DMMCMD_CmdMeasureRep();
-            break;
-        case CMD_IDX_MEASURESTOP:
-        	DMMCMD_CmdMeasureStop();
-            break;
-        case CMD_IDX_CALIBP:
-        	DMMCMD_CmdCalibP(DMMCMD_CmdGetNextArg());
-            break;
-        case CMD_IDX_CALIBN:
-        	DMMCMD_CmdCalibN(DMMCMD_CmdGetNextArg());
-            break;
-        case CMD_IDX_CALIBZ:
-        	DMMCMD_CmdCalibZ();
-            break;
-		
-        case CMD_IDX_MEASURERAW:
-        	DMMCMD_CmdMeasureRaw();
-            break;
-
-        case CMD_IDX_MEASUREAVG:
-        	DMMCMD_CmdMeasureAvg();
-            break;	
-        case CMD_IDX_SAVEEPROM:
-        	DMMCMD_CmdSaveEPROM();
-            break;
-		case CMD_IDX_RESTOREFACTCALIBS:
-        	DMMCMD_CmdRestoreFactCalib();
-            break;
-        case CMD_IDX_READSERIALNO:
-        	DMMCMD_CmdReadSerialNo();
-            break;			
-        case CMD_IDX_EXPORTCALIB:
-        	DMMCMD_CmdExportCalib(DMMCMD_CmdGetNextArg());
-            break;
-        case CMD_IDX_IMPORTCALIB:
+	uint8_t bErrCode;
+	double dMin, dMax;
+    fRepGetVal = 0;
+    fRepGetRaw = 0;
+	if(arg0 && !strcmp(arg0, "Reset"))
+	{
+		bErrCode = DMM_ResetPeakHold();
+		if(bErrCode == ERRVAL_SUCCESS)
 		{
-			// force the evaluation order of function arguments
-			char *a0 = DMMCMD_CmdGetNextArg();
-			char *a1 = DMMCMD_CmdGetNextArg();
-			char *a2 = DMMCMD_CmdGetNextArg();
-			DMMCMD_CmdImportCalib(a0, a1, a2);
+			pSerial->println(F("OK, Peak hold reset"));
 		}
-            break;
-		
-//
-        default:
-			pSerial->println(F("Unrecognized command"));
-            break;
-    }
-    delay(100);
-    return;
+	}
+	else
+	{
+		bErrCode = DMM_GetPeakHold(&dMin, &dMax);
+		if(bErrCode == ERRVAL_SUCCESS)
+		{
+			DMM_FormatValue(dMin, bufTxt, 1);
+			pSerial->print(F("Peak: Min="));
+			pSerial->print(bufTxt);
+			DMM_FormatValue(dMax, bufTxt, 1);
+			pSerial->print(F(", Max="));
+			pSerial->println(bufTxt);
+		}
+	}
+	if(bErrCode != ERRVAL_SUCCESS)
+	{
+		ERRORS_PrintMessageString(bErrCode, "");
+	}
+    return bErrCode;
 }
 
-/***	DMMCMD_ProcessRepeatedCmd
+/***	DMMCMD_CmdTrace
 **
 **	Parameters:
-**     none
+**     char const *arg0           - the character string containing the first command argument, optional "On", "Off" or "Clear"
 **
 **	Return Value:
 **		uint8_t     - the error code
 **          ERRVAL_SUCCESS              0       // success
-**          ERRVAL_DMM_VALIDDATATIMEOUT 0xFA    // valid data DMM timeout
-**          ERRVAL_DMM_IDXCONFIG        0xFC    // error, wrong current scale index
+**          ERRVAL_CMD_WRONGPARAMS      0xF9    // wrong argument
+**          ERRVAL_DMM_TRACEDISABLED    0xEE    // the trace is not included in the build (DMMTRACE_SIZE is 0)
 **
 **	Description:
-**		This function implements the repeated session functionality for DMMMeasureRep and DMMMeasureRaw text commands of DMMCMD module.
-**		The function calls the DMM_DGetValue, eventually without calibration parameters being applied for DMMMeasureRaw.
-**		In case of success, the returned value is formatted and sent over UART.
-**		In case of error, the error specific message is sent over UART.
+**		This function implements the DMMTrace text command of DMMCMD module.
+**      "On" and "Off" start and stop the recording of the DMM transactions, "Clear" discards the recorded transactions.
+**      Without argument, the recorded transactions are sent over UART, from the oldest, one per line: 
+**      "TR: <timestamp us>, <command byte hex>, <data bytes hex>". The lines can be replayed on host by extras/host/dmmreplay.
+**      The function sends over UART the error message if errors are detected.
 **      The function is called by DMMCMD_ProcessCmd function.
+**      
 */
-uint8_t DMMCMD_ProcessRepeatedCmd()
+uint8_t DMMCMD_CmdTrace(char const *arg0)
 {
 	uint8_t bErrCode = ERRVAL_SUCCESS;
-    if(fRepGetVal || fRepGetRaw)
-    {
-        if(fRepGetRaw)
-        {
-        	DMM_SetUseCalib(0);
-        }
-        dMeasuredVal = DMM_DGetValue(&bErrCode);
-        DMM_SetUseCalib(1);
-        if(bErrCode == ERRVAL_SUCCESS)
-        {
-			DMM_FormatValue(dMeasuredVal, bufTxt, 1);
-			if(fRepGetRaw)
+	DMMTRACEREC rec;
+	uint16_t idx;
+	uint8_t i;
+	if(!arg0)
+	{
+		pSerial->print(F("Trace: N="));
+		pSerial->println(DMMTRACE_GetCount());
+		for(idx = 0; DMMTRACE_GetRecord(idx, &rec) == ERRVAL_SUCCESS; idx++)
+		{
+			pSerial->print(F("TR: "));
+			pSerial->print(rec.dwTime);
+			pSerial->print(F(", "));
+			if(rec.bCmd < 0x10)
 			{
-				pSerial->print(F("Raw "));
+				pSerial->print('0');
 			}
-			pSerial->print(F("Value: "));
-            pSerial->println(bufTxt);
-        }
-        else
-        {
-            ERRORS_PrintMessageString(bErrCode, "");
-        }
-    }
+			pSerial->print(rec.bCmd, HEX);
+			pSerial->print(F(", "));
+			for(i = 0; i < rec.cb; i++)
+			{
+				if(rec.rgb[i] < 0x10)
+				{
+					pSerial->print('0');
+				}
+				pSerial->print(rec.rgb[i], HEX);
+			}
+			pSerial->println(F(""));	// for new line
+		}
+	}
+	else if(!strcmp(arg0, "On") || !strcmp(arg0, "Off"))
+	{
+		bErrCode = DMMTRACE_Enable(arg0[1] == 'n');
+		if(bErrCode == ERRVAL_SUCCESS)
+		{
+			pSerial->print(F("OK, Trace "));
+			pSerial->println(arg0);
+		}
+	}
+	else if(!strcmp(arg0, "Clear"))
+	{
+		DMMTRACE_Clear();
+		pSerial->println(F("OK, Trace cleared"));
+	}
+	else
+	{
+		bErrCode = ERRVAL_CMD_WRONGPARAMS;
+		pSerial->println(F("ERROR, Expected [On|Off|Clear]"));
+	}
+	if(bErrCode != ERRVAL_SUCCESS && bErrCode != ERRVAL_CMD_WRONGPARAMS)
+	{
+		ERRORS_PrintMessageString(bErrCode, "");
+	}
     return bErrCode;
 }
 
-/***	DMMCMD_CmdConfig
+/***	DMMCMD_CmdStats
 **
 **	Parameters:
-**     char const *arg0           - the character string containing the first command argument, to be interpreted as scale index (integer) 
+**     char const *arg0           - the character string containing the first command argument, optional "Reset"
 **
 **	Return Value:
 **		uint8_t     - the error code
-**          ERRVAL_SUCCESS            0      // success
-**          ERRVAL_DMM_IDXCONFIG     0xFC    // error, wrong scale index
-**          ERRVAL_DMM_CFGVERIFY     0xF5    // DMM Configuration verify error
+**          ERRVAL_SUCCESS              0       // success
+**          ERRVAL_CMD_WRONGPARAMS      0xF9    // wrong argument
 **
 **	Description:
-**		This function implements the DMMConfig text command of DMMCMD module.
-**      It searches the argument among the defined scales in order to detect the scale index, 
-**      then it calls DMM_SetScale providing the scale index as parameter.
-**      The function sends over UART the success message or the error message.
-**      The function returns the error code, which is the error code returned by the DMM_SetScale function.
+**		This function implements the DMMStats text command of DMMCMD module.
+**      Without argument, the instrumentation counters are sent over UART, one per line: 
+**      "<event>: <count>" for the event counters, then "<quantity>: <count>, <min>, <avg>, <max>" for the sampled quantities,
+**      then "ConvPeriod(us) <scale>: <period>" for the scales having a conversion period learned (see DMM_GetConvPeriod),
+**      then "IdleSleep(ms): <asleep>, <elapsed>" and "IdleSleep(%): <duty cycle>" for the time spent asleep (see IDLE_GetStats).
+**      The counters are omitted when they are not included in the build (PERFCNT_ENABLE is 0).
+**      "Reset" clears the counters and restarts the sleep duty cycle measurement.
+**      The function sends over UART the error message if errors are detected.
 **      The function is called by DMMCMD_ProcessCmd function.
 **      
 */
-uint8_t DMMCMD_CmdConfig(char const *arg0)
+uint8_t DMMCMD_CmdStats(char const *arg0)
 {
 	uint8_t bErrCode = ERRVAL_SUCCESS;
-	int idxScale;
-	char scaleName[20];
-    for(idxScale = 0; idxScale < DMM_CNTSCALES; idxScale++)
-    {
-		strcpy_P(scaleName, (char*)pgm_read_word(&(rgScales[idxScale])));
-        if(!strcmp(arg0, scaleName))
-        {
-            bErrCode = DMM_SetScale(idxScale);// send the selected configuration to the DMM
-            if(bErrCode == ERRVAL_SUCCESS)
-            {
-                pSerial->print(F("OK, Selected scale index is: "));
-                pSerial->println(idxScale);
+	PERFCNTSMP smp;
+	uint8_t idx;
+	uint32_t dwSleepMs, dwElapsedMs;
+	if(!arg0)
+	{
+		for(idx = 0; PERFCNT_ENABLE && idx < PERFCNT_CNTEVENTS; idx++)
+		{
+			pSerial->print((const __FlashStringHelper*)pgm_read_word(&(rgPerfEvents[idx])));
+			pSerial->print(F(": "));
+			pSerial->println(PERFCNT_GetEvent(idx));
+		}
+		for(idx = 0; PERFCNT_GetSample(idx, &smp) == ERRVAL_SUCCESS; idx++)
+		{
+			pSerial->print((const __FlashStringHelper*)pgm_read_word(&(rgPerfSamples[idx])));
+			pSerial->print(F(": "));
+			pSerial->print(smp.cnt);
+			pSerial->print(F(", "));
+			pSerial->print(smp.dwMin);
+			pSerial->print(F(", "));
+			pSerial->print(smp.cnt ? (uint32_t)(smp.qwSum / smp.cnt): 0);
+			pSerial->print(F(", "));
+			pSerial->println(smp.dwMax);
+		}
+		// the conversion periods learned by DMM_DGetValue
+		for(idx = 0; idx < DMM_CNTSCALES; idx++)
+		{
+			if(DMM_GetConvPeriod(idx))
+			{
+				pSerial->print(F("ConvPeriod(us) "));
+				pSerial->print((const __FlashStringHelper*)pgm_read_word(&(rgScales[idx])));
+				pSerial->print(F(": "));
+				pSerial->println(DMM_GetConvPeriod(idx));
 			}
-            else
-            {
-                ERRORS_PrintMessageString(bErrCode, "");
-            }
-            return bErrCode;
-        }
-    }
-	pSerial->print(F("ERROR, Missing valid scale: "));
-	pSerial->println(arg0);	
+		}
+		// the sleep duty cycle
+		IDLE_GetStats(&dwSleepMs, &dwElapsedMs);
+		pSerial->print(F("IdleSleep(ms): "));
+		pSerial->print(dwSleepMs);
+		pSerial->print(F(", "));
+		pSerial->println(dwElapsedMs);
+		pSerial->print(F("IdleSleep(%): "));
+		pSerial->println(dwElapsedMs ? (100.0 * dwSleepMs) / dwElapsedMs: 0.0, 1);
+	}
+	else if(!strcmp(arg0, "Reset"))
+	{
+		PERFCNT_Reset();
+		IDLE_ResetStats();
+		pSerial->println(F("OK, Stats reset"));
+	}
+	else
+	{
+		bErrCode = ERRVAL_CMD_WRONGPARAMS;
+		pSerial->println(F("ERROR, Expected [Reset]"));
+	}
     return bErrCode;
 }
 
-/***	DMMCMD_CmdMeasureRep
+/***	DMMCMD_CmdTrigger
 **
 **	Parameters:
-**     none
+**     char const *arg0           - the character string containing the first command argument, to be interpreted as trigger source (Immediate, Pin, Bus, Timer)
+**     char const *arg1           - the character string containing the second command argument, the pin number for the Pin source or the interval (us) for the Timer source
+**     char const *arg2           - the character string containing the third command argument, optional edge (Rising or Falling) for the Pin source
 **
 **	Return Value:
 **		uint8_t     - the error code
-**          ERRVAL_SUCCESS            0      // success
+**          ERRVAL_SUCCESS              0       // success
+**          ERRVAL_CMD_WRONGPARAMS      0xF9    // wrong parameters when sending UART commands
 **
 **	Description:
-**		This function initiates the DMMMeasureRep repeated command session of DMMCMD module. 
-**      The function always returns success: ERRVAL_SUCCESS.
+**		This function implements the DMMTrigger text command of DMMCMD module.
+**      It searches the first argument among the defined trigger sources, 
+**      then it calls TRIGGER_SetSource providing the source and its parameters.
+**      The edge of the Pin source defaults to Rising.
+**      The function sends over UART the success message or the error message.
 **      The function is called by DMMCMD_ProcessCmd function.
-**
+**      
 */
-uint8_t DMMCMD_CmdMeasureRep()
+uint8_t DMMCMD_CmdTrigger(char const *arg0, char const *arg1, char const *arg2)
 {
-	fRepGetVal = 1;
-	fRepGetRaw = 0;
-    pSerial->println(F("Measure repeated"));
-	DMMCMD_ProcessRepeatedCmd();
-    return ERRVAL_SUCCESS;
+	uint8_t bErrCode = ERRVAL_CMD_WRONGPARAMS;
+	uint8_t bSource;
+	uint8_t bEdge = TRIGGER_EDGE_RISING;
+	long lParam = arg1 ? atol(arg1) : 0;
+	if(arg0)
+	{
+		for(bSource = 0; bSource < TRIGGER_CNT_SRC && strcmp_P(arg0, (char*)pgm_read_word(&(rgTrigSources[bSource]))); bSource++);
+		if(arg2)
+		{
+			// skip the blanks after the ',' separator
+			while(*arg2 == ' ')
+			{
+				arg2++;
+			}
+			bEdge = !strcmp(arg2, "Falling") ? TRIGGER_EDGE_FALLING: (!strcmp(arg2, "Rising") ? TRIGGER_EDGE_RISING: 0xFF);
+		}
+		if(bSource < TRIGGER_CNT_SRC && lParam >= 0)
+		{
+			bErrCode = TRIGGER_SetSource(bSource, (uint8_t)lParam, bEdge, (uint32_t)lParam);
+		}
+	}
+	if(bErrCode == ERRVAL_SUCCESS)
+	{
+		pSerial->print(F("OK, Selected trigger: "));
+		pSerial->println(arg0);
+	}
+	else
+	{
+		pSerial->println(F("ERROR, Expected <Immediate|Bus>, <Pin>, <pin>[, <Rising|Falling>] or <Timer>, <us>"));
+	}
+	return bErrCode;
 }
 
-/***	DMMCMD_CmdMeasureStop
+/***	DMMCMD_CmdTriggerArm
 **
 **	Parameters:
-**     none
+**     char const *arg0           - the character string containing the first command argument, to be interpreted as number of pre-trigger samples
+**     char const *arg1           - the character string containing the second command argument, to be interpreted as number of post-trigger samples
 **
 **	Return Value:
 **		uint8_t     - the error code
-**          ERRVAL_SUCCESS            0      // success
+**          ERRVAL_SUCCESS              0       // success
+**          ERRVAL_CMD_WRONGPARAMS      0xF9    // wrong parameters when sending UART commands
 **
 **	Description:
-**		This function terminates the DMMMeasureRep and DMMMeasureRaw repeated command sessions of DMMCMD module. 
-**      The function always returns success: ERRVAL_SUCCESS.
+**		This function implements the DMMTriggerArm text command of DMMCMD module.
+**      It calls TRIGGER_Arm providing the number of pre and post trigger samples. 
+**      When only one argument is provided, it is interpreted as number of post-trigger samples.
+**      Repeated measurements are stopped. The captured samples are sent over UART by DMMCMD_ProcessTrigger.
+**      The function sends over UART the success message or the error message.
 **      The function is called by DMMCMD_ProcessCmd function.
-**
+**      
 */
-uint8_t DMMCMD_CmdMeasureStop()
+uint8_t DMMCMD_CmdTriggerArm(char const *arg0, char const *arg1)
 {
-	fRepGetVal = 0;
-	fRepGetRaw = 0;
-    pSerial->println(F("Stop measurement"));
-    return ERRVAL_SUCCESS;
+	uint8_t bErrCode = ERRVAL_CMD_WRONGPARAMS;
+	int cbPre = arg1 ? (arg0 ? atoi(arg0) : -1) : 0;
+	int cbPost = arg1 ? atoi(arg1) : (arg0 ? atoi(arg0) : 0);
+    fRepGetVal = 0;
+    fRepGetRaw = 0;
+	if(cbPre >= 0 && cbPost >= 0 && (cbPre + cbPost) <= TRIGGER_MAX_SAMPLES)
+	{
+		bErrCode = TRIGGER_Arm(cbPre, cbPost);
+	}
+	if(bErrCode == ERRVAL_SUCCESS)
+	{
+		pSerial->println(F("OK, Trigger armed"));
+	}
+	else
+	{
+		pSerial->print(F("ERROR, Expected [<pre>,] <post>, at most "));
+		pSerial->print(TRIGGER_MAX_SAMPLES);
+		pSerial->println(F(" samples"));
+	}
+	return bErrCode;
 }
 
-/***	DMMCMD_CmdMeasureRaw
+/***	DMMCMD_CmdTriggerFire
 **
 **	Parameters:
 **     none
 **
 **	Return Value:
 **		uint8_t     - the error code
-**          ERRVAL_SUCCESS            0      // success
+**          ERRVAL_SUCCESS              0       // success
+**          ERRVAL_CMD_WRONGPARAMS      0xF9    // the bus trigger is not armed
 **
 **	Description:
-**		This function initiates the DMMMeasureRaw repeated command session of DMMCMD module. 
-**      The function always returns success: ERRVAL_SUCCESS.
+**		This function implements the DMMTriggerFire text command of DMMCMD module.
+**      It calls TRIGGER_Fire to generate the software (bus) trigger.
+**      The function sends over UART the error message if the bus trigger is not armed.
 **      The function is called by DMMCMD_ProcessCmd function.
-**
+**      
 */
-uint8_t DMMCMD_CmdMeasureRaw()
+uint8_t DMMCMD_CmdTriggerFire()
 {
-	fRepGetVal = 0;
-	fRepGetRaw = 1;
-    pSerial->println(F("Measure raw"));
-	DMMCMD_ProcessRepeatedCmd();
-    return ERRVAL_SUCCESS;
+	if(TRIGGER_GetState() != TRIGGER_STATE_ARMED || TRIGGER_GetSource() != TRIGGER_SRC_BUS)
+	{
+		pSerial->println(F("ERROR, Bus trigger not armed"));
+		return ERRVAL_CMD_WRONGPARAMS;
+	}
+	TRIGGER_Fire();
+	return ERRVAL_SUCCESS;
 }
-/***	DMMCMD_CmdMeasureAvg
+
+/***	DMMCMD_ProcessTrigger
 **
 **	Parameters:
 **     none
@@ -591,35 +1759,49 @@ uint8_t DMMCMD_CmdMeasureRaw()
 **          ERRVAL_DMM_IDXCONFIG        0xFC    // error, wrong current scale index
 **
 **	Description:
-**		This function implements the DMMMeasureAVG text command of DMMCMD module.
-**		The function calls the DMM_DGetAvgValue.
-**		In case of success, the returned value is formatted and sent over UART.
+**		This function advances the armed trigger capture by calling TRIGGER_Process.
+**		When the capture is complete, the samples are sent over UART, one per line, 
+**      with their conversion sequence number and their timestamp relative to the trigger (us), then the capture is released.
 **		In case of error, the error specific message is sent over UART.
-**      The function returns the error code, which is the error code raised by the DMM_DGetAvgValue function.
-**      The function is called by DMMCMD_ProcessCmd function.
-**
+**      The function is called by DMMCMD_CheckForCommand function.
 */
-uint8_t DMMCMD_CmdMeasureAvg()
+uint8_t DMMCMD_ProcessTrigger()
 {
 	uint8_t bErrCode = ERRVAL_SUCCESS;
-    dMeasuredVal = DMM_DGetAvgValue(MEASURE_CNT_AVG, &bErrCode);
-    fRepGetVal = 0;
-    fRepGetRaw = 0;
-
-	if(bErrCode == ERRVAL_SUCCESS)
+	uint8_t idx, cbPre;
+	DMMSAMPLE sample;
+	if(TRIGGER_GetState() == TRIGGER_STATE_IDLE)
 	{
-		DMM_FormatValue(dMeasuredVal, bufTxt, 1);
-		pSerial->print(F("Avg. Value: "));
-		pSerial->println(bufTxt);
+		return bErrCode;
 	}
-	else
+	if(TRIGGER_Process(&bErrCode) == TRIGGER_STATE_DONE)
+	{
+		cbPre = TRIGGER_GetPreCount();
+		pSerial->print(F("Trigger: N="));
+		pSerial->print(TRIGGER_GetCount());
+		pSerial->print(F(", Pre="));
+		pSerial->println(cbPre);
+		for(idx = 0; TRIGGER_GetSample(idx, &sample) == ERRVAL_SUCCESS; idx++)
+		{
+			DMM_FormatValue(sample.dVal, bufTxt, 1);
+			pSerial->print(idx < cbPre ? F("Pre ") : F("Post "));
+			pSerial->print(F("Value: "));
+			pSerial->print(bufTxt);
+			pSerial->print(F(", Seq="));
+			pSerial->print(sample.dwSeq);
+			pSerial->print(F(", T="));
+			pSerial->println((long)(sample.dwTime - TRIGGER_GetTriggerTime()));
+		}
+		TRIGGER_Disarm();
+	}
+	if(bErrCode != ERRVAL_SUCCESS)
 	{
 		ERRORS_PrintMessageString(bErrCode, "");
 	}
-
     return bErrCode;
 }
 
+#if DMMCONFIG_CALIB
 /***	DMMCMD_CmdCalibP
 **
 **	Parameters:
@@ -876,6 +2058,9 @@ uint8_t DMMCMD_CmdRestoreFactCalib()
     return bErrCode;
 }
 
+#endif
+
+#if DMMCONFIG_SERIALNO
 /***	DMMCMD_CmdReadSerialNo
 **
 **	Parameters:
@@ -916,6 +2101,9 @@ uint8_t DMMCMD_CmdReadSerialNo()
     return bErrCode;
 }
 
+#endif
+
+#if DMMCONFIG_CALIB
 /***	DMMCMD_CmdExportCalib
 **
 **	Parameters:
@@ -939,7 +2127,7 @@ uint8_t DMMCMD_CmdReadSerialNo()
 uint8_t DMMCMD_CmdExportCalib(char const *arg0)
 {
 	uint8_t bErrCode = ERRVAL_SUCCESS;
-    uint8_t idxScale = atoi(arg0);
+    uint8_t idxScale = arg0 ? atoi(arg0) : 0;
 	bErrCode = CALIB_ExportCalibs_User(bufTxt, idxScale);
 	if(bErrCode == ERRVAL_SUCCESS)
     {
@@ -1020,6 +2208,9 @@ uint8_t DMMCMD_CmdImportCalib(char const *arg0, char const *arg1, char const *ar
     }
     return bErrCode;
 }
+#endif
+#endif
+
 /* *****************************************************************************
  End of File
  */
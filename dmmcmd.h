@@ -17,11 +17,21 @@
 
 #include "HardwareSerial.h"
 
-#define CMD_MAX_LEN	255
+#define CMD_MAX_LEN	64		// the size of the command arguments buffer, the command keyword is not stored
 //#ifdef __cplusplus
 //extern "C" {
 //#endif
 
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+// command tokenizer state: the tokens are views into the command string, no text is copied
+typedef struct _CMDTOK{
+    char *pNext;        // the position where the next token starts, NULL when the command string is consumed
+} CMDTOK;
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: Interface Functions
@@ -31,6 +41,8 @@ uint8_t DMMCMD_Init(HardwareSerial* phwSerial);
 void DMMCMD_CheckForCommand();
 
 void DMMCMD_ProcessIndividualCmd(char *szCmd);
+uint8_t DMMCMD_GetCmdIdx(CMDTOK *pTok);
+char* DMMCMD_CmdGetNextArg(CMDTOK *pTok);
 
 
 
@@ -0,0 +1,74 @@
+/* ************************************************************************** */
+/** Descriptive File Name
+
+  @Company
+    Digilent
+
+  @File Name
+    dmmconfig.h
+
+  @Description
+        This file contains the compile time configuration of the DMMShield library:
+        the optional features, which can be removed from the build.
+        Each setting can be changed here or defined on the compiler command line (-DDMMCONFIG_xxx=0),
+        for all the library source files. A setting defined in the sketch is not seen by the library source files.
+
+ */
+/* ************************************************************************** */
+
+#ifndef _DMMCONFIG_H    /* Guard against multiple inclusion */
+#define _DMMCONFIG_H
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Constants                                                         */
+/* ************************************************************************** */
+// command interpreter (DMMCMD module): DMMShield::CheckForCommand, DMMShield::ProcessIndividualCmd.
+// 0 keeps only DMMCMD_Init, which initializes the library.
+#ifndef DMMCONFIG_CMD
+#define DMMCONFIG_CMD           1
+#endif
+
+// calibration procedures (CALIB_CalibOnXxx) and the calibration save, restore, export and import.
+// 0 keeps the reading of the calibration from EPROM, so the measurements remain calibrated.
+#ifndef DMMCONFIG_CALIB
+#define DMMCONFIG_CALIB         1
+#endif
+
+// serial number reading (SERIALNO module)
+#ifndef DMMCONFIG_SERIALNO
+#define DMMCONFIG_SERIALNO      1
+#endif
+
+// error messages. 0 replaces them with "ERROR 0x<code>", see errors.h for the codes.
+#ifndef DMMCONFIG_ERRSTRINGS
+#define DMMCONFIG_ERRSTRINGS    1
+#endif
+
+// AC scales (RMS conversion). 0 makes DMM_SetScale reject the AC scales with ERRVAL_DMM_IDXCONFIG.
+#ifndef DMMCONFIG_AC
+#define DMMCONFIG_AC            1
+#endif
+
+// counter scales (Frequency, Period, DutyCycle) and DMM_DGetLastFrequency. 0 makes DMM_SetScale reject the counter scales 
+// with ERRVAL_DMM_IDXCONFIG. The counter registers interpretation (see DMM_CNT_REFCLK) is not verified on hardware, 
+// the default stays 0 until it is.
+#ifndef DMMCONFIG_COUNTER
+#define DMMCONFIG_COUNTER       0
+#endif
+
+// size of the DMM trace ring buffer (bytes), 0 removes the trace, see dmmtrace.h
+#ifndef DMMTRACE_SIZE
+#define DMMTRACE_SIZE           0
+#endif
+
+// instrumentation counters, 0 removes them, see perfcnt.h
+#ifndef PERFCNT_ENABLE
+#define PERFCNT_ENABLE          1
+#endif
+
+#endif /* _DMMCONFIG_H */
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,176 @@
+/* ************************************************************************** */
+/** Descriptive File Name
+
+  @Company
+    Digilent
+
+  @File Name
+    dmmconv.h
+
+  @Description
+        This file contains the conversion math that computes the measured value from the convertor registers codes, 
+        the scale multiplication factor and the calibration coefficients.
+        The functions are used by the DMM module on the device and by the host side decoding library (extras/host), 
+        so that raw codes converted on host use the same formulas and coefficients as the values converted on the device.
+        The results are not bit identical: double is a 32 bits float on AVR and a 64 bits double on host, 
+        so the device values carry the float rounding of each operation, a relative difference below 1e-6 
+        (several times smaller than the 24 bits AD1 code resolution), the host values being the more precise ones.
+
+ */
+/* ************************************************************************** */
+
+#ifndef _DMMCONV_H    /* Guard against multiple inclusion */
+#define _DMMCONV_H
+
+#include <stdint.h>
+#include <math.h>
+#include "dmm.h"
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Conversion Functions                                              */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/***	DMMCONV_DConvertAD1
+**
+**	Parameters:
+**      int32_t vad             - The signed 24 bits value, in the AD1 convertor units
+**      double mul              - The multiplication factor of the scale
+**      const CALIB *pCalib     - Pointer to the calibration coefficients of the scale, NULL if calibration is not applied
+**
+**	Return Value:
+**		double 
+**          the converted value, or
+**          +/- INFINITY if the value is outside the expected convertor range.
+**
+**	Description:
+**		This function converts a value in the AD1 convertor units (AD1, LPF or peak hold registers), 
+**      applying the multiplication factor and then the calibration coefficients.
+**            
+*/
+static inline double DMMCONV_DConvertAD1(int32_t vad, double mul, const CALIB *pCalib)
+{
+    double v;
+    if(vad >= 0x7FFFFE)
+    {
+        v = INFINITY;   // value outside convertor range
+    }
+    else
+    {
+        if(vad <= -0x7FFFFE)
+        {
+           v = -INFINITY;   // value outside convertor range
+        }
+       else
+       {
+           v = mul*vad;
+
+            if(pCalib)
+            {
+               // apply calibration coefficients
+               v = v*(1.0+pCalib->Mult) + pCalib->Add;
+            }
+        }   
+    }
+    return v;
+}
+
+/***	DMMCONV_DConvertRMS
+**
+**	Parameters:
+**      const uint8_t *pbRms    - Pointer to the 5 bytes of the RMS register, LS byte first
+**      double mul              - The multiplication factor of the scale
+**      const CALIB *pCalib     - Pointer to the calibration coefficients of the scale, NULL if calibration is not applied
+**
+**	Return Value:
+**		double 
+**          the converted RMS value
+**
+**	Description:
+**		This function converts the 40 bits RMS accumulator, applying the multiplication factor and then the calibration coefficients.
+**      When the MS byte is not 0, the LS byte is ignored (noise). 
+**      On 32 bits boards (Arduino Due) the whole accumulator is used. The host side decoding follows the 8 bits boards behavior.
+**            
+*/
+static inline double DMMCONV_DConvertRMS(const uint8_t *pbRms, double mul, const CALIB *pCalib)
+{
+    int i;
+    double v;
+	uint8_t rms32;
+#if defined (__arm__) && defined (__SAM3X8E__) // Arduino Due compatible
+	// for 32 bits architecture, do not use 4 bytes RMS.
+	rms32 = 0;
+#else
+	// if MS Byte is 0, use only 4 bytes RMS
+	rms32 = (pbRms[4] != 0) ? 1:0;
+#endif
+
+    int64_t vrms = 0;
+    for(i = 0; i < 5; i++)
+	{
+		vrms <<= 8;
+        vrms |= pbRms[4-i];
+    }
+	if(rms32)
+	{
+		vrms >>= 8;         
+	}
+
+    if(pCalib)
+    { 
+        // apply calibration coefficients
+        if(rms32)
+        {
+            // ignore noise on LSB byte
+            v = sqrt(fabs((double)256*((pow(mul,2)*(double)(vrms))) - pow(pCalib->Add,2)))*(1.0+pCalib->Mult);
+        }
+        else
+        {
+            // Arduino Due compatible or zero MS byte
+            v = sqrt(fabs(pow(mul,2)*(double)(vrms) - pow(pCalib->Add,2)))*(1.0+pCalib->Mult);         
+        }
+    }
+    else
+    {
+        if(rms32)
+        {
+            // ignore noise on LSB byte
+            v = (double)16*(mul*sqrt((double)vrms));             
+        }
+        else
+        {
+            // Arduino Due compatible or zero MS byte
+            v = mul*sqrt((double)vrms);             
+        }
+    }
+    return v;
+}
+
+/***	DMMCONV_DCompensateVoltage50DCLinear
+**
+**	Parameters:
+**      double dVal - The value to be compensated
+**
+**	Return Value:
+**		double 
+**          the compensated value
+**
+**	Description:
+**		This function compensates the not linear behavior of VoltageDC50 scale, see DMM_CompensateVoltage50DCLinear.
+**            
+*/
+static inline double DMMCONV_DCompensateVoltage50DCLinear(double dVal)
+{
+    if(isnan(dVal) || isinf(dVal))
+    {
+        return dVal;
+    }
+    return dVal * dVal * dVal * DMM_Voltage50DCLinearCoeff_P3 + dVal * DMM_Voltage50DCLinearCoeff_P1 + dVal * DMM_Voltage50DCLinearCoeff_P0;
+}
+
+#endif /* _DMMCONV_H */
+
+/* *****************************************************************************
+ End of File
+ */
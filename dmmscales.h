@@ -0,0 +1,166 @@
+/* ************************************************************************** */
+/** Descriptive File Name
+
+  @Company
+    Digilent
+
+  @File Name
+    dmmscales.h
+
+  @Description
+        This file contains the scales list (DMM_SCALES), the single definition of the scales, 
+        with the name, mode, range, switches, multiplication factors and configuration registers of each scale.
+        The scale tables are generated from the list at compile time: the configuration table (dmmcfg), 
+        the scale descriptors (dmmscaleinfo: class, family, unit and unit prefix), the AD2 multiplication factors (dmmad2mul)
+        and, in dmmcmd.c, the scale names.
+        It is included by dmm.c, which is the only module of the library using the tables, by dmmcmd.c for the scale names, 
+        and by the host side tools in extras/host, so that they use the same scale data as the device.
+        On host, PROGMEM must be defined as empty before including the file.
+
+ */
+/* ************************************************************************** */
+
+#ifndef _DMMSCALES_H    /* Guard against multiple inclusion */
+#define _DMMSCALES_H
+
+#include "dmm.h"
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Scales list                                                       */
+/* ************************************************************************** */
+// DMM_SCALES(SCALE) calls SCALE for each scale, in the order of the scale indexes, with the parameters:
+//      name    - the scale name, used by the DMMSetScale command
+//      mode    - the scale type (DmmResistance, DmmDCVoltage, etc.)
+//      range   - the scale range, in the base unit
+//      sw      - switch bits: 0 RLD, 1 RLU, 2 RLI
+//      mul     - AD1 / RMS multiplication factor, to get the value in the base unit
+//      ad2mul  - AD2 multiplication factor, 0 if AD2 is not used. On AC scales AD2 measures the DC component of the input, 
+//                using the factor of the DC scale with the same range.
+//      ...     - the 24 configuration registers, 0x1F - 0x36
+// A scale is added or changed only here, DMM_CNTSCALES must be updated when scales are added.
+#define DMM_SCALES(SCALE) \
+/*    name,           mode,            range, sw, mul,               ad2mul,             INTE,  R20,  R21,  R22,  R23,  R24,  R25,  R26,  R27,  R28,  R29,  R2A,  R2B,  R2C,  R2D,  R2E,  R2F,  R30,  R31,  R32,  R33,  R34,  R35,  R36 */ \
+SCALE(Resistance50M,  DmmResistance,   5e7,  1, 6e7 /0.9/8388608,   0,                  0x00, 0xC0, 0xCF, 0x17, 0x93, 0x85, 0x00, 0x00, 0x55, 0x55, 0x00, 0x00, 0x08, 0x00, 0x00, 0x80, 0x86, 0x80, 0xD1, 0x3C, 0xA0, 0x00, 0x00, 0x00) \
+SCALE(Resistance5M,   DmmResistance,   5e6,  1, 6e6 /0.9/8388608,   0,                  0x00, 0xC0, 0xCF, 0x17, 0x93, 0x85, 0x00, 0x00, 0x55, 0x55, 0x00, 0x00, 0x08, 0x00, 0x80, 0x80, 0x86, 0x80, 0xD1, 0x3C, 0xA0, 0x00, 0x00, 0x00) \
+SCALE(Resistance500k, DmmResistance,   5e5,  1, 6e5 /0.9/8388608,   0,                  0x00, 0xC0, 0xCF, 0x17, 0x93, 0x85, 0x00, 0x00, 0x55, 0x55, 0x00, 0x00, 0x08, 0x00, 0x08, 0x80, 0x86, 0x80, 0xD1, 0x33, 0x20, 0x00, 0x00, 0x00) \
+SCALE(Resistance50k,  DmmResistance,   5e4,  1, 1e5 /0.9/8388608,   0,                  0x00, 0xC0, 0xCF, 0x17, 0x83, 0x85, 0x00, 0x00, 0x55, 0x00, 0x00, 0x00, 0x40, 0x00, 0x06, 0x44, 0x94, 0x80, 0xD3, 0x33, 0x20, 0x00, 0x00, 0x00) \
+SCALE(Resistance5k,   DmmResistance,   5e3,  1, 1e4 /0.9/8388608,   0,                  0x00, 0xC0, 0xCF, 0x17, 0x83, 0x85, 0x00, 0x00, 0x55, 0x00, 0x00, 0x00, 0x40, 0x60, 0x00, 0x44, 0x94, 0x80, 0xD3, 0x33, 0x20, 0x00, 0x00, 0x00) \
+SCALE(Resistance500,  DmmResistance,   5e2,  1, 1e3 /0.9/8388608,   0,                  0x00, 0xC0, 0xCF, 0x17, 0x83, 0x35, 0x00, 0x00, 0x55, 0x00, 0x00, 0x00, 0x40, 0x06, 0x00, 0x44, 0x94, 0x80, 0xD2, 0x3C, 0xA0, 0x00, 0x00, 0x00) \
+SCALE(Resistance50,   DmmResistance,   5e1,  1, 1e2 /0.9/8388608,   0,                  0x00, 0xC0, 0xCF, 0x17, 0x83, 0x35, 0x01, 0x00, 0x55, 0x00, 0x00, 0x00, 0x40, 0x06, 0x00, 0x44, 0x94, 0x80, 0xD2, 0x3C, 0xA0, 0x00, 0x00, 0x00) \
+SCALE(VoltageDC50,    DmmDCVoltage,    5e1,  2, 125e0 /1.8/8388608, 0,                  0x00, 0x60, 0x00, 0x17, 0x8B, 0x01, 0x11, 0x00, 0x55, 0x31, 0x00, 0x22, 0x00, 0x00, 0x09, 0x28, 0xA0, 0x80, 0xC7, 0x33, 0x20, 0x00, 0x00, 0x00) \
+SCALE(VoltageDC5,     DmmDCVoltage,    5e0,  2, 125e-1/1.8/8388608, 0,                  0x00, 0x60, 0x00, 0x17, 0x8B, 0x01, 0x11, 0x00, 0x55, 0x31, 0x00, 0x22, 0x00, 0x00, 0x90, 0x28, 0xA0, 0x80, 0xC7, 0x33, 0x20, 0x00, 0x00, 0x00) \
+SCALE(VoltageDC500m,  DmmDCVoltage,    5e-1, 1, 125e-2/1.8/8388608, 0,                  0x00, 0xC0, 0x00, 0x17, 0x8B, 0x85, 0x11, 0x00, 0x55, 0x31, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x90, 0x80, 0xC7, 0x33, 0x28, 0x00, 0x00, 0x00) \
+SCALE(VoltageDC50m,   DmmDCVoltage,    5e-2, 1, 125e-3/1.8/8388608, 0,                  0x00, 0x00, 0x00, 0x17, 0x8B, 0x35, 0x11, 0x00, 0x55, 0x31, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x90, 0x80, 0xC7, 0x3C, 0x60, 0x00, 0x00, 0x00) \
+SCALE(VoltageAC50,    DmmACVoltage,    5e1,  2, 1e-3,               125e0/1.8/8388608,  0x00, 0xF2, 0xDD, 0x07, 0x03, 0x52, 0x10, 0x80, 0x25, 0x31, 0xF8, 0x22, 0x00, 0x00, 0x0D, 0x28, 0xA0, 0xFF, 0xC7, 0x38, 0x20, 0x00, 0x00, 0x00) \
+SCALE(VoltageAC5,     DmmACVoltage,    5e0,  2, 1e-4,               125e-1/1.8/8388608, 0x00, 0xF2, 0xDD, 0x07, 0x03, 0x52, 0x10, 0x80, 0x25, 0x31, 0xF8, 0x22, 0x00, 0x00, 0xD0, 0x88, 0xA0, 0xFF, 0xC7, 0x38, 0x20, 0x02, 0x50, 0x0C) \
+SCALE(VoltageAC500m,  DmmACVoltage,    5e-1, 1, 1e-5,               125e-2/1.8/8388608, 0x00, 0x92, 0xDD, 0x07, 0x03, 0x52, 0x10, 0x80, 0x25, 0x11, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x90, 0x80, 0xC7, 0x3A, 0x28, 0x00, 0x00, 0x00) \
+SCALE(VoltageAC50m,   DmmACVoltage,    5e-2, 1, 1e-6,               125e-3/1.8/8388608, 0x00, 0x52, 0xDD, 0x07, 0x03, 0x00, 0x13, 0x80, 0x25, 0x11, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x90, 0x80, 0xC7, 0x3A, 0x28, 0x00, 0x00, 0x00) \
+SCALE(CurrentDC5,     DmmDCCurrent,    5e0,  0, 125e0/3.6/8388608,  0,                  0x00, 0x00, 0x00, 0x17, 0x8B, 0x95, 0x11, 0x00, 0x55, 0x31, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0xC7, 0x33, 0x20, 0x00, 0x00, 0x00) \
+SCALE(CurrentAC5,     DmmACCurrent,    5e0,  0, 1e-4/2.16,          125e0/3.6/8388608,  0x00, 0x52, 0xDD, 0x07, 0x03, 0x00, 0x13, 0x80, 0x25, 0x11, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x90, 0x80, 0xC7, 0x3D, 0x28, 0x00, 0x00, 0x00) \
+SCALE(Continuity,     DmmContinuity,   500,  1, 666e-7,             0,                  0x00, 0x74, 0xCF, 0x17, 0x83, 0x35, 0x10, 0x00, 0x55, 0x00, 0x00, 0x00, 0x00, 0x0A, 0x00, 0x40, 0x86, 0x80, 0xD2, 0x3C, 0xA0, 0x00, 0x00, 0x00) \
+SCALE(Diode,          DmmDiode,        3.0,  1, 666e-6,             0,                  0x00, 0xC0, 0xCF, 0x17, 0x8B, 0x8D, 0x10, 0x00, 0x55, 0x31, 0x00, 0x00, 0x00, 0x08, 0x00, 0x40, 0x86, 0x80, 0xE2, 0x33, 0xA0, 0x00, 0x00, 0x00) \
+SCALE(CurrentDC500m,  DmmDCLowCurrent, 5e-1, 0, 125e-2/1.8/8388608, 0,                  0x00, 0x00, 0x00, 0x17, 0x8B, 0x95, 0x11, 0x00, 0x55, 0x31, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0xC7, 0x33, 0x20, 0x00, 0x00, 0x00) \
+SCALE(CurrentDC50m,   DmmDCLowCurrent, 5e-2, 0, 125e-3/1.8/8388608, 0,                  0x00, 0x00, 0x00, 0x17, 0x8B, 0x35, 0x11, 0x00, 0x55, 0x31, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0xC7, 0x3D, 0xA0, 0x00, 0x00, 0x00) \
+SCALE(CurrentDC5m,    DmmDCLowCurrent, 5e-3, 4, 125e-4/1.8/8388608, 0,                  0x00, 0x00, 0x00, 0x17, 0x8B, 0x95, 0x11, 0x00, 0x55, 0x31, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0xC7, 0x33, 0x20, 0x00, 0x00, 0x00) \
+SCALE(CurrentDC500u,  DmmDCLowCurrent, 5e-4, 4, 125e-5/1.8/8388608, 0,                  0x00, 0x00, 0x00, 0x17, 0x8B, 0x35, 0x11, 0x00, 0x55, 0x31, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0xC7, 0x3D, 0xA0, 0x00, 0x00, 0x00) \
+SCALE(CurrentAC500m,  DmmACLowCurrent, 5e-1, 0, 1e-5/1.08,          125e-2/1.8/8388608, 0x00, 0x92, 0xDD, 0x07, 0x03, 0x52, 0x10, 0x80, 0x25, 0x11, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x90, 0x80, 0xC7, 0x3D, 0x28, 0x00, 0x00, 0x00) \
+SCALE(CurrentAC50m,   DmmACLowCurrent, 5e-2, 0, 1e-6/1.08,          125e-3/1.8/8388608, 0x00, 0x52, 0xDD, 0x07, 0x03, 0x00, 0x13, 0x80, 0x25, 0x11, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x90, 0x80, 0xC7, 0x3D, 0x28, 0x00, 0x00, 0x00) \
+SCALE(CurrentAC5m,    DmmACLowCurrent, 5e-3, 4, 1e-7/1.08,          125e-4/1.8/8388608, 0x00, 0x92, 0xDD, 0x07, 0x03, 0x52, 0x10, 0x80, 0x25, 0x11, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x90, 0x80, 0xC7, 0x3D, 0x28, 0x00, 0x00, 0x00) \
+SCALE(CurrentAC500u,  DmmACLowCurrent, 5e-4, 4, 1e-8/1.08,          125e-5/1.8/8388608, 0x00, 0x52, 0xDD, 0x07, 0x03, 0x00, 0x13, 0x80, 0x25, 0x11, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x90, 0x80, 0xC7, 0x3D, 0x28, 0x00, 0x00, 0x00) \
+/* counter scales, using the "5 V AC" input configuration. The value is computed from the counter registers, mul is not used. */ \
+SCALE(Frequency,      DmmFrequency,    5e2,  2, 1,                  0,                  0x00, 0xF2, 0xDD, 0x07, 0x03, 0x52, 0x10, 0x80, 0x25, 0x31, 0xF8, 0x22, 0x00, 0x00, 0xD0, 0x88, 0xA0, 0xFF, 0xC7, 0x38, 0x20, 0x02, 0x50, 0x0C) \
+SCALE(Period,         DmmPeriod,       5e-1, 2, 1,                  0,                  0x00, 0xF2, 0xDD, 0x07, 0x03, 0x52, 0x10, 0x80, 0x25, 0x31, 0xF8, 0x22, 0x00, 0x00, 0xD0, 0x88, 0xA0, 0xFF, 0xC7, 0x38, 0x20, 0x02, 0x50, 0x0C) \
+SCALE(DutyCycle,      DmmDutyCycle,    1e2,  2, 1,                  0,                  0x00, 0xF2, 0xDD, 0x07, 0x03, 0x52, 0x10, 0x80, 0x25, 0x31, 0xF8, 0x22, 0x00, 0x00, 0xD0, 0x88, 0xA0, 0xFF, 0xC7, 0x38, 0x20, 0x02, 0x50, 0x0C)
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Scale descriptors, computed at compile time                       */
+/* ************************************************************************** */
+// the class bits of a scale type (DMM_CLASS_xxx)
+constexpr uint8_t DMMSCALES_Class(int mode)
+{
+    return (mode == DmmDCVoltage) ? DMM_CLASS_DC:
+        (mode == DmmDCCurrent || mode == DmmDCLowCurrent) ? (DMM_CLASS_DC | DMM_CLASS_CURRENT):
+        (mode == DmmACVoltage) ? DMM_CLASS_AC:
+        (mode == DmmACCurrent || mode == DmmACLowCurrent) ? (DMM_CLASS_AC | DMM_CLASS_CURRENT):
+        (mode == DmmResistance) ? DMM_CLASS_RES:
+        (mode == DmmContinuity) ? (DMM_CLASS_RES | DMM_CLASS_CONT):
+        (mode == DmmDiode) ? DMM_CLASS_DIODE:
+        DMM_CLASS_COUNTER;
+}
+
+// the family of a scale type (DMM_FAMILY_xxx), the counter scales use the AC input configuration
+constexpr uint8_t DMMSCALES_Family(int mode)
+{
+    return (DMMSCALES_Class(mode) & (DMM_CLASS_AC | DMM_CLASS_COUNTER)) ? DMM_FAMILY_AC:
+        (DMMSCALES_Class(mode) & (DMM_CLASS_RES | DMM_CLASS_DIODE)) ? DMM_FAMILY_RES:
+        DMM_FAMILY_DC;
+}
+
+// the base unit of a scale type (DMM_UNIT_xxx, index in dmmunits)
+constexpr uint8_t DMMSCALES_Unit(int mode)
+{
+    return (mode == DmmDCVoltage || mode == DmmACVoltage || mode == DmmDiode) ? DMM_UNIT_V:
+        (DMMSCALES_Class(mode) & DMM_CLASS_CURRENT) ? DMM_UNIT_A:
+        (mode == DmmResistance || mode == DmmContinuity) ? DMM_UNIT_OHM:
+        (mode == DmmFrequency) ? DMM_UNIT_HZ:
+        (mode == DmmPeriod) ? DMM_UNIT_S:
+        (mode == DmmDutyCycle) ? DMM_UNIT_PERCENT:
+        DMM_UNIT_NONE;
+}
+
+// the unit prefix of a scale range (index in dmmprefix): a prefix is used up to 1000 prefixed units
+constexpr uint8_t DMMSCALES_Prefix(double range)
+{
+    return (range < 1e-3) ? 0: (range < 1) ? 1: (range < 1e3) ? 2: (range < 1e6) ? 3: 4;
+}
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Scale tables                                                      */
+/* ************************************************************************** */
+#define DMMSCALES_IDX(name, ...)                                    DMM_IDX_##name,
+#define DMMSCALES_CFG(name, mode, range, sw, mul, ad2mul, ...)      {mode, range, sw, {__VA_ARGS__}, mul},
+#define DMMSCALES_INFO(name, mode, range, ...)                      {DMMSCALES_Class(mode), DMMSCALES_Family(mode), DMMSCALES_Unit(mode), DMMSCALES_Prefix(range)},
+#define DMMSCALES_AD2MUL(name, mode, range, sw, mul, ad2mul, ...)   ad2mul,
+
+// scale indexes, DMM_IDX_<name>
+enum { DMM_SCALES(DMMSCALES_IDX) DMM_IDX_CNT };
+static_assert(DMM_IDX_CNT == DMM_CNTSCALES, "DMM_CNTSCALES must be the number of scales in DMM_SCALES");
+static_assert(DMM_IDX_VoltageDC50 == DMMVoltageDC50Scale, "DMMVoltageDC50Scale must be the VoltageDC50 scale index");
+
+// configuration, contains scale specific data
+const static PROGMEM DMMCFG dmmcfg[] = {
+DMM_SCALES(DMMSCALES_CFG)
+{0}};
+
+// scale descriptors, see DMM_GetScaleClass
+const static PROGMEM DMMSCALEINFO dmmscaleinfo[DMM_CNTSCALES] = {
+DMM_SCALES(DMMSCALES_INFO)
+};
+
+// AD2 convertor multiplication factor for each scale, to get the value in corresponding unit, 0 if AD2 is not used.
+const static PROGMEM float dmmad2mul[DMM_CNTSCALES] = {
+DMM_SCALES(DMMSCALES_AD2MUL)
+};
+
+// unit prefixes, in the order of the scale ranges: below 1e-3, below 1, below 1e3, below 1e6, above (see DMMSCALES_Prefix)
+const static PROGMEM DMMPREFIX dmmprefix[] = {{'u', 1e6}, {'m', 1e3}, {0, 1}, {'k', 1e-3}, {'M', 1e-6}};
+
+// base units, in the order of DMM_UNIT_xxx definitions. The strings and the table are placed in flash, 
+// the strings are accessed with the _P functions (strcpy_P, strcmp_P, etc).
+const static char dmmunit_0[] PROGMEM = "";
+const static char dmmunit_1[] PROGMEM = "V";
+const static char dmmunit_2[] PROGMEM = "A";
+const static char dmmunit_3[] PROGMEM = "Ohm";
+const static char dmmunit_4[] PROGMEM = "Hz";
+const static char dmmunit_5[] PROGMEM = "s";
+const static char dmmunit_6[] PROGMEM = "%";
+const static char * const dmmunits[] PROGMEM = {dmmunit_0, dmmunit_1, dmmunit_2, dmmunit_3, dmmunit_4, dmmunit_5, dmmunit_6};
+
+#endif /* _DMMSCALES_H */
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,277 @@
+/* ************************************************************************** */
+/** Descriptive File Name
+
+  @Company
+    Digilent
+
+  @File Name
+    dmmtrace.c
+
+  @Description
+        The DMMTRACE module records the DMM SPI transactions (command byte, data bytes, timestamp)
+        in a ring buffer of DMMTRACE_SIZE bytes, placed in RAM. When the buffer is full, the oldest
+        transactions are discarded. The trace is dumped over serial with the DMMTrace command and
+        can be replayed on host (extras/host/dmmreplay), to reproduce the values computed from the recorded registers.
+        The recording is called by DMM_SendCmdSPI and DMM_GetCmdSPI through the DMMTRACE_RECORD macro,
+        which is empty when DMMTRACE_SIZE is 0: then the module takes no RAM and no time.
+        Each record holds the number of data bytes, the command byte, the timestamp (LS byte first) and the data bytes.
+
+ */
+/* ************************************************************************** */
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+#include <Arduino.h>
+#include "dmmtrace.h"
+#include "errors.h"
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Local Functions Prototypes                                        */
+/* ************************************************************************** */
+/* ************************************************************************** */
+#if DMMTRACE_SIZE
+void DMMTRACE_PutByte(uint8_t b);
+uint8_t DMMTRACE_GetByte(uint16_t idx);
+#endif
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Global Variables                                                  */
+/* ************************************************************************** */
+/* ************************************************************************** */
+#if DMMTRACE_SIZE
+static uint8_t rgbTrace[DMMTRACE_SIZE];
+static uint16_t idxTraceHead = 0;      // the position where the next record is written
+static uint16_t idxTraceTail = 0;      // the position of the oldest record
+static uint16_t cbTraceUsed = 0;
+static uint16_t cntTraceRec = 0;
+static uint8_t fTraceEnabled = 0;
+#endif
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/***	DMMTRACE_Enable
+**
+**	Parameters:
+**      uint8_t fEnable     - 1 to start recording the DMM transactions, 0 to stop
+**
+**	Return Value:
+**		uint8_t     - the error code
+**          ERRVAL_SUCCESS              0       // success
+**          ERRVAL_DMM_TRACEDISABLED    0xEE    // the trace is not included in the build (DMMTRACE_SIZE is 0)
+**
+**	Description:
+**		This function starts or stops the recording. The recorded transactions are kept,
+**      a new recording is appended to them (see DMMTRACE_Clear).
+**
+*/
+uint8_t DMMTRACE_Enable(uint8_t fEnable)
+{
+#if DMMTRACE_SIZE
+    fTraceEnabled = fEnable ? 1: 0;
+    return ERRVAL_SUCCESS;
+#else
+    return fEnable ? ERRVAL_DMM_TRACEDISABLED: ERRVAL_SUCCESS;
+#endif
+}
+
+/***	DMMTRACE_FEnabled
+**
+**	Parameters:
+**      none
+**
+**	Return Value:
+**		uint8_t     - 1 if the transactions are recorded, 0 otherwise
+**
+*/
+uint8_t DMMTRACE_FEnabled()
+{
+#if DMMTRACE_SIZE
+    return fTraceEnabled;
+#else
+    return 0;
+#endif
+}
+
+/***	DMMTRACE_Clear
+**
+**	Parameters:
+**      none
+**
+**	Return Value:
+**		none
+**
+**	Description:
+**		This function discards all the recorded transactions.
+**
+*/
+void DMMTRACE_Clear()
+{
+#if DMMTRACE_SIZE
+    idxTraceHead = 0;
+    idxTraceTail = 0;
+    cbTraceUsed = 0;
+    cntTraceRec = 0;
+#endif
+}
+
+/***	DMMTRACE_GetCount
+**
+**	Parameters:
+**      none
+**
+**	Return Value:
+**		uint16_t    - the number of recorded transactions
+**
+*/
+uint16_t DMMTRACE_GetCount()
+{
+#if DMMTRACE_SIZE
+    return cntTraceRec;
+#else
+    return 0;
+#endif
+}
+
+/***	DMMTRACE_GetRecord
+**
+**	Parameters:
+**      uint16_t idx            - the index of the transaction, 0 for the oldest
+**      DMMTRACEREC *pRec       - Pointer to the structure receiving the transaction
+**
+**	Return Value:
+**		uint8_t     - the error code
+**          ERRVAL_SUCCESS              0       // success
+**          ERRVAL_CMD_WRONGPARAMS      0xF9    // no transaction has this index
+**
+**	Description:
+**		This function retrieves a recorded transaction. The records are walked from the oldest one,
+**      so the function takes a time proportional to idx.
+**
+*/
+uint8_t DMMTRACE_GetRecord(uint16_t idx, DMMTRACEREC *pRec)
+{
+#if DMMTRACE_SIZE
+    uint16_t pos = idxTraceTail;
+    uint8_t i;
+    if(idx >= cntTraceRec)
+    {
+        return ERRVAL_CMD_WRONGPARAMS;
+    }
+    while(idx--)
+    {
+        pos = (pos + DMMTRACE_HDRSIZE + DMMTRACE_GetByte(pos)) % DMMTRACE_SIZE;
+    }
+    pRec->cb = DMMTRACE_GetByte(pos);
+    pRec->bCmd = DMMTRACE_GetByte(pos + 1);
+    pRec->dwTime = 0;
+    for(i = 0; i < 4; i++)
+    {
+        pRec->dwTime |= (uint32_t)DMMTRACE_GetByte(pos + 2 + i) << (8 * i);
+    }
+    for(i = 0; i < pRec->cb; i++)
+    {
+        pRec->rgb[i] = DMMTRACE_GetByte(pos + DMMTRACE_HDRSIZE + i);
+    }
+    return ERRVAL_SUCCESS;
+#else
+    return ERRVAL_CMD_WRONGPARAMS;
+#endif
+}
+
+#if DMMTRACE_SIZE
+/***	DMMTRACE_Record
+**
+**	Parameters:
+**      uint8_t bCmd            - the command byte of the transaction
+**      const uint8_t *pbData   - the data bytes written or read
+**      int cbData              - the number of data bytes, only the first DMMTRACE_MAXDATA are recorded
+**
+**	Return Value:
+**		none
+**
+**	Description:
+**		This function appends a transaction to the trace, when the recording is enabled,
+**      discarding the oldest transactions if there is not enough room.
+**      It is called by DMM_SendCmdSPI and DMM_GetCmdSPI, through the DMMTRACE_RECORD macro.
+**
+*/
+void DMMTRACE_Record(uint8_t bCmd, const uint8_t *pbData, int cbData)
+{
+    uint32_t dwTime;
+    uint8_t i;
+    if(!fTraceEnabled)
+    {
+        return;
+    }
+    dwTime = micros();
+    if(cbData > DMMTRACE_MAXDATA)
+    {
+        cbData = DMMTRACE_MAXDATA;
+    }
+    while(DMMTRACE_SIZE - cbTraceUsed < DMMTRACE_HDRSIZE + cbData)
+    {
+        // discard the oldest record
+        uint8_t cbOld = DMMTRACE_GetByte(idxTraceTail);
+        idxTraceTail = (idxTraceTail + DMMTRACE_HDRSIZE + cbOld) % DMMTRACE_SIZE;
+        cbTraceUsed -= DMMTRACE_HDRSIZE + cbOld;
+        cntTraceRec--;
+    }
+    DMMTRACE_PutByte((uint8_t)cbData);
+    DMMTRACE_PutByte(bCmd);
+    for(i = 0; i < 4; i++)
+    {
+        DMMTRACE_PutByte((uint8_t)(dwTime >> (8 * i)));
+    }
+    for(i = 0; i < cbData; i++)
+    {
+        DMMTRACE_PutByte(pbData[i]);
+    }
+    cbTraceUsed += DMMTRACE_HDRSIZE + cbData;
+    cntTraceRec++;
+}
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Local Functions                                                   */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/***	DMMTRACE_PutByte
+**
+**	Description:
+**		This function writes one byte at the head of the ring buffer.
+**
+*/
+void DMMTRACE_PutByte(uint8_t b)
+{
+    rgbTrace[idxTraceHead] = b;
+    if(++idxTraceHead >= DMMTRACE_SIZE)
+    {
+        idxTraceHead = 0;
+    }
+}
+
+/***	DMMTRACE_GetByte
+**
+**	Description:
+**		This function reads the byte at the specified position of the ring buffer, wrapping around its end.
+**
+*/
+uint8_t DMMTRACE_GetByte(uint16_t idx)
+{
+    return rgbTrace[idx % DMMTRACE_SIZE];
+}
+#endif
+
+/* *****************************************************************************
+ End of File
+ */
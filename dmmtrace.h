@@ -0,0 +1,72 @@
+/* ************************************************************************** */
+/** Descriptive File Name
+
+  @Company
+    Digilent
+
+  @File Name
+    dmmtrace.h
+
+  @Description
+        This file contains the declarations for the DMMTRACE module functions.
+        The DMMTRACE functions are defined in dmmtrace.c source file.
+
+ */
+/* ************************************************************************** */
+
+#ifndef _DMMTRACE_H    /* Guard against multiple inclusion */
+#define _DMMTRACE_H
+
+#include "stdint.h"
+#include "dmmconfig.h"
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Constants                                                         */
+/* ************************************************************************** */
+// DMMTRACE_SIZE (dmmconfig.h) is the size of the trace ring buffer (bytes). 0 removes the trace from the build,
+// otherwise each DMM SPI transaction takes DMMTRACE_HDRSIZE bytes plus its data bytes.
+
+#define DMMTRACE_HDRSIZE        6       // data length, command byte and 4 bytes timestamp
+#define DMMTRACE_MAXDATA        32      // recorded data bytes of a transaction (the status block 0x00 - 0x1F)
+
+#if DMMTRACE_SIZE && (DMMTRACE_SIZE < DMMTRACE_HDRSIZE + DMMTRACE_MAXDATA || DMMTRACE_SIZE > 0x7FFF)
+#error "DMMTRACE_SIZE must hold at least one transaction and be smaller than 32K"
+#endif
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+// one DMM SPI transaction
+typedef struct _DMMTRACEREC{
+    uint32_t dwTime;                // micros() timestamp taken when the transaction was complete
+    uint8_t bCmd;                   // the command byte: 7 bits address, LSB 1 for read
+    uint8_t cb;                     // the number of data bytes
+    uint8_t rgb[DMMTRACE_MAXDATA];  // the data bytes written or read
+} DMMTRACEREC;
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+uint8_t DMMTRACE_Enable(uint8_t fEnable);
+uint8_t DMMTRACE_FEnabled();
+void DMMTRACE_Clear();
+uint16_t DMMTRACE_GetCount();
+uint8_t DMMTRACE_GetRecord(uint16_t idx, DMMTRACEREC *pRec);
+
+#if DMMTRACE_SIZE
+void DMMTRACE_Record(uint8_t bCmd, const uint8_t *pbData, int cbData);
+#define DMMTRACE_RECORD(bCmd, pbData, cbData)   DMMTRACE_Record(bCmd, pbData, cbData)
+#else
+#define DMMTRACE_RECORD(bCmd, pbData, cbData)
+#endif
+
+#endif /* _DMMTRACE_H */
+
+/* *****************************************************************************
+ End of File
+ */
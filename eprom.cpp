@@ -42,6 +42,8 @@
 #include "eprom.h"
 #include "errors.h"
 #include "utils.h"
+#include "perfcnt.h"
+#include "idle.h"
 
 /* ************************************************************************** */
 /* ************************************************************************** */
@@ -282,6 +284,7 @@ void EPROM_StartBitOpAddr_Raw(uint8_t bOp, uint8_t bAddress)
 **	Description:
 **		This function waits until EPROM answers with data ready state.  
 **      It is usually called to complete an EPROM write functionality. 
+**      Between two checks of the ready state, the MCU sleeps (see IDLE_Sleep). 
 **      This is a private function, the user shouldn't call it. 
 **      The function returns ERRVAL_SUCCESS for success or ERRVAL_EPROM_WRTIMEOUT when eprom is 
 **      not answering with write successful message.
@@ -290,18 +293,28 @@ void EPROM_StartBitOpAddr_Raw(uint8_t bOp, uint8_t bAddress)
 uint8_t EPROM_WaitUntilReady_Raw()
 {
     uint8_t bResult = ERRVAL_SUCCESS;
-    // wait for data ready timeout counter 
-    unsigned long cntTimeout = 0;
+    // wait for data ready timeout start
+    uint32_t dwTimeoutStart = micros();
+    PERFCNT_TIME_START(dwStart);
     //    DelayAprox10Us(SPI_CLK_DELAY);    
     GPIO_SetValue_CS_EPROM(1); // Activate CS_EPROM
     //    DelayAprox10Us(SPI_CLK_DELAY);
-    // check the wait for data ready timeout counter against threshold
-    while((!GPIO_Get_MISO()) && (cntTimeout++ < EPROM_CNTTIMEOUT)); // wait for ready
+    // check the wait for data ready timeout against threshold
+    while(!GPIO_Get_MISO()) // wait for ready
+    {
+        if((micros() - dwTimeoutStart) >= EPROM_WRTIMEOUT_US)
+        {
+            break;
+        }
+        IDLE_Sleep();
+    }
 
-    if(cntTimeout >= EPROM_CNTTIMEOUT)
+    if(!GPIO_Get_MISO())
     {
         bResult = ERRVAL_EPROM_WRTIMEOUT;
+        PERFCNT_EVENT(PERFCNT_EV_EPROMTIMEOUT);
     }
+    PERFCNT_TIME_STOP(PERFCNT_SMP_EPROMWAIT, dwStart);
 
     //    DelayAprox10Us(SPI_CLK_DELAY);
     
@@ -27,8 +27,8 @@
 /* Section: Constants                                                         */
 /* ************************************************************************** */
 
-// wait for dataready timeout counter threshold
-#define EPROM_CNTTIMEOUT 0x00010000
+// wait for dataready timeout (us), well above the 10 ms maximum write cycle
+#define EPROM_WRTIMEOUT_US 100000
 
 
 // OpCodes
@@ -32,6 +32,7 @@
 #include "HardwareSerial.h"
 
 #include "stdint.h"
+#include "dmmconfig.h"
 #include "errors.h"
 
 
@@ -89,10 +90,22 @@ void ERRORS_Init(HardwareSerial *phwSerial)
 **      If the error code is among the defined ones, a specific error string is copied in the pSzErr
 **      and ERRVAL_SUCCESS is returned.
 **      If the error is not among the defined ones, ERRVAL_CMD_MISSINGCODE is returned and pSzErr is not altered.
+**      When DMMCONFIG_ERRSTRINGS is 0 (dmmconfig.h), the messages are not built and "ERROR 0x<code>" is sent instead.
 **		
 */
 void ERRORS_PrintMessageString(uint8_t bErrCode, char *szContent)
 {
+#if !DMMCONFIG_ERRSTRINGS
+    if(bErrCode == ERRVAL_SUCCESS)
+    {
+        pSerialErr->println(szContent);
+    }
+    else
+    {
+        pSerialErr->print(F("ERROR 0x"));
+        pSerialErr->println(bErrCode, HEX);
+    }
+#else
     switch(bErrCode)
     {
         case ERRVAL_SUCCESS: 
@@ -149,8 +162,21 @@ void ERRORS_PrintMessageString(uint8_t bErrCode, char *szContent)
         case ERRVAL_CALIB_MISSINGMEASUREMENT:
             pSerialErr->println(F("A measurement must be performed before calling the finalize calibration."));
             break;       
+        case ERRVAL_DMM_SCALEFUNCTION:
+            pSerialErr->println(F("The function is not available on the current scale."));
+            break;       
+        case ERRVAL_DMM_TRACEDISABLED:
+            pSerialErr->println(F("The DMM trace is not included in the build (DMMTRACE_SIZE is 0)."));
+            break;       
+        case ERRVAL_DMM_WRONGPARAM:
+            pSerialErr->println(F("The DMM function parameter is not among the accepted values."));
+            break;       
+        case ERRVAL_DMM_OVERLOAD:
+            pSerialErr->println(F("The measured value is outside the convertor range."));
+            break;       
 
     }
+#endif
 
     
 }
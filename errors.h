@@ -49,6 +49,10 @@
 #define ERRVAL_CMD_VALFORMAT            0xF2    // The numeric value cannot be extracted from the provided string.
 #define ERRVAL_DMM_MEASUREDISPERSION    0xF1    // The calibration measurement dispersion exceeds accepted range
 #define ERRVAL_CALIB_MISSINGMEASUREMENT 0xF0    // A measurement must be performed before calling the finalize calibration.
+#define ERRVAL_DMM_SCALEFUNCTION        0xEF    // The function is not available on the current scale.
+#define ERRVAL_DMM_TRACEDISABLED        0xEE    // The DMM trace is not included in the build (DMMTRACE_SIZE is 0).
+#define ERRVAL_DMM_WRONGPARAM           0xED    // A DMM function parameter is not among the accepted values.
+#define ERRVAL_DMM_OVERLOAD             0xEC    // The measured value is outside the convertor range.
 
 // *****************************************************************************
 // *****************************************************************************
@@ -0,0 +1,139 @@
+// DMMShield library benchmark: times the library hot paths and prints a table of CPU cycles per call.
+// Timer1 counts the CPU clock (no prescaler) and its overflows extend it to 32 bits, so the sketch uses Timer1
+// (it cannot be combined with Servo or analogWrite on pins 9 and 10). Arduino Uno / Mega 2560 only (AVR).
+// The call overhead, measured on an empty function, is subtracted. Keep the printed table as a baseline
+// to compare the optimizations against.
+#include <DMMShield.h>
+#include <dmm.h>
+#include <dmmcmd.h>
+#include <spi.h>
+#include <eprom.h>
+
+#define BENCH_ITERATIONS    100
+
+DMMShield dmmShieldObj;
+
+volatile uint16_t wTmr1Ovf = 0;
+char szBenchVal[20];
+char szBenchCmd[20];
+double dBenchVal = 0.43397;
+uint16_t rgwBenchEprom[8];
+
+ISR(TIMER1_OVF_vect)
+{
+	wTmr1Ovf++;
+}
+
+// returns the CPU cycles counted by Timer1
+uint32_t GetCycles()
+{
+	uint8_t bSreg = SREG;
+	uint16_t wTmr, wOvf;
+	cli();
+	wTmr = TCNT1;
+	wOvf = wTmr1Ovf;
+	if((TIFR1 & _BV(TOV1)) && wTmr < 0x8000)
+	{
+		// the overflow happened while reading, its interrupt is pending
+		wOvf++;
+	}
+	SREG = bSreg;
+	return ((uint32_t)wOvf << 16) | wTmr;
+}
+
+// the benchmarked calls
+void BenchEmpty()
+{
+}
+
+void BenchDGetStatus()
+{
+	uint8_t bErr;
+	DMM_DGetStatus(&bErr);
+}
+
+void BenchSPITransferByte()
+{
+	SPI_CoreTransferByte(0);
+}
+
+void BenchFormatValue()
+{
+	DMM_FormatValue(dBenchVal, szBenchVal, 1);
+}
+
+// the parsed strings are modified in place, so they are copied before each call (included in the time)
+void BenchInterpretValue()
+{
+	strcpy(szBenchVal, "433.97 mV");
+	DMM_InterpretValue(szBenchVal, &dBenchVal);
+}
+
+void BenchGetCmdIdx()
+{
+	CMDTOK tok;
+	strcpy(szBenchCmd, "DMMSetFormat Eng, 4");
+	tok.pNext = szBenchCmd;
+	DMMCMD_GetCmdIdx(&tok);
+}
+
+void BenchEpromReadWords()
+{
+	EPROM_ReadWords(0, rgwBenchEprom, 8);
+}
+
+// returns the average cycles of a call of pfn
+uint32_t TimeCalls(void (*pfn)())
+{
+	uint32_t dwStart;
+	uint16_t i;
+	dwStart = GetCycles();
+	for(i = 0; i < BENCH_ITERATIONS; i++)
+	{
+		pfn();
+	}
+	return (GetCycles() - dwStart) / BENCH_ITERATIONS;
+}
+
+void PrintBench(const __FlashStringHelper *szName, void (*pfn)(), uint32_t dwOverhead)
+{
+	uint32_t dwCycles = TimeCalls(pfn) - dwOverhead;
+	Serial.print(szName);
+	Serial.print(", ");
+	Serial.print(dwCycles);
+	Serial.print(", ");
+	Serial.println(dwCycles / (F_CPU / 1000000.0), 2);
+}
+
+void setup()
+{
+	Serial.begin(9600);
+	dmmShieldObj.begin(&Serial);
+	dmmShieldObj.ProcessIndividualCmd("DMMSetScale VoltageDC5");
+	Serial.println("DMMShield Library Benchmark");
+
+	// Timer1: normal mode, no prescaler, overflow interrupt
+	cli();
+	TCCR1A = 0;
+	TCCR1B = _BV(CS10);
+	TCNT1 = 0;
+	TIFR1 = _BV(TOV1);
+	TIMSK1 = _BV(TOIE1);
+	sei();
+}
+
+void loop()
+{
+	uint32_t dwOverhead = TimeCalls(BenchEmpty);
+	Serial.print("Function, cycles, us (");
+	Serial.print(BENCH_ITERATIONS);
+	Serial.println(" calls)");
+	PrintBench(F("DMM_DGetStatus"), BenchDGetStatus, dwOverhead);
+	PrintBench(F("SPI_CoreTransferByte"), BenchSPITransferByte, dwOverhead);
+	PrintBench(F("DMM_FormatValue"), BenchFormatValue, dwOverhead);
+	PrintBench(F("DMM_InterpretValue"), BenchInterpretValue, dwOverhead);
+	PrintBench(F("DMMCMD_GetCmdIdx"), BenchGetCmdIdx, dwOverhead);
+	PrintBench(F("EPROM_ReadWords(8)"), BenchEpromReadWords, dwOverhead);
+	Serial.println();
+	delay(5000);
+}
@@ -0,0 +1,162 @@
+/* ************************************************************************** */
+/** Descriptive File Name
+
+  @Company
+    Digilent
+
+  @File Name
+    dmmbench.cpp
+
+  @Description
+        Host (PC) variant of the DMMShieldDemo_Benchmark example, built with google-benchmark (make bench).
+        It times the library hot paths linked with the host simulation stand-ins, on the PC CPU.
+        Besides the host times, each benchmark reports the avr_us counter: the virtual time per call of the simulation,
+        which only accounts for the digital IO and the time functions (see sim.h), so it estimates the cost
+        of the bit bang SPI transfers on the board, not the computations. The computations are timed on the board
+        by the example sketch.
+        The google-benchmark options apply, for example --benchmark_out=baseline.json --benchmark_out_format=json
+        records a baseline, to be compared with google-benchmark tools/compare.py.
+
+ */
+/* ************************************************************************** */
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+#include <string.h>
+#include <benchmark/benchmark.h>
+#include "Arduino.h"
+#include "sim.h"
+#include "dmm.h"
+#include "dmmcmd.h"
+#include "spi.h"
+#include "eprom.h"
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Local Functions                                                   */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/***	BENCH_SetVirtualTime
+**
+**	Parameters:
+**      benchmark::State &state     - the benchmark state
+**      uint64_t qwStartNs          - the virtual time at the start of the benchmark loop
+**
+**	Return Value:
+**		none
+**
+**	Description:
+**		This function reports the virtual time per iteration spent since qwStartNs, as the avr_us counter.
+**
+*/
+static void BENCH_SetVirtualTime(benchmark::State &state, uint64_t qwStartNs)
+{
+    state.counters["avr_us"] = benchmark::Counter((SIM_GetTimeNs() - qwStartNs) / 1000.0, benchmark::Counter::kAvgIterations);
+}
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Benchmarks                                                        */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+static void BM_DMM_DGetStatus(benchmark::State &state)
+{
+    uint8_t bErr;
+    uint64_t qwStartNs = SIM_GetTimeNs();
+    for(auto _: state)
+    {
+        benchmark::DoNotOptimize(DMM_DGetStatus(&bErr));
+    }
+    BENCH_SetVirtualTime(state, qwStartNs);
+}
+BENCHMARK(BM_DMM_DGetStatus);
+
+static void BM_SPI_CoreTransferByte(benchmark::State &state)
+{
+    uint64_t qwStartNs = SIM_GetTimeNs();
+    for(auto _: state)
+    {
+        benchmark::DoNotOptimize(SPI_CoreTransferByte(0));
+    }
+    BENCH_SetVirtualTime(state, qwStartNs);
+}
+BENCHMARK(BM_SPI_CoreTransferByte);
+
+static void BM_DMM_FormatValue(benchmark::State &state)
+{
+    char szVal[20];
+    double dVal = 0.43397;
+    for(auto _: state)
+    {
+        benchmark::DoNotOptimize(DMM_FormatValue(dVal, szVal, 1));
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_DMM_FormatValue);
+
+static void BM_DMM_InterpretValue(benchmark::State &state)
+{
+    char szVal[20];
+    double dVal;
+    for(auto _: state)
+    {
+        // the string is modified in place
+        strcpy(szVal, "433.97 mV");
+        benchmark::DoNotOptimize(DMM_InterpretValue(szVal, &dVal));
+    }
+}
+BENCHMARK(BM_DMM_InterpretValue);
+
+static void BM_DMMCMD_GetCmdIdx(benchmark::State &state)
+{
+    char szCmd[20];
+    CMDTOK tok;
+    for(auto _: state)
+    {
+        // the string is modified in place
+        strcpy(szCmd, "DMMSetFormat Eng, 4");
+        tok.pNext = szCmd;
+        benchmark::DoNotOptimize(DMMCMD_GetCmdIdx(&tok));
+    }
+}
+BENCHMARK(BM_DMMCMD_GetCmdIdx);
+
+static void BM_EPROM_ReadWords(benchmark::State &state)
+{
+    uint16_t rgwVals[8];
+    uint64_t qwStartNs = SIM_GetTimeNs();
+    for(auto _: state)
+    {
+        EPROM_ReadWords(0, rgwVals, 8);
+        benchmark::DoNotOptimize(rgwVals[0]);
+    }
+    BENCH_SetVirtualTime(state, qwStartNs);
+}
+BENCHMARK(BM_EPROM_ReadWords);
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Main                                                              */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+int main(int argc, char *argv[])
+{
+    char szScale[] = "DMMSetScale VoltageDC5";
+    benchmark::Initialize(&argc, argv);
+    // same initialization as the example sketch, the answers of the library go to the standard output
+    DMMCMD_Init(&Serial);
+    DMMCMD_ProcessIndividualCmd(szScale);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
+
+/* *****************************************************************************
+ End of File
+ */
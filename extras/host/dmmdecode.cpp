@@ -0,0 +1,173 @@
+/* ************************************************************************** */
+/** Descriptive File Name
+
+  @Company
+    Digilent
+
+  @File Name
+    dmmdecode.cpp
+
+  @Description
+        The DMMDECODE module converts on host the raw codes acquired on the device.
+        The raw codes are read on the device using DMM_GetRawCode (or the DMMReadRawCode text command), 
+        so that no floating point conversion is performed on the device when streaming at high rate.
+        The module includes the device scale table (dmmscales.h) and conversion math (dmmconv.h), 
+        therefore the converted values match the ones returned by DMM_DGetValue on the device within the float rounding 
+        of the device (double is a 32 bits float on AVR): a relative difference below 1e-6, see dmmconv.h.
+        The calibration coefficients are not stored in the raw codes: the caller provides the coefficients 
+        of the scale (for example exported with the DMMExportCalib command) matching the calibration generation of the codes.
+
+ */
+/* ************************************************************************** */
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// the scale table is placed in flash on the device
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+
+#include "dmmdecode.h"
+#include "../../dmmconv.h"
+#include "../../dmmscales.h"
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/***	DMMDECODE_ParseRawLine
+**
+**	Parameters:
+**      const char *szLine  - The line sent by the DMMReadRawCode command
+**      DMMRAW *pRaw        - Pointer to the structure receiving the raw codes
+**
+**	Return Value:
+**		uint8_t 
+**          DMMDECODE_SUCCESS           0       // success
+**          DMMDECODE_ERR_VALFORMAT     0xF2    // the line does not have the expected format
+**	Description:
+**		This function parses a line sent by the DMMReadRawCode command: 
+**      "Raw code: <scale index>, <calibration generation>, <intf hex>, <AD1 code>, <RMS 10 hex digits>".
+**      The "Raw code: " prefix is optional.
+**            
+*/
+uint8_t DMMDECODE_ParseRawLine(const char *szLine, DMMRAW *pRaw)
+{
+    unsigned int idxScale, bCalibGen, intf;
+    long ad1;
+    char szRms[11];
+    int i;
+    const char *szPrefix = strstr(szLine, "Raw code:");
+    if(szPrefix)
+    {
+        szLine = szPrefix + strlen("Raw code:");
+    }
+    if(sscanf(szLine, " %u, %u, %x, %ld, %10[0-9A-Fa-f]", &idxScale, &bCalibGen, &intf, &ad1, szRms) != 5 || strlen(szRms) != 10)
+    {
+        return DMMDECODE_ERR_VALFORMAT;
+    }
+    pRaw->idxScale = (uint8_t)idxScale;
+    pRaw->bCalibGen = (uint8_t)bCalibGen;
+    pRaw->intf = (uint8_t)intf;
+    pRaw->ad1 = (int32_t)ad1;
+    for(i = 0; i < 5; i++)
+    {
+        // MS byte first in the text
+        char szByte[3] = {szRms[2*i], szRms[2*i + 1], 0};
+        pRaw->rms[4 - i] = (uint8_t)strtoul(szByte, NULL, 16);
+    }
+    return DMMDECODE_SUCCESS;
+}
+
+/***	DMMDECODE_GetScaleMode
+**
+**	Parameters:
+**      int idxScale    - the scale index
+**
+**	Return Value:
+**		int
+**          the scale mode (DmmResistance, DmmDCVoltage, ...), or
+**          0 if the scale index is not valid
+**	Description:
+**		This function returns the mode of the scale, from the device scale table.
+**            
+*/
+int DMMDECODE_GetScaleMode(int idxScale)
+{
+    if(idxScale < 0 || idxScale >= DMM_CNTSCALES)
+    {
+        return 0;
+    }
+    return dmmcfg[idxScale].mode;
+}
+
+/***	DMMDECODE_DGetValue
+**
+**	Parameters:
+**      const DMMRAW *pRaw      - Pointer to the raw codes
+**      const CALIB *pCalib     - Pointer to the calibration coefficients of the scale, NULL to get the value without calibration
+**
+**	Return Value:
+**		double
+**          the value, as DMM_DGetValue would return it on the device, or
+**          NAN (not a number) value if the conversion was not done, for counter scales or for invalid scale index, or
+**          +/- INFINITY if the codes are outside the expected convertor range.
+**	Description:
+**		This function converts the raw codes, according to their scale: RMS accumulator for AC scales, AD1 code otherwise, 
+**      including the VoltageDC50 scale compensation. 
+**      The calibration coefficients are ignored for the scales without calibration.
+**            
+*/
+double DMMDECODE_DGetValue(const DMMRAW *pRaw, const CALIB *pCalib)
+{
+    double v = NAN;
+    int mode = DMMDECODE_GetScaleMode(pRaw->idxScale);
+    double mul;
+    if(pRaw->idxScale >= DMM_CNTCALIBSCALES)
+    {
+        pCalib = NULL;
+    }
+    switch(mode)
+    {
+        case 0:
+        case DmmFrequency:
+        case DmmPeriod:
+        case DmmDutyCycle:
+            // invalid scale index, or counter values that are not part of the raw codes
+            break;
+        case DmmACVoltage:
+        case DmmACCurrent:
+        case DmmACLowCurrent:
+            mul = dmmcfg[pRaw->idxScale].mul;
+            if(pRaw->intf & 0x10)
+            {
+                v = DMMCONV_DConvertRMS(pRaw->rms, mul, pCalib);
+            }
+            break;
+        default:
+            mul = dmmcfg[pRaw->idxScale].mul;
+            if(pRaw->intf & 0x04)
+            {
+                v = DMMCONV_DConvertAD1(pRaw->ad1, mul, pCalib);
+                if(pRaw->idxScale == DMMVoltageDC50Scale)
+                {
+                    v = DMMCONV_DCompensateVoltage50DCLinear(v);
+                }
+            }
+            break;
+    }
+    return v;
+}
+
+/* *****************************************************************************
+ End of File
+ */
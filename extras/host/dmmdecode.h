@@ -0,0 +1,46 @@
+/* ************************************************************************** */
+/** Descriptive File Name
+
+  @Company
+    Digilent
+
+  @File Name
+    dmmdecode.h
+
+  @Description
+        This file contains the declarations for the DMMDECODE host side library.
+        The library converts the raw codes acquired on the device (DMM_GetRawCode, DMMReadRawCode command) 
+        into measured values, using the same scale table (dmmscales.h) and conversion math (dmmconv.h) as the device.
+        It is built on the host (PC), it is not part of the Arduino library.
+
+ */
+/* ************************************************************************** */
+
+#ifndef _DMMDECODE_H    /* Guard against multiple inclusion */
+#define _DMMDECODE_H
+
+#include <stdint.h>
+#include "../../dmm.h"
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Constants                                                         */
+/* ************************************************************************** */
+// error codes, same values as the device errors (errors.h)
+#define DMMDECODE_SUCCESS           0       // success
+#define DMMDECODE_ERR_VALFORMAT     0xF2    // the line does not have the expected format
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Interface Functions
+// *****************************************************************************
+// *****************************************************************************
+uint8_t DMMDECODE_ParseRawLine(const char *szLine, DMMRAW *pRaw);
+double DMMDECODE_DGetValue(const DMMRAW *pRaw, const CALIB *pCalib);
+int DMMDECODE_GetScaleMode(int idxScale);
+
+#endif /* _DMMDECODE_H */
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,293 @@
+/* ************************************************************************** */
+/** Descriptive File Name
+
+  @Company
+    Digilent
+
+  @File Name
+    dmmreplay.cpp
+
+  @Description
+        Replay harness of the DMM transactions recorded on the device by the DMMTRACE module.
+        It reads the output of the DMMTrace command (the "TR: <timestamp>, <command>, <data>" lines, the other lines are ignored),
+        keeps the status block reads (command 0x01, registers 0x00 - 0x1F, with the INTF flags read by DMM_WaitConversion
+        before them merged in) and feeds them back through the library
+        (DMM_DGetStatus or DMM_DGetAvgValue), linked with the host simulation stand-ins: the DMMSIM model serves
+        the recorded blocks in place of its own registers (see DMMSIM_SetReplay).
+        The values are computed by the same code as on the device, so a captured trace reproduces a reading
+        for debugging, run after run. The host computes in 64 bits double while avr-gcc uses 32 bits float,
+        so the last digits may differ from the values sent by the device.
+        The benchmark mode times the conversion of the recorded blocks (DMM_UpdateCounters and DMM_DConvertStatus),
+        without the SPI transfers.
+        Usage:
+            dmmreplay -c scale [-e eprom.bin] [-a samples] [-b passes] [trace.txt]
+        -c  index of the scale selected when the trace was recorded (see DMM_SetScale)
+        -e  EPROM image holding the calibration of the device, a blank EPROM is used otherwise
+        -a  computes the average of the specified number of samples (DMM_DGetAvgValue), instead of each value (DMM_DGetStatus)
+        -b  times the conversion of the recorded blocks, repeated the specified number of passes
+        The trace is read from the standard input when no file is specified.
+
+ */
+/* ************************************************************************** */
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "Arduino.h"
+#include "dmmsim.h"
+#include "epromsim.h"
+#include "dmm.h"
+#include "errors.h"
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Constants                                                         */
+/* ************************************************************************** */
+/* ************************************************************************** */
+#define REPLAY_CMD_STATUS       0x01        // command byte of the status block read (DMM_ReadStatus)
+#define REPLAY_CMD_INTF         ((DMM_ADR_INTF << 1) | 1)   // command byte of the INTF read (DMM_WaitConversion)
+#define REPLAY_MAXLINE          256
+
+// library functions local to dmm.cpp
+uint8_t DMM_UpdateCounters(DMMSTS *pDmmSts);
+double DMM_DConvertStatus(DMMSTS *pDmmSts, uint8_t fCntNew);
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Local Functions                                                   */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/***	REPLAY_ParseLine
+**
+**	Parameters:
+**      const char *szLine      - a line sent by the DMMTrace command
+**      DMMSIM_FRAME *pFrame    - Pointer to the structure receiving the transaction
+**
+**	Return Value:
+**		int     - 1 if the line holds a transaction, 0 otherwise
+**
+**	Description:
+**		This function parses a "TR: <timestamp us>, <command byte hex>, <data bytes hex>" line.
+**
+*/
+static int REPLAY_ParseLine(const char *szLine, DMMSIM_FRAME *pFrame)
+{
+    unsigned long dwTime;
+    unsigned int bCmd, bVal;
+    char szData[2 * DMMSIM_MAXFRAME + 2];
+    const char *pc = strstr(szLine, "TR: ");
+    int cch;
+    if(!pc)
+    {
+        return 0;
+    }
+    szData[0] = 0;
+    if(sscanf(pc + 4, "%lu , %x , %66[0-9A-Fa-f]", &dwTime, &bCmd, szData) < 2 || bCmd > 0xFF)
+    {
+        return 0;
+    }
+    cch = strlen(szData);
+    if((cch & 1) || cch > 2 * DMMSIM_MAXFRAME)
+    {
+        return 0;
+    }
+    pFrame->bCmd = bCmd;
+    pFrame->cb = cch / 2;
+    for(cch = 0; cch < pFrame->cb; cch++)
+    {
+        sscanf(szData + 2 * cch, "%2x", &bVal);
+        pFrame->rgb[cch] = bVal;
+    }
+    return 1;
+}
+
+/***	REPLAY_Bench
+**
+**	Parameters:
+**      const DMMSIM_FRAME *pFrames - the recorded status blocks
+**      uint32_t cntFrames          - the number of blocks
+**      uint32_t cntPasses          - the number of passes over the blocks
+**
+**	Return Value:
+**		none
+**
+**	Description:
+**		This function times the conversion of the recorded blocks in the current scale and prints the time per block.
+**      The sum of the values is printed, so that the conversions are not optimized out.
+**
+*/
+static void REPLAY_Bench(const DMMSIM_FRAME *pFrames, uint32_t cntFrames, uint32_t cntPasses)
+{
+    struct timespec tsStart, tsEnd;
+    DMMSTS dmmsts;
+    double dSum = 0, dVal, dNs;
+    uint32_t cntVal = 0;
+    uint32_t i, j;
+    clock_gettime(CLOCK_MONOTONIC, &tsStart);
+    for(j = 0; j < cntPasses; j++)
+    {
+        for(i = 0; i < cntFrames; i++)
+        {
+            memcpy(&dmmsts, pFrames[i].rgb, sizeof(dmmsts));
+            dVal = DMM_DConvertStatus(&dmmsts, DMM_UpdateCounters(&dmmsts));
+            if(!isnan(dVal) && !isinf(dVal))
+            {
+                dSum += dVal;
+                cntVal++;
+            }
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &tsEnd);
+    dNs = (tsEnd.tv_sec - tsStart.tv_sec) * 1e9 + (tsEnd.tv_nsec - tsStart.tv_nsec);
+    printf("blocks: %lu, passes: %lu, values: %lu, checksum: %.9g\n",
+        (unsigned long)cntFrames, (unsigned long)cntPasses, (unsigned long)cntVal, dSum);
+    printf("conversion: %.1f ns/block\n", dNs / ((double)cntFrames * cntPasses));
+}
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Main                                                              */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+int main(int argc, char *argv[])
+{
+    const char *szEprom = NULL;
+    int idxScale = -1;
+    int cbAvg = 0;
+    uint32_t cntPasses = 0;
+    FILE *pf = stdin;
+    char szLine[REPLAY_MAXLINE];
+    DMMSIM_FRAME *pFrames = NULL;
+    uint32_t cntFrames = 0, cntAlloc = 0;
+    uint32_t idxFrame;
+    uint8_t bIntfPending = 0;
+    uint8_t bErr;
+    double dVal;
+    int opt;
+
+    while((opt = getopt(argc, argv, "c:e:a:b:h")) != -1)
+    {
+        switch(opt)
+        {
+            case 'c':
+                idxScale = atoi(optarg);
+                break;
+            case 'e':
+                szEprom = optarg;
+                break;
+            case 'a':
+                cbAvg = atoi(optarg);
+                break;
+            case 'b':
+                cntPasses = strtoul(optarg, NULL, 0);
+                break;
+            default:
+                idxScale = -1;
+                optind = argc;
+                break;
+        }
+    }
+    if(idxScale < 0 || idxScale >= DMM_CNTSCALES || cbAvg < 0 || optind < argc - 1)
+    {
+        fprintf(stderr, "usage: %s -c scale [-e eprom.bin] [-a samples] [-b passes] [trace.txt]\n", argv[0]);
+        return 2;
+    }
+    if(optind < argc && !(pf = fopen(argv[optind], "r")))
+    {
+        fprintf(stderr, "dmmreplay: cannot open %s\n", argv[optind]);
+        return 1;
+    }
+
+    // keep the status block reads, with the INTF flags read before them merged as DMM_ReadStatus does
+    while(fgets(szLine, sizeof(szLine), pf))
+    {
+        if(cntFrames == cntAlloc)
+        {
+            cntAlloc = cntAlloc ? 2 * cntAlloc: 256;
+            pFrames = (DMMSIM_FRAME *)realloc(pFrames, cntAlloc * sizeof(DMMSIM_FRAME));
+        }
+        if(!REPLAY_ParseLine(szLine, &pFrames[cntFrames]))
+        {
+            continue;
+        }
+        if(pFrames[cntFrames].bCmd == REPLAY_CMD_INTF && pFrames[cntFrames].cb == 1)
+        {
+            bIntfPending |= pFrames[cntFrames].rgb[0];
+        }
+        else if(pFrames[cntFrames].bCmd == REPLAY_CMD_STATUS && pFrames[cntFrames].cb == sizeof(DMMSTS))
+        {
+            pFrames[cntFrames].rgb[DMM_ADR_INTF] |= bIntfPending;
+            bIntfPending = 0;
+            cntFrames++;
+        }
+    }
+    if(pf != stdin)
+    {
+        fclose(pf);
+    }
+    if(!cntFrames)
+    {
+        fprintf(stderr, "dmmreplay: no status block read in the trace\n");
+        return 1;
+    }
+
+    if(szEprom && EPROMSIM_Load(szEprom))
+    {
+        fprintf(stderr, "dmmreplay: %s not found, using a blank EPROM\n", szEprom);
+    }
+    DMM_Init();
+    // the recorded blocks are read in sequence, without waiting for the conversions
+    DMM_SetAdaptivePoll(0);
+    bErr = DMM_SetScale(idxScale);
+    if(bErr != ERRVAL_SUCCESS)
+    {
+        fprintf(stderr, "dmmreplay: cannot select scale %d, error 0x%02X\n", idxScale, bErr);
+        return 1;
+    }
+
+    if(cntPasses)
+    {
+        REPLAY_Bench(pFrames, cntFrames, cntPasses);
+    }
+    else
+    {
+        DMMSIM_SetReplay(pFrames, cntFrames);
+        for(idxFrame = 0; !DMMSIM_FReplayEnd(); idxFrame++)
+        {
+            if(cbAvg)
+            {
+                dVal = DMM_DGetAvgValue(cbAvg, &bErr);
+                if(bErr != ERRVAL_SUCCESS)
+                {
+                    // the last samples are missing
+                    break;
+                }
+                printf("%lu, %.17g\n", (unsigned long)idxFrame, dVal);
+            }
+            else
+            {
+                dVal = DMM_DGetStatus(&bErr);
+                if(!isnan(dVal))
+                {
+                    printf("%lu, %.17g\n", (unsigned long)idxFrame, dVal);
+                }
+            }
+        }
+    }
+    free(pFrames);
+    return 0;
+}
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,86 @@
+/* ************************************************************************** */
+/** Descriptive File Name
+
+  @Company
+    Digilent
+
+  @File Name
+    Arduino.h
+
+  @Description
+        Host (PC) stand-in for the Arduino core header, used by the DMMSIM simulation target.
+        Only the core functions called by the DMMShield library and its example sketches are declared.
+        They are defined in arduino.cpp: the time functions use a virtual clock and the digital pins
+        are routed to the behavioural models of the DMM chip (dmmsim) and of the EPROM (epromsim).
+
+ */
+/* ************************************************************************** */
+
+#ifndef _ARDUINO_H    /* Guard against multiple inclusion */
+#define _ARDUINO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "avr/pgmspace.h"
+#include "HardwareSerial.h"
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Constants                                                         */
+/* ************************************************************************** */
+#define HIGH                0x1
+#define LOW                 0x0
+
+#define INPUT               0x0
+#define OUTPUT              0x1
+#define INPUT_PULLUP        0x2
+
+#define CHANGE              1
+#define FALLING             2
+#define RISING              3
+
+#define DEC                 10
+#define HEX                 16
+
+#define NOT_AN_INTERRUPT    -1
+#define digitalPinToInterrupt(p) ((p) == 2 ? 0 : ((p) == 3 ? 1 : NOT_AN_INTERRUPT))
+
+typedef uint8_t byte;
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+// digital IO
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+// interrupts
+void attachInterrupt(uint8_t bInt, void (*pfnISR)(void), int mode);
+void detachInterrupt(uint8_t bInt);
+void noInterrupts();
+void interrupts();
+
+// time
+unsigned long micros();
+unsigned long millis();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+// avr-libc number conversions
+char *itoa(int val, char *s, int radix);
+char *ltoa(long val, char *s, int radix);
+char *ultoa(unsigned long val, char *s, int radix);
+
+extern HardwareSerial Serial;
+
+#endif /* _ARDUINO_H */
+
+/* *****************************************************************************
+ End of File
+ */
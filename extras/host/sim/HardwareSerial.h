@@ -0,0 +1,72 @@
+/* ************************************************************************** */
+/** Descriptive File Name
+
+  @Company
+    Digilent
+
+  @File Name
+    HardwareSerial.h
+
+  @Description
+        Host (PC) stand-in for the Arduino HardwareSerial class, used by the DMMSIM simulation target.
+        The received characters are read from the standard input and the transmitted characters
+        are written to the standard output. The class is defined in arduino.cpp.
+
+ */
+/* ************************************************************************** */
+
+#ifndef _HARDWARESERIAL_H    /* Guard against multiple inclusion */
+#define _HARDWARESERIAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// strings placed in flash (F() macro), plain strings on host
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+
+class HardwareSerial
+{
+public:
+    void begin(unsigned long baud);
+    void end();
+    int available();
+    int read();
+    int peek();
+    void flush();
+    operator bool() { return true; }
+
+    size_t write(uint8_t b);
+    size_t write(const char *sz);
+
+    size_t print(const char *sz);
+    size_t print(const __FlashStringHelper *sz);
+    size_t print(char c);
+    size_t print(unsigned char b, int base = 10);
+    size_t print(int n, int base = 10);
+    size_t print(unsigned int n, int base = 10);
+    size_t print(long n, int base = 10);
+    size_t print(unsigned long n, int base = 10);
+    size_t print(double d, int digits = 2);
+
+    size_t println();
+    size_t println(const char *sz);
+    size_t println(const __FlashStringHelper *sz);
+    size_t println(char c);
+    size_t println(unsigned char b, int base = 10);
+    size_t println(int n, int base = 10);
+    size_t println(unsigned int n, int base = 10);
+    size_t println(long n, int base = 10);
+    size_t println(unsigned long n, int base = 10);
+    size_t println(double d, int digits = 2);
+
+private:
+    size_t printNumber(unsigned long n, int base, uint8_t fNeg);
+    int bPeek = -1;     // character read from the input but not yet consumed, -1 if none
+};
+
+#endif /* _HARDWARESERIAL_H */
+
+/* *****************************************************************************
+ End of File
+ */
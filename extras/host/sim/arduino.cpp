@@ -0,0 +1,492 @@
+/* ************************************************************************** */
+/** Descriptive File Name
+
+  @Company
+    Digilent
+
+  @File Name
+    arduino.cpp
+
+  @Description
+        This file implements the Arduino core stand-ins of the host (PC) simulation target.
+        - time: a virtual clock, advanced by delay / delayMicroseconds and by the duration of the core functions
+          on the Arduino Uno (SIM_NS_DIGITALIO, SIM_NS_MICROS, one character time for each transmitted character),
+          so that the simulated timings do not depend on the speed of the PC and the runs are reproducible.
+        - digital pins: the DMM and EPROM chip selects, the SPI clock, MOSI and MISO (gpio.h) are routed to
+          the DMMSIM and EPROMSIM models. The other pins keep the written level, or the level set by SIM_SetPin,
+          which also calls the handlers registered by attachInterrupt on pins 2 and 3.
+        - Serial: the received characters are read from the standard input (without blocking), one character time apart,
+          the transmitted characters are written to the standard output.
+
+ */
+/* ************************************************************************** */
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+#include <stdio.h>
+#include <poll.h>
+#include <unistd.h>
+#include "Arduino.h"
+#include "gpio.h"
+#include "sim.h"
+#include "dmmsim.h"
+#include "epromsim.h"
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Global Variables                                                  */
+/* ************************************************************************** */
+/* ************************************************************************** */
+HardwareSerial Serial;
+
+static uint64_t qwTimeNs = 0;
+static uint8_t rgPin[SIM_CNTPINS];
+static uint32_t cntIO = 0;
+static void (*rgpfnISR[2])(void) = {NULL, NULL};
+static int rgISRMode[2];
+static uint32_t dwNsPerChar = 0;
+static uint64_t qwNextCharNs = 0;   // the arrival time of the next received character
+static uint8_t fInputEnd = 0;
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: SIM Functions                                                     */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/***	SIM_Advance
+**
+**	Parameters:
+**      uint32_t dwNs       - the time to add to the virtual clock (ns)
+**
+**	Return Value:
+**		none
+**
+**	Description:
+**		This function advances the virtual clock.
+**
+*/
+void SIM_Advance(uint32_t dwNs)
+{
+    qwTimeNs += dwNs;
+}
+
+/***	SIM_GetTimeNs
+**
+**	Parameters:
+**      none
+**
+**	Return Value:
+**		uint64_t    - the virtual time since the start of the simulation (ns)
+**
+**	Description:
+**		This function returns the virtual clock, without advancing it.
+**
+*/
+uint64_t SIM_GetTimeNs()
+{
+    return qwTimeNs;
+}
+
+/***	SIM_SetPin
+**
+**	Parameters:
+**      uint8_t bPin        - the pin number
+**      uint8_t bVal        - the level driven on the pin, HIGH or LOW
+**
+**	Return Value:
+**		none
+**
+**	Description:
+**		This function drives an input pin from outside the sketch (for example a trigger signal).
+**      When the pin is 2 or 3 and a handler is attached for the edge, the handler is called.
+**
+*/
+void SIM_SetPin(uint8_t bPin, uint8_t bVal)
+{
+    int bInt = digitalPinToInterrupt(bPin);
+    uint8_t bOld;
+    if(bPin >= SIM_CNTPINS)
+    {
+        return;
+    }
+    bOld = rgPin[bPin];
+    rgPin[bPin] = bVal ? HIGH: LOW;
+    if(bInt != NOT_AN_INTERRUPT && rgpfnISR[bInt] && bOld != rgPin[bPin])
+    {
+        if(rgISRMode[bInt] == CHANGE ||
+            (rgISRMode[bInt] == RISING && rgPin[bPin] == HIGH) ||
+            (rgISRMode[bInt] == FALLING && rgPin[bPin] == LOW))
+        {
+            rgpfnISR[bInt]();
+        }
+    }
+}
+
+/***	SIM_GetPin
+**
+**	Parameters:
+**      uint8_t bPin        - the pin number
+**
+**	Return Value:
+**		uint8_t     - the last level written or driven on the pin
+**
+**	Description:
+**		This function returns the level of a pin, without advancing the virtual clock (for example the relays).
+**
+*/
+uint8_t SIM_GetPin(uint8_t bPin)
+{
+    return (bPin < SIM_CNTPINS) ? rgPin[bPin]: LOW;
+}
+
+/***	SIM_GetIOCount
+**
+**	Parameters:
+**      none
+**
+**	Return Value:
+**		uint32_t    - the number of digitalWrite and digitalRead calls
+**
+**	Description:
+**		This function returns the number of digital IO operations since the start of the simulation.
+**
+*/
+uint32_t SIM_GetIOCount()
+{
+    return cntIO;
+}
+
+/***	SIM_FInputEnd
+**
+**	Parameters:
+**      none
+**
+**	Return Value:
+**		uint8_t     - 1 if all the characters of the standard input were received, 0 otherwise
+**
+**	Description:
+**		This function tells if the end of the standard input was reached.
+**
+*/
+uint8_t SIM_FInputEnd()
+{
+    return fInputEnd;
+}
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Arduino Core Functions                                            */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    (void)pin;
+    (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+    uint8_t bOld;
+    uint32_t dwTime;
+    SIM_Advance(SIM_NS_DIGITALIO);
+    cntIO++;
+    if(pin >= SIM_CNTPINS)
+    {
+        return;
+    }
+    bOld = rgPin[pin];
+    rgPin[pin] = val ? HIGH: LOW;
+    dwTime = (uint32_t)(qwTimeNs / 1000);
+    switch(pin)
+    {
+        case PIN_SPI_SS:    // active low
+            DMMSIM_Select(rgPin[pin] == LOW, dwTime);
+            break;
+        case PIN_ESPI_SS:   // active high
+            EPROMSIM_Select(rgPin[pin] == HIGH, dwTime);
+            break;
+        case PIN_SPI_CLK:
+            if(bOld == LOW && rgPin[pin] == HIGH)
+            {
+                if(rgPin[PIN_SPI_SS] == LOW)
+                {
+                    DMMSIM_ClockRise(rgPin[PIN_SPI_MOSI]);
+                }
+                if(rgPin[PIN_ESPI_SS] == HIGH)
+                {
+                    EPROMSIM_ClockRise(rgPin[PIN_SPI_MOSI]);
+                }
+            }
+            break;
+    }
+}
+
+int digitalRead(uint8_t pin)
+{
+    SIM_Advance(SIM_NS_DIGITALIO);
+    cntIO++;
+    if(pin == PIN_SPI_MISO)
+    {
+        if(rgPin[PIN_SPI_SS] == LOW)
+        {
+            return DMMSIM_GetMiso();
+        }
+        if(rgPin[PIN_ESPI_SS] == HIGH)
+        {
+            return EPROMSIM_GetDo((uint32_t)(qwTimeNs / 1000));
+        }
+        return LOW;
+    }
+    return SIM_GetPin(pin);
+}
+
+void attachInterrupt(uint8_t bInt, void (*pfnISR)(void), int mode)
+{
+    if(bInt < 2)
+    {
+        rgpfnISR[bInt] = pfnISR;
+        rgISRMode[bInt] = mode;
+    }
+}
+
+void detachInterrupt(uint8_t bInt)
+{
+    if(bInt < 2)
+    {
+        rgpfnISR[bInt] = NULL;
+    }
+}
+
+void noInterrupts()
+{
+}
+
+void interrupts()
+{
+}
+
+unsigned long micros()
+{
+    SIM_Advance(SIM_NS_MICROS);
+    return (unsigned long)(uint32_t)(qwTimeNs / 1000);
+}
+
+unsigned long millis()
+{
+    SIM_Advance(SIM_NS_MICROS);
+    return (unsigned long)(uint32_t)(qwTimeNs / 1000000);
+}
+
+void delay(unsigned long ms)
+{
+    qwTimeNs += (uint64_t)ms * 1000000;
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    qwTimeNs += (uint64_t)us * 1000;
+}
+
+// no other task runs in the simulation, the waiting loops progress through micros
+void yield()
+{
+}
+
+// avr/sleep.h stand-in: the only interrupt simulated is the Timer0 overflow, sleep until the next one
+void sleep_cpu()
+{
+    qwTimeNs += SIM_NS_TIMER0 - qwTimeNs % SIM_NS_TIMER0;
+}
+
+char *ultoa(unsigned long val, char *s, int radix)
+{
+    char rgch[33];
+    int i = 0;
+    char *p = s;
+    do
+    {
+        int d = val % radix;
+        rgch[i++] = (d < 10) ? ('0' + d): ('a' + d - 10);
+        val /= radix;
+    } while(val);
+    while(i)
+    {
+        *p++ = rgch[--i];
+    }
+    *p = 0;
+    return s;
+}
+
+char *ltoa(long val, char *s, int radix)
+{
+    if(val < 0 && radix == 10)
+    {
+        s[0] = '-';
+        ultoa(-(unsigned long)val, s + 1, radix);
+        return s;
+    }
+    return ultoa((unsigned long)val, s, radix);
+}
+
+char *itoa(int val, char *s, int radix)
+{
+    if(radix != 10)
+    {
+        // avr-libc converts the 16 bits value for the other radixes
+        return ultoa((unsigned int)val & 0xFFFF, s, radix);
+    }
+    return ltoa(val, s, radix);
+}
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: HardwareSerial                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+void HardwareSerial::begin(unsigned long baud)
+{
+    dwNsPerChar = baud ? (uint32_t)(10000000000ull / baud): 0;
+}
+
+void HardwareSerial::end()
+{
+}
+
+int HardwareSerial::available()
+{
+    struct pollfd pfd;
+    if(bPeek >= 0)
+    {
+        return 1;
+    }
+    if(fInputEnd || qwTimeNs < qwNextCharNs)
+    {
+        return 0;
+    }
+    pfd.fd = STDIN_FILENO;
+    pfd.events = POLLIN;
+    if(poll(&pfd, 1, 0) > 0)
+    {
+        unsigned char ch;
+        if(::read(STDIN_FILENO, &ch, 1) == 1)
+        {
+            // the characters arrive back to back, received in background as by the UART
+            bPeek = ch;
+            qwNextCharNs += dwNsPerChar;
+            return 1;
+        }
+        fInputEnd = 1;
+    }
+    return 0;
+}
+
+int HardwareSerial::read()
+{
+    int ch = -1;
+    if(available())
+    {
+        ch = bPeek;
+        bPeek = -1;
+    }
+    return ch;
+}
+
+int HardwareSerial::peek()
+{
+    return available() ? bPeek: -1;
+}
+
+void HardwareSerial::flush()
+{
+    fflush(stdout);
+}
+
+size_t HardwareSerial::write(uint8_t b)
+{
+    putchar(b);
+    qwTimeNs += dwNsPerChar;
+    return 1;
+}
+
+size_t HardwareSerial::write(const char *sz)
+{
+    size_t cb = 0;
+    while(*sz)
+    {
+        cb += write((uint8_t)*sz++);
+    }
+    return cb;
+}
+
+size_t HardwareSerial::printNumber(unsigned long n, int base, uint8_t fNeg)
+{
+    char sz[36];
+    sz[0] = '-';
+    ultoa(n, sz + 1, base);
+    if(base == HEX)
+    {
+        // Arduino prints the hexadecimal digits in upper case
+        for(char *p = sz + 1; *p; p++)
+        {
+            if(*p >= 'a' && *p <= 'f')
+            {
+                *p -= 'a' - 'A';
+            }
+        }
+    }
+    return write(fNeg ? sz: sz + 1);
+}
+
+size_t HardwareSerial::print(const char *sz)                 { return write(sz); }
+size_t HardwareSerial::print(const __FlashStringHelper *sz)  { return write(reinterpret_cast<const char *>(sz)); }
+size_t HardwareSerial::print(char c)                         { return write((uint8_t)c); }
+size_t HardwareSerial::print(unsigned char b, int base)      { return printNumber(b, base, 0); }
+size_t HardwareSerial::print(unsigned int n, int base)       { return printNumber(n, base, 0); }
+size_t HardwareSerial::print(unsigned long n, int base)      { return printNumber(n, base, 0); }
+size_t HardwareSerial::print(int n, int base)                { return print((long)n, base); }
+
+size_t HardwareSerial::print(long n, int base)
+{
+    if(base == 10 && n < 0)
+    {
+        return printNumber(-(unsigned long)n, base, 1);
+    }
+    // Arduino prints the other bases as unsigned, the int values as 16 bits
+    return printNumber((unsigned long)n, base, 0);
+}
+
+size_t HardwareSerial::print(double d, int digits)
+{
+    char sz[64];
+    if(isnan(d))
+    {
+        return write("nan");
+    }
+    if(isinf(d))
+    {
+        return write("inf");
+    }
+    snprintf(sz, sizeof(sz), "%.*f", digits, d);
+    return write(sz);
+}
+
+size_t HardwareSerial::println()                                 { return write("\r\n"); }
+size_t HardwareSerial::println(const char *sz)                   { return print(sz) + println(); }
+size_t HardwareSerial::println(const __FlashStringHelper *sz)    { return print(sz) + println(); }
+size_t HardwareSerial::println(char c)                           { return print(c) + println(); }
+size_t HardwareSerial::println(unsigned char b, int base)        { return print(b, base) + println(); }
+size_t HardwareSerial::println(int n, int base)                  { return print(n, base) + println(); }
+size_t HardwareSerial::println(unsigned int n, int base)         { return print(n, base) + println(); }
+size_t HardwareSerial::println(long n, int base)                 { return print(n, base) + println(); }
+size_t HardwareSerial::println(unsigned long n, int base)        { return print(n, base) + println(); }
+size_t HardwareSerial::println(double d, int digits)             { return print(d, digits) + println(); }
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,47 @@
+/* ************************************************************************** */
+/** Descriptive File Name
+
+  @Company
+    Digilent
+
+  @File Name
+    pgmspace.h
+
+  @Description
+        Host (PC) stand-in for avr-libc <avr/pgmspace.h>, used by the DMMSIM simulation target.
+        There is a single address space on host, so the PROGMEM data is placed in RAM
+        and the program memory accessors are plain memory reads.
+
+ */
+/* ************************************************************************** */
+
+#ifndef _PGMSPACE_H    /* Guard against multiple inclusion */
+#define _PGMSPACE_H
+
+#include <string.h>
+#include <stdint.h>
+
+#define PROGMEM
+#define PGM_P               const char *
+#define PSTR(s)             (s)
+
+// the accessors keep the type of the pointed object, so that tables of pointers work on 64 bits hosts
+#define pgm_read_byte(p)    (*(const uint8_t *)(p))
+#define pgm_read_word(p)    (*(p))
+#define pgm_read_dword(p)   (*(const uint32_t *)(p))
+#define pgm_read_float(p)   (*(const float *)(p))
+#define pgm_read_ptr(p)     (*(void * const *)(p))
+
+#define memcpy_P            memcpy
+#define strcpy_P            strcpy
+#define strncpy_P           strncpy
+#define strcmp_P            strcmp
+#define strncmp_P           strncmp
+#define strcasecmp_P        strcasecmp
+#define strlen_P            strlen
+
+#endif /* _PGMSPACE_H */
+
+/* *****************************************************************************
+ End of File
+ */
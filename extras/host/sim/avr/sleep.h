@@ -0,0 +1,33 @@
+/* ************************************************************************** */
+/** Descriptive File Name
+
+  @Company
+    Digilent
+
+  @File Name
+    sleep.h
+
+  @Description
+        Host (PC) stand-in for avr-libc <avr/sleep.h>, used by the DMMSIM simulation target.
+        The sleep mode selection and the sleep enable bit have no effect. sleep_cpu advances the virtual clock
+        to the next wake up interrupt, the Timer0 overflow (see arduino.cpp).
+
+ */
+/* ************************************************************************** */
+
+#ifndef _SLEEP_H    /* Guard against multiple inclusion */
+#define _SLEEP_H
+
+#define SLEEP_MODE_IDLE         0
+
+#define set_sleep_mode(mode)
+#define sleep_enable()
+#define sleep_disable()
+
+void sleep_cpu();
+
+#endif /* _SLEEP_H */
+
+/* *****************************************************************************
+ End of File
+ */
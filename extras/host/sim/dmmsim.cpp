@@ -0,0 +1,588 @@
+/* ************************************************************************** */
+/** Descriptive File Name
+
+  @Company
+    Digilent
+
+  @File Name
+    dmmsim.cpp
+
+  @Description
+        The DMMSIM module is a behavioural model of the DMM chip register file (0x00 - 0x37),
+        used by the host (PC) simulation target in place of the DMMShield hardware.
+        The model is driven at pin level by arduino.cpp: it decodes the bit bang SPI frames sent by
+        DMM_SendCmdSPI and DMM_GetCmdSPI (command byte: 7 bits address, LSB 1 for read,
+        one extra clock before the data on read, auto incremented address).
+        Model behaviour:
+        - writing 0x60 on 0x37 resets the chip: all registers are cleared and the conversions restart.
+        - the configuration registers 0x1F - 0x36 are read back as written.
+        - AD1 conversions complete every DMMSIM_AD1_BASEPERIOD << (R22 bits 2:0) us, updating AD1, AD2, LPF,
+          the peak hold registers and setting intf bit 0x04. The converted code is the input code plus pseudo random noise.
+        - RMS windows complete every DMMSIM_RMS_PERIODS AD1 conversions, setting RMS to the square of the input code
+          in RMS units (see DMMSIM_RMS_CODEDIV, saturated to 40 bits) and intf bit 0x10, so that an AC voltage scale reads 
+          the same value as the DC voltage scale of the same range. The AC current scales read 0.93 times the DC value, 
+          their RMS units are not modeled.
+        - the counter gate window completes every DMMSIM_CNT_GATE us, setting CTA, CTB, CTC and CTSTA bit 0x01.
+        - INTF and CTSTA are cleared when they are read.
+        - when stalled (DMMSIM_SetStall), no conversion completes, as for a stalled or disconnected chip.
+        - in replay mode (DMMSIM_SetReplay), the read frames having the command byte of the next recorded frame
+          return the recorded bytes instead of the registers. When all the frames were replayed, they return 0 bytes
+          (no conversion ready), so that the library does not mix model values with the recorded ones.
+        The conversion timing follows the virtual time of the simulation, given when the chip is selected.
+
+ */
+/* ************************************************************************** */
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+#include <string.h>
+#include "dmmsim.h"
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Constants                                                         */
+/* ************************************************************************** */
+/* ************************************************************************** */
+#define DMMSIM_ADR_AD1          0x00
+#define DMMSIM_ADR_AD2          0x03
+#define DMMSIM_ADR_LPF          0x06
+#define DMMSIM_ADR_RMS          0x09
+#define DMMSIM_ADR_PKHMIN       0x0E
+#define DMMSIM_ADR_PKHMAX       0x11
+#define DMMSIM_ADR_CTSTA        0x14
+#define DMMSIM_ADR_CTC          0x15
+#define DMMSIM_ADR_CTB          0x18
+#define DMMSIM_ADR_CTA          0x1B
+#define DMMSIM_ADR_INTF         0x1E
+
+#define DMMSIM_INTF_AD1         0x04
+#define DMMSIM_INTF_RMS         0x10
+#define DMMSIM_CTSTA_READY      0x01
+
+#define DMMSIM_CNT_REFCLK       4915200UL   // counter reference clock (Hz)
+#define DMMSIM_AD1_MAX          0x7FFFFF
+// AD1 codes per RMS unit: the chip reports the square of the RMS value, in units that the library converts with the
+// AC scale factors (1e-4 V for VoltageAC5), while the DC scales use 12.5 / 1.8 / 2^23 V per AD1 code (VoltageDC5),
+// the ratio being the same for all the voltage ranges
+#define DMMSIM_RMS_CODEDIV      (1e-4 * 8388608 * 1.8 / 12.5)
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Local Functions Prototypes                                        */
+/* ************************************************************************** */
+/* ************************************************************************** */
+void DMMSIM_Reset();
+void DMMSIM_Update(uint32_t dwTime);
+void DMMSIM_Convert();
+void DMMSIM_WriteRegister(uint8_t bAddr, uint8_t bVal);
+uint8_t DMMSIM_ReadRegister(uint8_t bAddr);
+void DMMSIM_SetReg24(uint8_t bAddr, uint32_t dwVal);
+uint32_t DMMSIM_GetPeriod();
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Global Variables                                                  */
+/* ************************************************************************** */
+/* ************************************************************************** */
+static uint8_t rgReg[DMMSIM_CNTREGS];
+
+// input signal
+static int32_t lInAd1 = DMMSIM_DEF_AD1;
+static uint32_t dwInNoise = DMMSIM_DEF_NOISE;
+static uint32_t dwInFreq = DMMSIM_DEF_FREQ;
+static uint8_t bInDuty = DMMSIM_DEF_DUTY;
+static uint32_t dwLfsr = 0xACE1u;
+
+// conversion timing
+static uint32_t dwTimeNow = 0;
+static uint32_t dwNextAd1 = 0;
+static uint32_t dwNextCnt = 0;
+static uint8_t cntRmsConv = 0;
+static uint8_t fPkhValid = 0;
+static uint8_t fStalled = 0;
+
+// SPI frame decoding
+static uint8_t fSelected = 0;
+static uint16_t cntBits = 0;        // rising clock edges since the chip was selected
+static uint8_t bShift = 0;          // bits received, MSB first
+static uint8_t bAddr = 0;           // the address of the current data byte
+static uint8_t fRead = 0;
+static uint8_t bOut = 0;            // the data byte being transmitted
+static uint32_t cntTransfers = 0;
+
+// replay of recorded read frames
+static const DMMSIM_FRAME *pReplayFrames = NULL;
+static uint32_t cntReplayFrames = 0;
+static uint32_t idxReplay = 0;          // the next frame to be replayed
+static const DMMSIM_FRAME *pReplayCur = NULL;   // the frame being replayed in the current transfer, NULL if none
+static uint8_t fReplayZero = 0;         // the current transfer returns 0 bytes (all the frames were replayed)
+static uint8_t idxReplayByte = 0;
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/***	DMMSIM_SetInput
+**
+**	Parameters:
+**      int32_t lAd1        - the AD1 input code, it is clamped to the convertor range
+**      uint32_t dwNoise    - the peak value of the noise added to each conversion (LSB)
+**
+**	Return Value:
+**		none
+**
+**	Description:
+**		This function sets the signal converted by the model. The same code is used for AD1, AD2, LPF (without noise)
+**      and RMS, so the value displayed for a scale depends only on the multiplication factor of the scale.
+**
+*/
+void DMMSIM_SetInput(int32_t lAd1, uint32_t dwNoise)
+{
+    if(lAd1 > DMMSIM_AD1_MAX)
+    {
+        lAd1 = DMMSIM_AD1_MAX;
+    }
+    if(lAd1 < -DMMSIM_AD1_MAX)
+    {
+        lAd1 = -DMMSIM_AD1_MAX;
+    }
+    lInAd1 = lAd1;
+    dwInNoise = dwNoise;
+}
+
+/***	DMMSIM_SetCounterInput
+**
+**	Parameters:
+**      uint32_t dwFreq     - the input frequency (Hz)
+**      uint8_t bDuty       - the input duty cycle (%)
+**
+**	Return Value:
+**		none
+**
+**	Description:
+**		This function sets the signal measured by the counters, reported at the end of each gate window.
+**
+*/
+void DMMSIM_SetCounterInput(uint32_t dwFreq, uint8_t bDuty)
+{
+    dwInFreq = dwFreq;
+    bInDuty = (bDuty > 100) ? 100: bDuty;
+}
+
+/***	DMMSIM_SetStall
+**
+**	Parameters:
+**      uint8_t fStall      - 1 to stop the conversions, 0 to resume them
+**
+**	Return Value:
+**		none
+**
+**	Description:
+**		This function simulates a stalled chip: while stalled, no conversion, RMS window or gate window completes,
+**      so INTF and CTSTA stay 0. When resumed, the conversions due complete at the next chip select.
+**
+*/
+void DMMSIM_SetStall(uint8_t fStall)
+{
+    fStalled = fStall;
+}
+
+/***	DMMSIM_Select
+**
+**	Parameters:
+**      uint8_t fSelect     - 1 when the chip select becomes active, 0 when it becomes inactive
+**      uint32_t dwTime     - the virtual time (us)
+**
+**	Return Value:
+**		none
+**
+**	Description:
+**		This function is called on each change of the DMM chip select.
+**      Selecting the chip completes the conversions due until dwTime and starts a new SPI frame.
+**
+*/
+void DMMSIM_Select(uint8_t fSelect, uint32_t dwTime)
+{
+    if(fSelect && !fSelected)
+    {
+        DMMSIM_Update(dwTime);
+        cntBits = 0;
+        bShift = 0;
+        fRead = 0;
+        pReplayCur = NULL;
+        fReplayZero = 0;
+        cntTransfers++;
+    }
+    fSelected = fSelect;
+}
+
+/***	DMMSIM_ClockRise
+**
+**	Parameters:
+**      uint8_t bMosi       - the MOSI level
+**
+**	Return Value:
+**		none
+**
+**	Description:
+**		This function is called on each rising edge of the SPI clock while the chip is selected.
+**      The first 8 bits are the command byte. On write, each following byte is written to the
+**      current address. On read, one clock is skipped, then the registers are transmitted starting with the current address.
+**
+*/
+void DMMSIM_ClockRise(uint8_t bMosi)
+{
+    if(!fSelected)
+    {
+        return;
+    }
+    cntBits++;
+    if(cntBits <= 8)
+    {
+        // command byte
+        bShift = (bShift << 1) | (bMosi ? 1: 0);
+        if(cntBits == 8)
+        {
+            bAddr = bShift >> 1;
+            fRead = bShift & 1;
+            if(fRead && pReplayFrames)
+            {
+                if(idxReplay >= cntReplayFrames)
+                {
+                    fReplayZero = (bShift == pReplayFrames[cntReplayFrames - 1].bCmd);
+                }
+                else if(bShift == pReplayFrames[idxReplay].bCmd)
+                {
+                    pReplayCur = &pReplayFrames[idxReplay++];
+                    idxReplayByte = 0;
+                }
+            }
+        }
+        return;
+    }
+    if(fRead)
+    {
+        // bit 9 is the read period, data bits start with bit 10
+        if(cntBits >= 10 && ((cntBits - 10) & 7) == 0)
+        {
+            if(pReplayCur || fReplayZero)
+            {
+                bOut = (pReplayCur && idxReplayByte < pReplayCur->cb) ? pReplayCur->rgb[idxReplayByte++]: 0;
+                bAddr++;
+            }
+            else
+            {
+                bOut = DMMSIM_ReadRegister(bAddr++);
+            }
+        }
+    }
+    else
+    {
+        bShift = (bShift << 1) | (bMosi ? 1: 0);
+        if(((cntBits - 8) & 7) == 0)
+        {
+            DMMSIM_WriteRegister(bAddr++, bShift);
+        }
+    }
+}
+
+/***	DMMSIM_GetMiso
+**
+**	Parameters:
+**      none
+**
+**	Return Value:
+**		uint8_t     - the MISO level driven by the chip
+**
+**	Description:
+**		This function returns the data bit transmitted after the last rising edge of the SPI clock,
+**      or 0 when no data is transmitted.
+**
+*/
+uint8_t DMMSIM_GetMiso()
+{
+    if(!fSelected || !fRead || cntBits < 10)
+    {
+        return 0;
+    }
+    return (bOut >> (7 - ((cntBits - 10) & 7))) & 1;
+}
+
+/***	DMMSIM_GetRegister
+**
+**	Parameters:
+**      uint8_t bAddr       - the register address
+**
+**	Return Value:
+**		uint8_t     - the register value, 0 for an address outside the register file
+**
+**	Description:
+**		This function returns the value of a register, without the side effects of a SPI read.
+**
+*/
+uint8_t DMMSIM_GetRegister(uint8_t bAddr)
+{
+    return (bAddr < DMMSIM_CNTREGS) ? rgReg[bAddr]: 0;
+}
+
+/***	DMMSIM_GetTransferCount
+**
+**	Parameters:
+**      none
+**
+**	Return Value:
+**		uint32_t    - the number of SPI frames addressed to the chip
+**
+**	Description:
+**		This function returns the number of times the chip was selected since the start of the simulation.
+**
+*/
+uint32_t DMMSIM_GetTransferCount()
+{
+    return cntTransfers;
+}
+
+/***	DMMSIM_SetReplay
+**
+**	Parameters:
+**      const DMMSIM_FRAME *pFrames - the recorded read frames, in the order they were read. The array must be kept until the end of the replay.
+**      uint32_t cntFrames          - the number of frames, 0 to stop the replay
+**
+**	Return Value:
+**		none
+**
+**	Description:
+**		This function starts the replay of recorded read frames: each read frame having the command byte
+**      of the next recorded frame returns the recorded data bytes, then the next frame is selected.
+**      The other frames (writes, reads of other addresses) are served by the model.
+**
+*/
+void DMMSIM_SetReplay(const DMMSIM_FRAME *pFrames, uint32_t cntFrames)
+{
+    pReplayFrames = cntFrames ? pFrames: NULL;
+    cntReplayFrames = cntFrames;
+    idxReplay = 0;
+}
+
+/***	DMMSIM_FReplayEnd
+**
+**	Parameters:
+**      none
+**
+**	Return Value:
+**		uint8_t     - 1 if all the recorded frames were replayed, 0 otherwise or if no replay was started
+**
+*/
+uint8_t DMMSIM_FReplayEnd()
+{
+    return (pReplayFrames && idxReplay >= cntReplayFrames) ? 1: 0;
+}
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Local Functions                                                   */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/***	DMMSIM_Reset
+**
+**	Description:
+**		This function clears all the registers and restarts the conversions at the current time.
+**
+*/
+void DMMSIM_Reset()
+{
+    memset(rgReg, 0, sizeof(rgReg));
+    fPkhValid = 0;
+    cntRmsConv = 0;
+    dwNextAd1 = dwTimeNow + DMMSIM_GetPeriod();
+    dwNextCnt = dwTimeNow + DMMSIM_CNT_GATE;
+}
+
+/***	DMMSIM_GetPeriod
+**
+**	Return Value:
+**		uint32_t    - the AD1 conversion period (us) selected by the rate field of R22
+**
+*/
+uint32_t DMMSIM_GetPeriod()
+{
+    return (uint32_t)DMMSIM_AD1_BASEPERIOD << (rgReg[DMMSIM_ADR_RATE] & 7);
+}
+
+/***	DMMSIM_Update
+**
+**	Parameters:
+**      uint32_t dwTime     - the virtual time (us)
+**
+**	Description:
+**		This function completes the AD1 conversions, RMS windows and counter gate windows due until dwTime.
+**      When several conversions are due, only the last one is computed: the input does not change between them.
+**
+*/
+void DMMSIM_Update(uint32_t dwTime)
+{
+    uint32_t dwPeriod = DMMSIM_GetPeriod();
+    uint32_t cntConv;
+    dwTimeNow = dwTime;
+    if(fStalled)
+    {
+        return;
+    }
+    if((int32_t)(dwTime - dwNextAd1) >= 0)
+    {
+        cntConv = (dwTime - dwNextAd1) / dwPeriod + 1;
+        dwNextAd1 += cntConv * dwPeriod;
+        DMMSIM_Convert();
+        if(cntConv + cntRmsConv >= DMMSIM_RMS_PERIODS)
+        {
+            // square of the RMS value of the input code, in RMS units, 40 bits accumulator
+            double dRms = (double)lInAd1 / DMMSIM_RMS_CODEDIV;
+            uint64_t qwRms = (uint64_t)(dRms * dRms + 0.5);
+            int i;
+            if(qwRms > 0xFFFFFFFFFFull)
+            {
+                qwRms = 0xFFFFFFFFFFull;
+            }
+            for(i = 0; i < 5; i++)
+            {
+                rgReg[DMMSIM_ADR_RMS + i] = (uint8_t)(qwRms >> (8 * i));
+            }
+            rgReg[DMMSIM_ADR_INTF] |= DMMSIM_INTF_RMS;
+        }
+        cntRmsConv = (cntConv + cntRmsConv) % DMMSIM_RMS_PERIODS;
+    }
+    if((int32_t)(dwTime - dwNextCnt) >= 0)
+    {
+        uint32_t dwCta = (uint32_t)((uint64_t)DMMSIM_CNT_REFCLK * DMMSIM_CNT_GATE / 1000000);
+        dwNextCnt += ((dwTime - dwNextCnt) / DMMSIM_CNT_GATE + 1) * DMMSIM_CNT_GATE;
+        DMMSIM_SetReg24(DMMSIM_ADR_CTA, dwCta);
+        DMMSIM_SetReg24(DMMSIM_ADR_CTB, (uint32_t)((uint64_t)dwInFreq * DMMSIM_CNT_GATE / 1000000));
+        DMMSIM_SetReg24(DMMSIM_ADR_CTC, dwCta / 100 * bInDuty);
+        rgReg[DMMSIM_ADR_CTSTA] |= DMMSIM_CTSTA_READY;
+    }
+}
+
+/***	DMMSIM_Convert
+**
+**	Description:
+**		This function computes one AD1 conversion: the input code plus noise, stored in AD1 and AD2,
+**      the input code without noise stored in LPF, and the peak hold registers.
+**
+*/
+void DMMSIM_Convert()
+{
+    int32_t lCode = lInAd1;
+    if(dwInNoise)
+    {
+        // 16 bits Galois LFSR
+        dwLfsr = (dwLfsr >> 1) ^ (-(int32_t)(dwLfsr & 1) & 0xB400u);
+        lCode += (int32_t)(dwLfsr % (2 * dwInNoise + 1)) - (int32_t)dwInNoise;
+    }
+    if(lCode > DMMSIM_AD1_MAX)
+    {
+        lCode = DMMSIM_AD1_MAX;
+    }
+    if(lCode < -DMMSIM_AD1_MAX)
+    {
+        lCode = -DMMSIM_AD1_MAX;
+    }
+    DMMSIM_SetReg24(DMMSIM_ADR_AD1, (uint32_t)lCode);
+    DMMSIM_SetReg24(DMMSIM_ADR_AD2, (uint32_t)lCode);
+    DMMSIM_SetReg24(DMMSIM_ADR_LPF, (uint32_t)lInAd1);
+    if(!fPkhValid)
+    {
+        DMMSIM_SetReg24(DMMSIM_ADR_PKHMIN, (uint32_t)lCode);
+        DMMSIM_SetReg24(DMMSIM_ADR_PKHMAX, (uint32_t)lCode);
+        fPkhValid = 1;
+    }
+    else
+    {
+        int32_t lMin = ((int32_t)rgReg[DMMSIM_ADR_PKHMIN + 2] << 24 | (int32_t)rgReg[DMMSIM_ADR_PKHMIN + 1] << 16 | (int32_t)rgReg[DMMSIM_ADR_PKHMIN] << 8) / 256;
+        int32_t lMax = ((int32_t)rgReg[DMMSIM_ADR_PKHMAX + 2] << 24 | (int32_t)rgReg[DMMSIM_ADR_PKHMAX + 1] << 16 | (int32_t)rgReg[DMMSIM_ADR_PKHMAX] << 8) / 256;
+        if(lCode < lMin)
+        {
+            DMMSIM_SetReg24(DMMSIM_ADR_PKHMIN, (uint32_t)lCode);
+        }
+        if(lCode > lMax)
+        {
+            DMMSIM_SetReg24(DMMSIM_ADR_PKHMAX, (uint32_t)lCode);
+        }
+    }
+    rgReg[DMMSIM_ADR_INTF] |= DMMSIM_INTF_AD1;
+}
+
+/***	DMMSIM_WriteRegister
+**
+**	Parameters:
+**      uint8_t bAddr       - the register address
+**      uint8_t bVal        - the value written over SPI
+**
+**	Description:
+**		This function handles a register write: the reset register, or one of the configuration registers.
+**      The status registers (0x00 - 0x1E) are read only.
+**
+*/
+void DMMSIM_WriteRegister(uint8_t bAddr, uint8_t bVal)
+{
+    if(bAddr == DMMSIM_ADR_RESET)
+    {
+        if(bVal == DMMSIM_VAL_RESET)
+        {
+            DMMSIM_Reset();
+        }
+    }
+    else if(bAddr >= DMMSIM_ADR_CFG && bAddr < DMMSIM_ADR_RESET)
+    {
+        rgReg[bAddr] = bVal;
+    }
+}
+
+/***	DMMSIM_ReadRegister
+**
+**	Parameters:
+**      uint8_t bAddr       - the register address
+**
+**	Return Value:
+**		uint8_t     - the value transmitted over SPI
+**
+**	Description:
+**		This function handles a register read. The INTF and CTSTA flags are cleared once they are read.
+**
+*/
+uint8_t DMMSIM_ReadRegister(uint8_t bAddr)
+{
+    uint8_t bVal;
+    if(bAddr >= DMMSIM_CNTREGS)
+    {
+        return 0;
+    }
+    bVal = rgReg[bAddr];
+    if(bAddr == DMMSIM_ADR_INTF || bAddr == DMMSIM_ADR_CTSTA)
+    {
+        rgReg[bAddr] = 0;
+    }
+    return bVal;
+}
+
+/***	DMMSIM_SetReg24
+**
+**	Description:
+**		This function stores a 24 bits value in 3 consecutive registers, LS byte first.
+**
+*/
+void DMMSIM_SetReg24(uint8_t bAddr, uint32_t dwVal)
+{
+    rgReg[bAddr] = (uint8_t)dwVal;
+    rgReg[bAddr + 1] = (uint8_t)(dwVal >> 8);
+    rgReg[bAddr + 2] = (uint8_t)(dwVal >> 16);
+}
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,81 @@
+/* ************************************************************************** */
+/** Descriptive File Name
+
+  @Company
+    Digilent
+
+  @File Name
+    dmmsim.h
+
+  @Description
+        This file contains the declarations for the DMMSIM module functions.
+        The DMMSIM functions are defined in dmmsim.cpp source file.
+        It is built on the host (PC) as part of the simulation target, it is not part of the Arduino library.
+
+ */
+/* ************************************************************************** */
+
+#ifndef _DMMSIM_H    /* Guard against multiple inclusion */
+#define _DMMSIM_H
+
+#include <stdint.h>
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Constants                                                         */
+/* ************************************************************************** */
+#define DMMSIM_CNTREGS          0x38        // registers 0x00 - 0x37
+#define DMMSIM_ADR_CFG          0x1F        // first configuration register
+#define DMMSIM_ADR_RATE         0x22        // configuration register holding the AD1 output rate field (bits 2:0)
+#define DMMSIM_ADR_RESET        0x37        // reset register
+#define DMMSIM_VAL_RESET        0x60        // value resetting the chip when written to DMMSIM_ADR_RESET
+
+#define DMMSIM_AD1_BASEPERIOD   800         // AD1 conversion period (us) for a rate field of 0, doubled for each rate field step
+#define DMMSIM_RMS_PERIODS      4           // number of AD1 periods in a RMS window
+#define DMMSIM_CNT_GATE         100000      // counter gate window (us)
+
+#define DMMSIM_DEF_AD1          0x080000    // default AD1 input code, 1/16 of the convertor range (RMS not saturated)
+#define DMMSIM_DEF_NOISE        8           // default peak noise (LSB) added to the AD1 input code
+#define DMMSIM_DEF_FREQ         1000        // default counter input frequency (Hz)
+#define DMMSIM_DEF_DUTY         50          // default counter input duty cycle (%)
+
+#define DMMSIM_MAXFRAME         32          // data bytes of a replayed read frame (the status block 0x00 - 0x1F)
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+// a recorded read frame, served in place of the model registers (see DMMSIM_SetReplay)
+typedef struct _DMMSIM_FRAME{
+    uint8_t bCmd;                   // the command byte: 7 bits address, LSB 1 for read
+    uint8_t cb;                     // the number of data bytes
+    uint8_t rgb[DMMSIM_MAXFRAME];   // the data bytes
+} DMMSIM_FRAME;
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+// model configuration
+void DMMSIM_SetInput(int32_t lAd1, uint32_t dwNoise);
+void DMMSIM_SetCounterInput(uint32_t dwFreq, uint8_t bDuty);
+void DMMSIM_SetStall(uint8_t fStall);
+void DMMSIM_SetReplay(const DMMSIM_FRAME *pFrames, uint32_t cntFrames);
+uint8_t DMMSIM_FReplayEnd();
+
+// pin level events
+void DMMSIM_Select(uint8_t fSelect, uint32_t dwTime);
+void DMMSIM_ClockRise(uint8_t bMosi);
+uint8_t DMMSIM_GetMiso();
+
+// register file inspection
+uint8_t DMMSIM_GetRegister(uint8_t bAddr);
+uint32_t DMMSIM_GetTransferCount();
+
+#endif /* _DMMSIM_H */
+
+/* *****************************************************************************
+ End of File
+ */
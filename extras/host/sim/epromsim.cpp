@@ -0,0 +1,375 @@
+/* ************************************************************************** */
+/** Descriptive File Name
+
+  @Company
+    Digilent
+
+  @File Name
+    epromsim.cpp
+
+  @Description
+        The EPROMSIM module is a behavioural model of the 93Cx6 style Microwire EPROM of the DMMShield,
+        used by the host (PC) simulation target in place of the hardware.
+        The model is driven at pin level by arduino.cpp (chip select active high): after the start bit,
+        it decodes the 2 bits opcode and the 8 bits address sent by EPROM_StartBitOpAddr_Raw, then:
+        - READ (10): transmits the addressed word MSB first, continuing with the next addresses (sequential read).
+        - WRITE (01): programs the 16 data bits when the chip is deselected, if writing is enabled.
+        - ERASE (11): sets the addressed word to 0xFFFF when the chip is deselected, if writing is enabled.
+        - 00 with address 11xxxxxx / 00xxxxxx: write enable (EWEN) / write disable (EWDS),
+          10xxxxxx / 01xxxxxx: erase all (ERAL) / write all (WRAL).
+        A write or erase starts a self timed cycle of EPROMSIM_TWRITE us of virtual time: while it is in progress
+        the instructions are ignored and, with the chip selected and no instruction started, DO reports 0 (busy) instead of 1 (ready).
+        The memory is blank (0xFFFF) unless loaded from a file, where it is stored MS byte first.
+
+ */
+/* ************************************************************************** */
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+#include <stdio.h>
+#include "epromsim.h"
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Constants                                                         */
+/* ************************************************************************** */
+/* ************************************************************************** */
+#define EPROMSIM_OP_EXT         0x00
+#define EPROMSIM_OP_WRITE       0x01
+#define EPROMSIM_OP_READ        0x02
+#define EPROMSIM_OP_ERASE       0x03
+
+#define EPROMSIM_CNTHDRBITS     10          // opcode and address bits, following the start bit
+#define EPROMSIM_CNTCMDBITS     26          // opcode, address and data bits of WRITE / WRAL
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Local Functions Prototypes                                        */
+/* ************************************************************************** */
+/* ************************************************************************** */
+void EPROMSIM_Blank();
+void EPROMSIM_Execute(uint32_t dwTime);
+void EPROMSIM_Program(int idxStart, int cWords, uint16_t wVal, uint32_t dwTime);
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Global Variables                                                  */
+/* ************************************************************************** */
+/* ************************************************************************** */
+static uint16_t rgMem[EPROMSIM_CNTWORDS];
+static uint8_t fInitialized = 0;
+
+static uint8_t fSelected = 0;
+static uint8_t fStarted = 0;        // the start bit was received
+static uint8_t cntBits = 0;         // bits received after the start bit
+static uint8_t bOp = 0;
+static uint8_t bAddr = 0;
+static uint16_t wData = 0;
+static uint8_t fWriteEnabled = 0;
+static uint32_t dwBusyEnd = 0;      // the end of the self timed write cycle
+static uint32_t cntWrites = 0;
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/***	EPROMSIM_Load
+**
+**	Parameters:
+**      const char *szFile  - the image file, EPROMSIM_CNTWORDS words, MS byte first
+**
+**	Return Value:
+**		uint8_t
+**          0   - success
+**          1   - the file could not be read, the memory is blank
+**
+**	Description:
+**		This function loads the memory content from a file.
+**
+*/
+uint8_t EPROMSIM_Load(const char *szFile)
+{
+    uint8_t rgb[2 * EPROMSIM_CNTWORDS];
+    FILE *pFile = fopen(szFile, "rb");
+    int i;
+    if(!pFile || fread(rgb, 1, sizeof(rgb), pFile) != sizeof(rgb))
+    {
+        if(pFile)
+        {
+            fclose(pFile);
+        }
+        EPROMSIM_Blank();
+        return 1;
+    }
+    fclose(pFile);
+    for(i = 0; i < EPROMSIM_CNTWORDS; i++)
+    {
+        rgMem[i] = ((uint16_t)rgb[2 * i] << 8) | rgb[2 * i + 1];
+    }
+    fInitialized = 1;
+    return 0;
+}
+
+/***	EPROMSIM_Save
+**
+**	Parameters:
+**      const char *szFile  - the image file, EPROMSIM_CNTWORDS words, MS byte first
+**
+**	Return Value:
+**		uint8_t
+**          0   - success
+**          1   - the file could not be written
+**
+**	Description:
+**		This function saves the memory content to a file.
+**
+*/
+uint8_t EPROMSIM_Save(const char *szFile)
+{
+    uint8_t rgb[2 * EPROMSIM_CNTWORDS];
+    FILE *pFile = fopen(szFile, "wb");
+    uint8_t bResult;
+    int i;
+    if(!pFile)
+    {
+        return 1;
+    }
+    for(i = 0; i < EPROMSIM_CNTWORDS; i++)
+    {
+        rgb[2 * i] = rgMem[i] >> 8;
+        rgb[2 * i + 1] = rgMem[i] & 0xFF;
+    }
+    bResult = (fwrite(rgb, 1, sizeof(rgb), pFile) == sizeof(rgb)) ? 0: 1;
+    fclose(pFile);
+    return bResult;
+}
+
+/***	EPROMSIM_Select
+**
+**	Parameters:
+**      uint8_t fSelect     - 1 when the chip select becomes active (high), 0 when it becomes inactive
+**      uint32_t dwTime     - the virtual time (us)
+**
+**	Return Value:
+**		none
+**
+**	Description:
+**		This function is called on each change of the EPROM chip select.
+**      Deselecting the chip executes the WRITE, ERASE and extended instructions.
+**
+*/
+void EPROMSIM_Select(uint8_t fSelect, uint32_t dwTime)
+{
+    if(!fInitialized)
+    {
+        EPROMSIM_Blank();
+    }
+    if(fSelect && !fSelected)
+    {
+        fStarted = 0;
+        cntBits = 0;
+        bOp = 0;
+        bAddr = 0;
+        wData = 0;
+    }
+    if(!fSelect && fSelected && fStarted)
+    {
+        EPROMSIM_Execute(dwTime);
+    }
+    fSelected = fSelect;
+}
+
+/***	EPROMSIM_ClockRise
+**
+**	Parameters:
+**      uint8_t bDi         - the DI level
+**
+**	Return Value:
+**		none
+**
+**	Description:
+**		This function is called on each rising edge of the clock while the chip is selected.
+**      The leading zeros are ignored until the start bit, then the opcode, address and data bits are shifted in.
+**
+*/
+void EPROMSIM_ClockRise(uint8_t bDi)
+{
+    if(!fSelected)
+    {
+        return;
+    }
+    if(!fStarted)
+    {
+        fStarted = bDi ? 1: 0;
+        return;
+    }
+    if(cntBits < 0xFF)
+    {
+        cntBits++;
+    }
+    if(cntBits <= 2)
+    {
+        bOp = (bOp << 1) | (bDi ? 1: 0);
+    }
+    else if(cntBits <= EPROMSIM_CNTHDRBITS)
+    {
+        bAddr = (bAddr << 1) | (bDi ? 1: 0);
+    }
+    else if(cntBits <= EPROMSIM_CNTCMDBITS)
+    {
+        wData = (wData << 1) | (bDi ? 1: 0);
+    }
+}
+
+/***	EPROMSIM_GetDo
+**
+**	Parameters:
+**      uint32_t dwTime     - the virtual time (us)
+**
+**	Return Value:
+**		uint8_t     - the DO level driven by the chip
+**
+**	Description:
+**		This function returns the data bit transmitted by a READ instruction after the last rising edge of the clock,
+**      or the ready / busy status when the chip is selected and no instruction was started.
+**
+*/
+uint8_t EPROMSIM_GetDo(uint32_t dwTime)
+{
+    if(!fSelected)
+    {
+        return 0;
+    }
+    if(!fStarted)
+    {
+        return ((int32_t)(dwTime - dwBusyEnd) >= 0) ? 1: 0;
+    }
+    if((bOp & 3) == EPROMSIM_OP_READ && cntBits > EPROMSIM_CNTHDRBITS)
+    {
+        // the dummy 0 is sent with the last address bit, then the words MSB first
+        uint8_t k = cntBits - EPROMSIM_CNTHDRBITS - 1;
+        uint16_t w = rgMem[(uint8_t)(bAddr + k / 16)];
+        return (w >> (15 - (k % 16))) & 1;
+    }
+    return 0;
+}
+
+/***	EPROMSIM_GetWriteCount
+**
+**	Parameters:
+**      none
+**
+**	Return Value:
+**		uint32_t    - the number of write / erase cycles
+**
+**	Description:
+**		This function returns the number of self timed write or erase cycles since the start of the simulation.
+**
+*/
+uint32_t EPROMSIM_GetWriteCount()
+{
+    return cntWrites;
+}
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Local Functions                                                   */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/***	EPROMSIM_Blank
+**
+**	Description:
+**		This function sets all the words to 0xFFFF, the content of a blank (erased) memory.
+**
+*/
+void EPROMSIM_Blank()
+{
+    int i;
+    for(i = 0; i < EPROMSIM_CNTWORDS; i++)
+    {
+        rgMem[i] = 0xFFFF;
+    }
+    fInitialized = 1;
+}
+
+/***	EPROMSIM_Execute
+**
+**	Parameters:
+**      uint32_t dwTime     - the virtual time (us)
+**
+**	Description:
+**		This function executes the instruction received while the chip was selected.
+**      The instructions are ignored while a write cycle is in progress, or when they are incomplete.
+**
+*/
+void EPROMSIM_Execute(uint32_t dwTime)
+{
+    if((int32_t)(dwTime - dwBusyEnd) < 0 || cntBits < EPROMSIM_CNTHDRBITS)
+    {
+        return;
+    }
+    switch(bOp & 3)
+    {
+        case EPROMSIM_OP_WRITE:
+            if(cntBits >= EPROMSIM_CNTCMDBITS)
+            {
+                EPROMSIM_Program(bAddr, 1, wData, dwTime);
+            }
+            break;
+        case EPROMSIM_OP_ERASE:
+            EPROMSIM_Program(bAddr, 1, 0xFFFF, dwTime);
+            break;
+        case EPROMSIM_OP_EXT:
+            switch(bAddr >> 6)
+            {
+                case 3: // EWEN
+                    fWriteEnabled = 1;
+                    break;
+                case 0: // EWDS
+                    fWriteEnabled = 0;
+                    break;
+                case 2: // ERAL
+                    EPROMSIM_Program(0, EPROMSIM_CNTWORDS, 0xFFFF, dwTime);
+                    break;
+                case 1: // WRAL
+                    if(cntBits >= EPROMSIM_CNTCMDBITS)
+                    {
+                        EPROMSIM_Program(0, EPROMSIM_CNTWORDS, wData, dwTime);
+                    }
+                    break;
+            }
+            break;
+    }
+}
+
+/***	EPROMSIM_Program
+**
+**	Description:
+**		This function writes cWords words starting with idxStart and starts the self timed write cycle,
+**      if writing is enabled.
+**
+*/
+void EPROMSIM_Program(int idxStart, int cWords, uint16_t wVal, uint32_t dwTime)
+{
+    int i;
+    if(!fWriteEnabled)
+    {
+        return;
+    }
+    for(i = idxStart; i < idxStart + cWords && i < EPROMSIM_CNTWORDS; i++)
+    {
+        rgMem[i] = wVal;
+    }
+    dwBusyEnd = dwTime + EPROMSIM_TWRITE;
+    cntWrites++;
+}
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,50 @@
+/* ************************************************************************** */
+/** Descriptive File Name
+
+  @Company
+    Digilent
+
+  @File Name
+    epromsim.h
+
+  @Description
+        This file contains the declarations for the EPROMSIM module functions.
+        The EPROMSIM functions are defined in epromsim.cpp source file.
+        It is built on the host (PC) as part of the simulation target, it is not part of the Arduino library.
+
+ */
+/* ************************************************************************** */
+
+#ifndef _EPROMSIM_H    /* Guard against multiple inclusion */
+#define _EPROMSIM_H
+
+#include <stdint.h>
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Constants                                                         */
+/* ************************************************************************** */
+#define EPROMSIM_CNTWORDS       256         // 16 bits words, 8 bits address (as sent by EPROM_StartBitOpAddr_Raw)
+#define EPROMSIM_TWRITE         3000        // self timed write / erase cycle (us)
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+// content
+uint8_t EPROMSIM_Load(const char *szFile);
+uint8_t EPROMSIM_Save(const char *szFile);
+
+// pin level events
+void EPROMSIM_Select(uint8_t fSelect, uint32_t dwTime);
+void EPROMSIM_ClockRise(uint8_t bDi);
+uint8_t EPROMSIM_GetDo(uint32_t dwTime);
+
+uint32_t EPROMSIM_GetWriteCount();
+
+#endif /* _EPROMSIM_H */
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,26 @@
+/* ************************************************************************** */
+/** Descriptive File Name
+
+  @Company
+    Digilent
+
+  @File Name
+    itoa.h
+
+  @Description
+        Host (PC) stand-in for the <itoa.h> core header, used by the DMMSIM simulation target.
+        The functions are declared in Arduino.h and defined in arduino.cpp.
+
+ */
+/* ************************************************************************** */
+
+#ifndef _ITOA_H    /* Guard against multiple inclusion */
+#define _ITOA_H
+
+#include "Arduino.h"
+
+#endif /* _ITOA_H */
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,136 @@
+/* ************************************************************************** */
+/** Descriptive File Name
+
+  @Company
+    Digilent
+
+  @File Name
+    main.cpp
+
+  @Description
+        Entry point of the host (PC) simulation target (dmmsim).
+        It runs the setup and loop functions of the sketch linked with the library (by default the
+        DMMShieldDemo_CmdInterpreter example), with the DMM chip and the EPROM replaced by the DMMSIM and EPROMSIM models.
+        The commands are read from the standard input and the answers are written to the standard output.
+        When the standard input ends, the loop runs for the requested virtual time, then the simulation stops.
+        Usage:
+            dmmsim [-e eprom.bin] [-a ad1code] [-n noise] [-f freq] [-d duty] [-t ms] [-s]
+        -e  EPROM image, loaded at start if it exists and saved at the end
+        -a  AD1 input code (decimal or 0x hexadecimal), default DMMSIM_DEF_AD1
+        -n  peak noise added to the AD1 code (LSB), default DMMSIM_DEF_NOISE
+        -f  counter input frequency (Hz), default DMMSIM_DEF_FREQ
+        -d  counter input duty cycle (%), default DMMSIM_DEF_DUTY
+        -t  virtual time to run after the end of the input (ms), default 0
+        -s  print the simulation statistics on the standard error at the end
+        -h  print the usage
+
+ */
+/* ************************************************************************** */
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "Arduino.h"
+#include "sim.h"
+#include "dmmsim.h"
+#include "epromsim.h"
+
+// sketch functions
+void setup();
+void loop();
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Main                                                              */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+int main(int argc, char *argv[])
+{
+    const char *szEprom = NULL;
+    int32_t lAd1 = DMMSIM_DEF_AD1;
+    uint32_t dwNoise = DMMSIM_DEF_NOISE;
+    uint32_t dwFreq = DMMSIM_DEF_FREQ;
+    uint8_t bDuty = DMMSIM_DEF_DUTY;
+    uint64_t qwTailNs = 0;
+    uint64_t qwEndNs = 0;
+    uint8_t fStats = 0;
+    int opt;
+
+    while((opt = getopt(argc, argv, "e:a:n:f:d:t:sh")) != -1)
+    {
+        switch(opt)
+        {
+            case 'e':
+                szEprom = optarg;
+                break;
+            case 'a':
+                lAd1 = strtol(optarg, NULL, 0);
+                break;
+            case 'n':
+                dwNoise = strtoul(optarg, NULL, 0);
+                break;
+            case 'f':
+                dwFreq = strtoul(optarg, NULL, 0);
+                break;
+            case 'd':
+                bDuty = atoi(optarg);
+                break;
+            case 't':
+                qwTailNs = (uint64_t)strtoul(optarg, NULL, 0) * 1000000;
+                break;
+            case 's':
+                fStats = 1;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-e eprom.bin] [-a ad1code] [-n noise] [-f freq] [-d duty] [-t ms] [-s]\n", argv[0]);
+                return 2;
+        }
+    }
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    DMMSIM_SetInput(lAd1, dwNoise);
+    DMMSIM_SetCounterInput(dwFreq, bDuty);
+    if(szEprom && EPROMSIM_Load(szEprom))
+    {
+        fprintf(stderr, "dmmsim: %s not found, using a blank EPROM\n", szEprom);
+    }
+
+    setup();
+    while(1)
+    {
+        loop();
+        if(SIM_FInputEnd())
+        {
+            if(!qwEndNs)
+            {
+                qwEndNs = SIM_GetTimeNs() + qwTailNs;
+            }
+            if(SIM_GetTimeNs() >= qwEndNs)
+            {
+                break;
+            }
+        }
+    }
+    fflush(stdout);
+
+    if(szEprom && EPROMSIM_Save(szEprom))
+    {
+        fprintf(stderr, "dmmsim: cannot write %s\n", szEprom);
+    }
+    if(fStats)
+    {
+        fprintf(stderr, "virtual time: %.3f ms, digital IO: %lu, DMM SPI frames: %lu, EPROM writes: %lu\n",
+            SIM_GetTimeNs() / 1e6, (unsigned long)SIM_GetIOCount(),
+            (unsigned long)DMMSIM_GetTransferCount(), (unsigned long)EPROMSIM_GetWriteCount());
+    }
+    return 0;
+}
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,55 @@
+/* ************************************************************************** */
+/** Descriptive File Name
+
+  @Company
+    Digilent
+
+  @File Name
+    sim.h
+
+  @Description
+        This file contains the declarations for the SIM module functions: the virtual clock,
+        the pins and the serial input state of the host (PC) simulation target.
+        The SIM functions are defined in arduino.cpp source file, together with the Arduino core stand-ins.
+
+ */
+/* ************************************************************************** */
+
+#ifndef _SIM_H    /* Guard against multiple inclusion */
+#define _SIM_H
+
+#include <stdint.h>
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Constants                                                         */
+/* ************************************************************************** */
+// virtual time spent by the core functions, close to their duration on a 16 MHz Arduino Uno
+#define SIM_NS_DIGITALIO        4000        // digitalWrite, digitalRead
+#define SIM_NS_MICROS           1000        // micros, millis (so that the polling loops progress)
+#define SIM_NS_TIMER0           1024000     // Timer0 overflow period, the interrupt waking up sleep_cpu
+
+#define SIM_CNTPINS             20          // digital pins 0 - 13, analog pins 14 - 19
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+// virtual clock
+void SIM_Advance(uint32_t dwNs);
+uint64_t SIM_GetTimeNs();
+
+// pins
+void SIM_SetPin(uint8_t bPin, uint8_t bVal);
+uint8_t SIM_GetPin(uint8_t bPin);
+uint32_t SIM_GetIOCount();
+
+// serial input
+uint8_t SIM_FInputEnd();
+
+#endif /* _SIM_H */
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,306 @@
+/* ************************************************************************** */
+/** Descriptive File Name
+
+  @Company
+    Digilent
+
+  @File Name
+    filter.c
+
+  @Description
+        This file groups the functions that implement the FILTER module.
+        The FILTER module implements robust averaging filters (median, trimmed mean and Hampel)
+        applied on a window of samples, used to reject the occasional spikes (relay chatter, mains pickup) 
+        that would otherwise skew the average values.
+        All the filters work in place on the provided samples buffer (the order of the samples is altered) 
+        and use an O(n) selection algorithm instead of sorting the samples.
+        The FILTER functions are called from the DMM module.
+
+ */
+/* ************************************************************************** */
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+#include "math.h"
+#include "filter.h"
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Local Functions Prototypes                                        */
+/* ************************************************************************** */
+/* ************************************************************************** */
+double FILTER_Mean(double *prgVals, int cVals, uint8_t fQuadratic);
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/***	FILTER_Select
+**
+**	Parameters:
+**      double *prgVals     - the samples buffer
+**      int cVals           - the number of samples
+**      int k               - the rank of the requested sample (0 for the smallest)
+**      uint8_t fAbs        - 1 if the samples are compared by their absolute value, 0 otherwise
+**
+**	Return Value:
+**		double              - the k-th smallest sample
+**
+**	Description:
+**		This function implements the Hoare selection algorithm (quickselect), with average O(n) complexity.
+**      The samples are rearranged in place so that the k-th smallest sample is placed at index k, 
+**      the samples before it are not greater and the samples after it are not smaller.
+**      When fAbs is not 0 the samples are compared by their absolute value, still the returned sample keeps its sign.
+**            
+*/
+double FILTER_Select(double *prgVals, int cVals, int k, uint8_t fAbs)
+{
+    int lo = 0, hi = cVals - 1, i, j;
+    double dPivot, dTmp;
+    while(lo < hi)
+    {
+        dPivot = fAbs ? fabs(prgVals[(lo + hi) / 2]) : prgVals[(lo + hi) / 2];
+        i = lo;
+        j = hi;
+        do
+        {
+            while((fAbs ? fabs(prgVals[i]) : prgVals[i]) < dPivot)
+            {
+                i++;
+            }
+            while(dPivot < (fAbs ? fabs(prgVals[j]) : prgVals[j]))
+            {
+                j--;
+            }
+            if(i <= j)
+            {
+                dTmp = prgVals[i];
+                prgVals[i] = prgVals[j];
+                prgVals[j] = dTmp;
+                i++;
+                j--;
+            }
+        } while(i <= j);
+        // continue only in the partition containing the rank k
+        if(k <= j)
+        {
+            hi = j;
+        }
+        else
+        {
+            if(k >= i)
+            {
+                lo = i;
+            }
+            else
+            {
+                break;
+            }
+        }
+    }
+    return prgVals[k];
+}
+
+/***	FILTER_Median
+**
+**	Parameters:
+**      double *prgVals     - the samples buffer
+**      int cVals           - the number of samples
+**      uint8_t fAbs        - 1 to compute the median of the absolute values, 0 otherwise
+**
+**	Return Value:
+**		double              - the median value, NAN if there are no samples
+**
+**	Description:
+**		This function computes the median value of the samples, using FILTER_Select.
+**      For an even number of samples, the median is the average of the two middle samples.
+**      When fAbs is not 0 the median of the absolute values is computed.
+**      The order of the samples in the buffer is altered.
+**            
+*/
+double FILTER_Median(double *prgVals, int cVals, uint8_t fAbs)
+{
+    int i, k = cVals / 2;
+    double dMed, dLow, dVal;
+    if(cVals <= 0)
+    {
+        return NAN;
+    }
+    dMed = FILTER_Select(prgVals, cVals, k, fAbs);
+    if(fAbs)
+    {
+        dMed = fabs(dMed);
+    }
+    if(!(cVals & 1))
+    {
+        // even number of samples: the lower middle sample is the maximum of the lower partition
+        dLow = -INFINITY;
+        for(i = 0; i < k; i++)
+        {
+            dVal = fAbs ? fabs(prgVals[i]) : prgVals[i];
+            if(dVal > dLow)
+            {
+                dLow = dVal;
+            }
+        }
+        dMed = (dMed + dLow) / 2;
+    }
+    return dMed;
+}
+
+/***	FILTER_TrimmedMean
+**
+**	Parameters:
+**      double *prgVals     - the samples buffer
+**      int cVals           - the number of samples
+**      uint8_t fQuadratic  - 1 to compute the RMS (quadratic mean), 0 for arithmetic mean
+**
+**	Return Value:
+**		double              - the trimmed mean value, NAN if there are no samples
+**
+**	Description:
+**		This function computes the mean value of the samples after removing the lowest and highest 
+**      FILTER_TRIM_PERCENT percent of the samples. The samples to be removed are identified with two calls 
+**      of FILTER_Select, so no sorting is needed.
+**      The order of the samples in the buffer is altered.
+**            
+*/
+double FILTER_TrimmedMean(double *prgVals, int cVals, uint8_t fQuadratic)
+{
+    int cTrim = (cVals * FILTER_TRIM_PERCENT) / 100;
+    if(cTrim > 0)
+    {
+        // move the smallest cTrim samples at the beginning
+        FILTER_Select(prgVals, cVals, cTrim, 0);
+        // move the largest cTrim samples at the end
+        FILTER_Select(prgVals + cTrim, cVals - cTrim, cVals - 2 * cTrim, 0);
+    }
+    return FILTER_Mean(prgVals + cTrim, cVals - 2 * cTrim, fQuadratic);
+}
+
+/***	FILTER_Hampel
+**
+**	Parameters:
+**      double *prgVals     - the samples buffer
+**      int cVals           - the number of samples
+**      uint8_t fQuadratic  - 1 to compute the RMS (quadratic mean), 0 for arithmetic mean
+**
+**	Return Value:
+**		double              - the filtered mean value, NAN if there are no samples
+**
+**	Description:
+**		This function implements the Hampel filter over the samples window: 
+**      the median and the median absolute deviation (MAD) are computed, and the samples whose deviation 
+**      from the median exceeds FILTER_HAMPEL_K * FILTER_MAD_SCALE * MAD are considered outliers and replaced by the median.
+**      Then the mean value is computed.
+**      The buffer is used to store the deviations from the median, so its content is altered.
+**            
+*/
+double FILTER_Hampel(double *prgVals, int cVals, uint8_t fQuadratic)
+{
+    int i;
+    double dMed, dThreshold;
+    if(cVals <= 0)
+    {
+        return NAN;
+    }
+    dMed = FILTER_Median(prgVals, cVals, 0);
+    // replace the samples by their deviation from median
+    for(i = 0; i < cVals; i++)
+    {
+        prgVals[i] -= dMed;
+    }
+    dThreshold = FILTER_HAMPEL_K * FILTER_MAD_SCALE * FILTER_Median(prgVals, cVals, 1);
+    for(i = 0; i < cVals; i++)
+    {
+        if(fabs(prgVals[i]) > dThreshold)
+        {
+            // outlier, replace it by the median
+            prgVals[i] = 0;
+        }
+        prgVals[i] += dMed;
+    }
+    return FILTER_Mean(prgVals, cVals, fQuadratic);
+}
+
+/***	FILTER_Apply
+**
+**	Parameters:
+**      uint8_t bFilter     - the filter: FILTER_NONE, FILTER_MEDIAN, FILTER_TRIMMEDMEAN or FILTER_HAMPEL
+**      double *prgVals     - the samples buffer
+**      int cVals           - the number of samples
+**      uint8_t fQuadratic  - 1 to compute the RMS (quadratic mean), 0 for arithmetic mean
+**
+**	Return Value:
+**		double              - the filtered value, NAN if there are no samples
+**
+**	Description:
+**		This function applies the specified filter on the samples buffer and returns the filtered value.
+**      For FILTER_NONE (or unknown filters), the mean value of all the samples is returned.
+**      The fQuadratic parameter is ignored by the median filter.
+**            
+*/
+double FILTER_Apply(uint8_t bFilter, double *prgVals, int cVals, uint8_t fQuadratic)
+{
+    double dVal;
+    switch(bFilter)
+    {
+        case FILTER_MEDIAN:
+            dVal = FILTER_Median(prgVals, cVals, 0);
+            break;
+        case FILTER_TRIMMEDMEAN:
+            dVal = FILTER_TrimmedMean(prgVals, cVals, fQuadratic);
+            break;
+        case FILTER_HAMPEL:
+            dVal = FILTER_Hampel(prgVals, cVals, fQuadratic);
+            break;
+        default:
+            dVal = FILTER_Mean(prgVals, cVals, fQuadratic);
+            break;
+    }
+    return dVal;
+}
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Local Functions                                                   */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/***	FILTER_Mean
+**
+**	Parameters:
+**      double *prgVals     - the samples buffer
+**      int cVals           - the number of samples
+**      uint8_t fQuadratic  - 1 to compute the RMS (quadratic mean), 0 for arithmetic mean
+**
+**	Return Value:
+**		double              - the mean value, NAN if there are no samples
+**
+**	Description:
+**		This function computes the arithmetic mean or the RMS (quadratic mean) of the samples.
+**            
+*/
+double FILTER_Mean(double *prgVals, int cVals, uint8_t fQuadratic)
+{
+    int i;
+    double dSum = 0;
+    if(cVals <= 0)
+    {
+        return NAN;
+    }
+    for(i = 0; i < cVals; i++)
+    {
+        dSum += fQuadratic ? prgVals[i] * prgVals[i] : prgVals[i];
+    }
+    dSum /= cVals;
+    return fQuadratic ? sqrt(dSum) : dSum;
+}
+
+/* *****************************************************************************
+ End of File
+ */
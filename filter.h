@@ -0,0 +1,53 @@
+/* ************************************************************************** */
+/** Descriptive File Name
+
+  @Company
+    Digilent
+
+  @File Name
+    filter.h
+
+  @Description
+        This file contains the declarations for the FILTER module functions.
+        The FILTER functions are defined in filter.c source file.
+
+ */
+/* ************************************************************************** */
+
+#ifndef _FILTER_H    /* Guard against multiple inclusion */
+#define _FILTER_H
+
+#include "stdint.h"
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Constants                                                         */
+/* ************************************************************************** */
+// averaging filters
+#define FILTER_NONE             0   // plain average (arithmetic mean or RMS for AC scales)
+#define FILTER_MEDIAN           1   // median value
+#define FILTER_TRIMMEDMEAN      2   // average after removing the lowest and highest values
+#define FILTER_HAMPEL           3   // average after replacing the outliers with the median
+#define FILTER_CNT              4
+
+#define FILTER_MAX_SAMPLES      20  // the size of the samples buffer used by the filters
+#define FILTER_TRIM_PERCENT     10  // percent of samples removed from each end by the trimmed mean filter
+#define FILTER_HAMPEL_K         3   // outlier threshold of the Hampel filter, in scaled MAD units
+#define FILTER_MAD_SCALE        1.4826  // MAD to standard deviation factor, for normally distributed data
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+double FILTER_Select(double *prgVals, int cVals, int k, uint8_t fAbs);
+double FILTER_Median(double *prgVals, int cVals, uint8_t fAbs);
+double FILTER_TrimmedMean(double *prgVals, int cVals, uint8_t fQuadratic);
+double FILTER_Hampel(double *prgVals, int cVals, uint8_t fQuadratic);
+double FILTER_Apply(uint8_t bFilter, double *prgVals, int cVals, uint8_t fQuadratic);
+
+#endif /* _FILTER_H */
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,240 @@
+/* ************************************************************************** */
+/** Descriptive File Name
+
+  @Company
+    Digilent
+
+  @File Name
+    idle.c
+
+  @Description
+        The IDLE module implements the waits of the library: the wait for the DMM conversion results
+        (DMM_WaitConversion), for the EPROM write cycles (EPROM_WaitUntilReady_Raw) and the delays of the commands.
+        In IDLE_MODE_SLEEP (default), the MCU enters the idle sleep mode during the waits and wakes on the next interrupt:
+        the Timer0 overflow used by millis (every 1024 us on a 16 MHz Arduino), the serial reception or the trigger pin.
+        The idle sleep mode keeps the timers and the UART running, so the rest of the sketch is not affected.
+        An idle hook, set by the sketch, is called before each sleep.
+        The module reports the sleep duty cycle: the time spent asleep relative to the time elapsed since IDLE_ResetStats.
+        The sleep is available on the AVR boards (avr/sleep.h). Otherwise, the waits are busy loops calling yield.
+
+ */
+/* ************************************************************************** */
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+#include <Arduino.h>
+#include "idle.h"
+
+#ifndef IDLE_HAS_SLEEP
+#ifdef __AVR__
+#define IDLE_HAS_SLEEP          1
+#else
+#define IDLE_HAS_SLEEP          0
+#endif
+#endif
+
+#if IDLE_HAS_SLEEP
+#include <avr/sleep.h>
+#endif
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Global Variables                                                  */
+/* ************************************************************************** */
+/* ************************************************************************** */
+static uint8_t bIdleMode = IDLE_HAS_SLEEP ? IDLE_MODE_SLEEP: IDLE_MODE_BUSY;
+static void (*pfnIdleHook)() = NULL;
+// sleep duty cycle
+static uint32_t dwIdleStartMs = 0;      // millis() timestamp of IDLE_ResetStats
+static uint32_t dwIdleSleepMs = 0;      // time spent asleep, ms part
+static uint32_t dwIdleSleepUs = 0;       // time spent asleep, us below 1 ms
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/***	IDLE_SetMode
+**
+**	Parameters:
+**      uint8_t bMode   - IDLE_MODE_BUSY or IDLE_MODE_SLEEP
+**
+**	Return Value:
+**		none
+**
+**	Description:
+**		This function selects how the library waits. IDLE_MODE_SLEEP is ignored when the sleep is not available.
+**
+*/
+void IDLE_SetMode(uint8_t bMode)
+{
+    bIdleMode = (IDLE_HAS_SLEEP && bMode == IDLE_MODE_SLEEP) ? IDLE_MODE_SLEEP: IDLE_MODE_BUSY;
+}
+
+/***	IDLE_GetMode
+**
+**	Parameters:
+**      none
+**
+**	Return Value:
+**		uint8_t     - the idle mode: IDLE_MODE_BUSY or IDLE_MODE_SLEEP
+**
+*/
+uint8_t IDLE_GetMode()
+{
+    return bIdleMode;
+}
+
+/***	IDLE_SetHook
+**
+**	Parameters:
+**      void (*pfnHook)()   - the function called before each sleep, NULL for none
+**
+**	Return Value:
+**		none
+**
+**	Description:
+**		This function sets the idle hook, called repeatedly while the library waits, in both idle modes.
+**      The hook must return quickly (well below 1 ms), as the waits for the conversion results are scheduled
+**      shortly before the results are expected. It must not call the DMMShield library functions.
+**
+*/
+void IDLE_SetHook(void (*pfnHook)())
+{
+    pfnIdleHook = pfnHook;
+}
+
+/***	IDLE_Sleep
+**
+**	Parameters:
+**      none
+**
+**	Return Value:
+**		none
+**
+**	Description:
+**		This function calls the idle hook, then, in IDLE_MODE_SLEEP, sleeps until the next interrupt
+**      (at most the Timer0 overflow period). In IDLE_MODE_BUSY it only calls yield.
+**      It is called in the polling loops, between two polls.
+**
+*/
+void IDLE_Sleep()
+{
+    if(pfnIdleHook)
+    {
+        pfnIdleHook();
+    }
+#if IDLE_HAS_SLEEP
+    if(bIdleMode == IDLE_MODE_SLEEP)
+    {
+        uint32_t dwStart = micros();
+        set_sleep_mode(SLEEP_MODE_IDLE);
+        sleep_enable();
+        sleep_cpu();
+        sleep_disable();
+        // account the time spent asleep
+        dwIdleSleepUs += micros() - dwStart;
+        while(dwIdleSleepUs >= 1000)
+        {
+            dwIdleSleepUs -= 1000;
+            dwIdleSleepMs++;
+        }
+        return;
+    }
+#endif
+    yield();
+}
+
+/***	IDLE_Wait
+**
+**	Parameters:
+**      uint32_t dwStart    - micros() timestamp the wait is relative to
+**      uint32_t dwUs       - the wait duration (us), from dwStart
+**
+**	Return Value:
+**		none
+**
+**	Description:
+**		This function waits until dwUs us have passed since dwStart. It sleeps using IDLE_Sleep while more than
+**      IDLE_MINSLEEP us remain, so that the wake up is not late, then it completes the wait in a busy loop.
+**
+*/
+void IDLE_Wait(uint32_t dwStart, uint32_t dwUs)
+{
+    uint32_t dwElapsed;
+    while((dwElapsed = micros() - dwStart) < dwUs)
+    {
+        if(dwUs - dwElapsed > IDLE_MINSLEEP)
+        {
+            IDLE_Sleep();
+        }
+        else
+        {
+            yield();
+        }
+    }
+}
+
+/***	IDLE_Delay
+**
+**	Parameters:
+**      unsigned long ms    - the delay (ms)
+**
+**	Return Value:
+**		none
+**
+**	Description:
+**		This function replaces delay in the library, sleeping according to the idle mode (see IDLE_Wait).
+**
+*/
+void IDLE_Delay(unsigned long ms)
+{
+    IDLE_Wait(micros(), ms * 1000);
+}
+
+/***	IDLE_ResetStats
+**
+**	Parameters:
+**      none
+**
+**	Return Value:
+**		none
+**
+**	Description:
+**		This function restarts the measurement of the sleep duty cycle.
+**
+*/
+void IDLE_ResetStats()
+{
+    dwIdleStartMs = millis();
+    dwIdleSleepMs = 0;
+    dwIdleSleepUs = 0;
+}
+
+/***	IDLE_GetStats
+**
+**	Parameters:
+**      uint32_t *pdwSleepMs    - Pointer to the variable receiving the time spent asleep (ms)
+**      uint32_t *pdwElapsedMs  - Pointer to the variable receiving the time elapsed (ms)
+**
+**	Return Value:
+**		none
+**
+**	Description:
+**		This function returns the time spent asleep and the time elapsed since the start or since IDLE_ResetStats.
+**      Their ratio is the sleep duty cycle, i.e. the fraction of time the MCU current is reduced.
+**
+*/
+void IDLE_GetStats(uint32_t *pdwSleepMs, uint32_t *pdwElapsedMs)
+{
+    *pdwSleepMs = dwIdleSleepMs;
+    *pdwElapsedMs = millis() - dwIdleStartMs;
+}
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,54 @@
+/* ************************************************************************** */
+/** Descriptive File Name
+
+  @Company
+    Digilent
+
+  @File Name
+    idle.h
+
+  @Description
+        This file contains the declarations for the IDLE module functions.
+        The IDLE functions are defined in idle.c source file.
+
+ */
+/* ************************************************************************** */
+
+#ifndef _IDLE_H    /* Guard against multiple inclusion */
+#define _IDLE_H
+
+#include "stdint.h"
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Constants                                                         */
+/* ************************************************************************** */
+// idle modes, see IDLE_SetMode
+#define IDLE_MODE_BUSY          0       // the waits are busy loops calling yield
+#define IDLE_MODE_SLEEP         1       // the MCU sleeps (idle sleep mode) during the waits, when available (default)
+
+// the waits shorter than this are busy loops (us): the sleep ends at the next interrupt,
+// at the latest at the next Timer0 overflow (1024 us on a 16 MHz Arduino)
+#define IDLE_MINSLEEP           1100
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+void IDLE_SetMode(uint8_t bMode);
+uint8_t IDLE_GetMode();
+void IDLE_SetHook(void (*pfnHook)());
+
+void IDLE_Sleep();
+void IDLE_Wait(uint32_t dwStart, uint32_t dwUs);
+void IDLE_Delay(unsigned long ms);
+
+void IDLE_ResetStats();
+void IDLE_GetStats(uint32_t *pdwSleepMs, uint32_t *pdwElapsedMs);
+
+#endif /* _IDLE_H */
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,163 @@
+/* ************************************************************************** */
+/** Descriptive File Name
+
+  @Company
+    Digilent
+
+  @File Name
+    perfcnt.c
+
+  @Description
+        The PERFCNT module keeps the instrumentation counters of the library: event counters
+        (conversions ready / not ready, timeouts, verify failures) and min / avg / max accumulators
+        of sampled quantities (status polls per value, operation durations in us).
+        The counters are updated by the DMM, EPROM and DMMCMD modules through the PERFCNT_xxx macros,
+        which are empty when PERFCNT_ENABLE is 0: then the module takes no RAM and no time.
+        The counters are sent over UART by the DMMStats command.
+
+ */
+/* ************************************************************************** */
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+#include <Arduino.h>
+#include <string.h>
+#include "perfcnt.h"
+#include "errors.h"
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Global Variables                                                  */
+/* ************************************************************************** */
+/* ************************************************************************** */
+#if PERFCNT_ENABLE
+static uint32_t rgdwEvents[PERFCNT_CNTEVENTS];
+static PERFCNTSMP rgSamples[PERFCNT_CNTSAMPLES];
+#endif
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/***	PERFCNT_Reset
+**
+**	Parameters:
+**      none
+**
+**	Return Value:
+**		none
+**
+**	Description:
+**		This function clears all the counters.
+**
+*/
+void PERFCNT_Reset()
+{
+#if PERFCNT_ENABLE
+    memset(rgdwEvents, 0, sizeof(rgdwEvents));
+    memset(rgSamples, 0, sizeof(rgSamples));
+#endif
+}
+
+/***	PERFCNT_GetEvent
+**
+**	Parameters:
+**      uint8_t idxEvent    - the event counter index, one of the PERFCNT_EV_xxx definitions
+**
+**	Return Value:
+**		uint32_t    - the number of events since the start or since PERFCNT_Reset, 0 for a wrong index
+**                    or when the counters are not included in the build
+**
+*/
+uint32_t PERFCNT_GetEvent(uint8_t idxEvent)
+{
+#if PERFCNT_ENABLE
+    return (idxEvent < PERFCNT_CNTEVENTS) ? rgdwEvents[idxEvent]: 0;
+#else
+    return 0;
+#endif
+}
+
+/***	PERFCNT_GetSample
+**
+**	Parameters:
+**      uint8_t idxSample   - the sampled quantity index, one of the PERFCNT_SMP_xxx definitions
+**      PERFCNTSMP *pSmp    - Pointer to the structure receiving the accumulator
+**
+**	Return Value:
+**		uint8_t     - the error code
+**          ERRVAL_SUCCESS              0       // success
+**          ERRVAL_CMD_WRONGPARAMS      0xF9    // wrong index, or the counters are not included in the build
+**
+**	Description:
+**		This function copies the accumulator of a sampled quantity. The average is qwSum / cnt, when cnt is not 0.
+**
+*/
+uint8_t PERFCNT_GetSample(uint8_t idxSample, PERFCNTSMP *pSmp)
+{
+#if PERFCNT_ENABLE
+    if(idxSample < PERFCNT_CNTSAMPLES)
+    {
+        *pSmp = rgSamples[idxSample];
+        return ERRVAL_SUCCESS;
+    }
+#endif
+    return ERRVAL_CMD_WRONGPARAMS;
+}
+
+#if PERFCNT_ENABLE
+/***	PERFCNT_AddEvent
+**
+**	Parameters:
+**      uint8_t idxEvent    - the event counter index, one of the PERFCNT_EV_xxx definitions
+**
+**	Return Value:
+**		none
+**
+**	Description:
+**		This function counts an event. It is called through the PERFCNT_EVENT macro.
+**
+*/
+void PERFCNT_AddEvent(uint8_t idxEvent)
+{
+    rgdwEvents[idxEvent]++;
+}
+
+/***	PERFCNT_AddSample
+**
+**	Parameters:
+**      uint8_t idxSample   - the sampled quantity index, one of the PERFCNT_SMP_xxx definitions
+**      uint32_t dwVal      - the sample value
+**
+**	Return Value:
+**		none
+**
+**	Description:
+**		This function adds a sample to the min / avg / max accumulator.
+**      It is called through the PERFCNT_SAMPLE and PERFCNT_TIME_STOP macros.
+**
+*/
+void PERFCNT_AddSample(uint8_t idxSample, uint32_t dwVal)
+{
+    PERFCNTSMP *pSmp = &rgSamples[idxSample];
+    if(!pSmp->cnt || dwVal < pSmp->dwMin)
+    {
+        pSmp->dwMin = dwVal;
+    }
+    if(dwVal > pSmp->dwMax)
+    {
+        pSmp->dwMax = dwVal;
+    }
+    pSmp->qwSum += dwVal;
+    pSmp->cnt++;
+}
+#endif
+
+/* *****************************************************************************
+ End of File
+ */
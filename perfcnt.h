@@ -0,0 +1,88 @@
+/* ************************************************************************** */
+/** Descriptive File Name
+
+  @Company
+    Digilent
+
+  @File Name
+    perfcnt.h
+
+  @Description
+        This file contains the declarations for the PERFCNT module functions.
+        The PERFCNT functions are defined in perfcnt.c source file.
+
+ */
+/* ************************************************************************** */
+
+#ifndef _PERFCNT_H    /* Guard against multiple inclusion */
+#define _PERFCNT_H
+
+#include "stdint.h"
+#include "dmmconfig.h"
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Constants                                                         */
+/* ************************************************************************** */
+// PERFCNT_ENABLE (dmmconfig.h) 0 removes the counters from the build: the PERFCNT_xxx macros are empty
+// and the module takes no RAM
+
+// event counters
+#define PERFCNT_EV_CONVREADY        0   // status reads returning a conversion result
+#define PERFCNT_EV_CONVNOTREADY     1   // status reads without conversion result
+#define PERFCNT_EV_DATATIMEOUT      2   // DMM_DGetValue valid data timeouts
+#define PERFCNT_EV_CFGVERIFY        3   // scale configuration verify failures
+#define PERFCNT_EV_EPROMTIMEOUT     4   // EPROM write ready timeouts
+#define PERFCNT_EV_CMDUNKNOWN       5   // unrecognized commands
+#define PERFCNT_CNTEVENTS           6
+
+// sampled quantities, min / avg / max are kept
+#define PERFCNT_SMP_POLLS           0   // status reads per DMM_DGetValue call
+#define PERFCNT_SMP_GETVALUE        1   // DMM_DGetValue duration (us)
+#define PERFCNT_SMP_SETSCALE        2   // DMM_SetScale duration (us)
+#define PERFCNT_SMP_EPROMWAIT       3   // EPROM write cycle duration (us)
+#define PERFCNT_SMP_CMD             4   // command processing duration (us), without the delay following the answer
+#define PERFCNT_CNTSAMPLES          5
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+// min / avg / max accumulator of a sampled quantity
+typedef struct _PERFCNTSMP{
+    uint32_t cnt;       // number of samples
+    uint32_t dwMin;
+    uint32_t dwMax;
+    uint64_t qwSum;
+} PERFCNTSMP;
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+void PERFCNT_Reset();
+uint32_t PERFCNT_GetEvent(uint8_t idxEvent);
+uint8_t PERFCNT_GetSample(uint8_t idxSample, PERFCNTSMP *pSmp);
+
+#if PERFCNT_ENABLE
+void PERFCNT_AddEvent(uint8_t idxEvent);
+void PERFCNT_AddSample(uint8_t idxSample, uint32_t dwVal);
+#define PERFCNT_EVENT(idxEvent)                 PERFCNT_AddEvent(idxEvent)
+#define PERFCNT_SAMPLE(idxSample, dwVal)        PERFCNT_AddSample(idxSample, dwVal)
+// time measurement: PERFCNT_TIME_START declares the start time variable, PERFCNT_TIME_STOP samples the elapsed time
+#define PERFCNT_TIME_START(dwStart)             uint32_t dwStart = micros()
+#define PERFCNT_TIME_STOP(idxSample, dwStart)   PERFCNT_AddSample(idxSample, micros() - (dwStart))
+#else
+#define PERFCNT_EVENT(idxEvent)
+#define PERFCNT_SAMPLE(idxSample, dwVal)
+#define PERFCNT_TIME_START(dwStart)
+#define PERFCNT_TIME_STOP(idxSample, dwStart)
+#endif
+
+#endif /* _PERFCNT_H */
+
+/* *****************************************************************************
+ End of File
+ */
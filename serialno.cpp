@@ -13,6 +13,7 @@
         The "Interface functions" section groups functions that can also be called by user.
         The SERIALNO module provides functions for initialization and get serial number from EPROM.
         The module uses errors defined in ERRORS module.
+        The module is empty when DMMCONFIG_SERIALNO is 0 (dmmconfig.h).
 
   @Author
     Cristian Fatu 
@@ -30,6 +31,7 @@
 /* ************************************************************************** */
 #include <stdio.h>
 #include <string.h>
+#include "dmmconfig.h"
 #include "dmm.h"
 #include "errors.h"
 #include "eprom.h"
@@ -40,6 +42,7 @@
 /* Section: Global Variables                          \t\t\t              */
 /* ************************************************************************** */
 /* ************************************************************************** */
+#if DMMCONFIG_SERIALNO
 SERIALNODATA serialNo;
 
 /* ************************************************************************** */
@@ -119,6 +122,7 @@ uint8_t SERIALNO_ReadSerialNoFromEPROM(char *pSzSerialNo)
 	
     return ERRVAL_SUCCESS;
 }
+#endif
 
 
 /* *****************************************************************************
@@ -0,0 +1,512 @@
+/* ************************************************************************** */
+/** Descriptive File Name
+
+  @Company
+    Digilent
+
+  @File Name
+    trigger.c
+
+  @Description
+        This file groups the functions that implement the TRIGGER module.
+        The TRIGGER module captures a burst of DMM samples aligned to an event (trigger).
+        The trigger source can be immediate, an edge on a digital input pin, a software (bus) trigger
+        or a timer interval. While armed, the module keeps the last pre-trigger samples in a ring buffer.
+        Once the trigger is detected, the post-trigger samples are acquired back to back,
+        without returning to the main loop, so that their latency does not depend on the sketch.
+        Each sample carries the timestamp and sequence number of its conversion (see DMM_GetSample).
+        On boards where the trigger pin supports external interrupts, the edge is timestamped
+        in the interrupt handler, otherwise the pin is polled from TRIGGER_Process.
+        On an Arduino UNO the only external interrupt pins, 2 and 3, drive the DMMShield relays (RLI, RLU)
+        and are rejected by TRIGGER_SetSource, so the pin trigger is always polled there: the edge is detected
+        between two samples, with the latency of a conversion.
+        The TRIGGER functions call DMM module functions.
+
+ */
+/* ************************************************************************** */
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+#include <Arduino.h>
+#include "trigger.h"
+#include "dmm.h"
+#include "gpio.h"
+#include "idle.h"
+#include "errors.h"
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Global Data, local to this module                                 */
+/* ************************************************************************** */
+/* ************************************************************************** */
+uint8_t bTrigSrc = TRIGGER_SRC_IMMEDIATE;
+uint8_t bTrigPin, bTrigEdge, bTrigLevel;
+int8_t bTrigIntr = NOT_AN_INTERRUPT;   // external interrupt number of the trigger pin, NOT_AN_INTERRUPT if polled
+uint32_t dwTrigInterval = TRIGGER_MIN_INTERVAL;
+uint8_t bTrigState = TRIGGER_STATE_IDLE;
+uint8_t cbTrigPre, cbTrigPost;  // requested pre and post trigger samples
+uint8_t cntTrigPre, cntTrigPost;    // acquired pre and post trigger samples
+uint8_t idxTrigPre;             // position of the next pre-trigger sample in the ring buffer
+uint32_t dwTrigTime;            // trigger timestamp (micros)
+volatile uint8_t fTrigPending = 0;  // set by TRIGGER_Fire or by the pin interrupt handler
+volatile uint32_t dwTrigPending;    // timestamp of the pending trigger
+// the first cbTrigPre entries are the pre-trigger ring buffer, followed by the post-trigger samples
+DMMSAMPLE rgTrigSamples[TRIGGER_MAX_SAMPLES];
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Local Functions Prototypes                                        */
+/* ************************************************************************** */
+/* ************************************************************************** */
+void TRIGGER_PinISR();
+uint8_t TRIGGER_FCheckTrigger();
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/***	TRIGGER_SetSource
+**
+**	Parameters:
+**      uint8_t bSource         - the trigger source, one of TRIGGER_SRC_xxx
+**      uint8_t bPin            - the digital input pin, used for TRIGGER_SRC_PIN
+**      uint8_t bEdge           - TRIGGER_EDGE_RISING or TRIGGER_EDGE_FALLING, used for TRIGGER_SRC_PIN
+**      uint32_t dwInterval     - the interval in microseconds, used for TRIGGER_SRC_TIMER
+**
+**	Return Value:
+**		uint8_t     - the error code
+**          ERRVAL_SUCCESS              0       // success
+**          ERRVAL_CMD_WRONGPARAMS      0xF9    // wrong source, pin, edge or interval
+**
+**	Description:
+**		This function selects the trigger source. Any capture in progress is cancelled.
+**      The pins used by the DMMShield (relays and SPI) cannot be used as trigger pin.
+**      The pin is polled when it has no external interrupt, which is always the case on an Arduino UNO (see the module description).
+**      The timer interval must be at least TRIGGER_MIN_INTERVAL microseconds.
+**      The function returns ERRVAL_CMD_WRONGPARAMS if the parameters relevant for the source are not valid.
+**
+*/
+uint8_t TRIGGER_SetSource(uint8_t bSource, uint8_t bPin, uint8_t bEdge, uint32_t dwInterval)
+{
+    if(bSource >= TRIGGER_CNT_SRC)
+    {
+        return ERRVAL_CMD_WRONGPARAMS;
+    }
+    if(bSource == TRIGGER_SRC_PIN)
+    {
+        if(bEdge > TRIGGER_EDGE_FALLING || bPin == PIN_RLD || bPin == PIN_RLU || bPin == PIN_RLI ||
+            (bPin >= PIN_ESPI_SS && bPin <= PIN_SPI_CLK))
+        {
+            return ERRVAL_CMD_WRONGPARAMS;
+        }
+    }
+    if(bSource == TRIGGER_SRC_TIMER && dwInterval < TRIGGER_MIN_INTERVAL)
+    {
+        return ERRVAL_CMD_WRONGPARAMS;
+    }
+    TRIGGER_Disarm();
+    bTrigSrc = bSource;
+    if(bSource == TRIGGER_SRC_PIN)
+    {
+        bTrigPin = bPin;
+        bTrigEdge = bEdge;
+        bTrigIntr = digitalPinToInterrupt(bPin);
+        pinMode(bPin, INPUT);
+    }
+    if(bSource == TRIGGER_SRC_TIMER)
+    {
+        dwTrigInterval = dwInterval;
+    }
+    return ERRVAL_SUCCESS;
+}
+
+/***	TRIGGER_GetSource
+**
+**	Parameters:
+**      none
+**
+**	Return Value:
+**		uint8_t     - the selected trigger source, one of TRIGGER_SRC_xxx
+**
+**	Description:
+**		This function returns the selected trigger source.
+**
+*/
+uint8_t TRIGGER_GetSource()
+{
+    return bTrigSrc;
+}
+
+/***	TRIGGER_Arm
+**
+**	Parameters:
+**      uint8_t cbPre           - the number of samples kept from before the trigger
+**      uint8_t cbPost          - the number of samples acquired after the trigger
+**
+**	Return Value:
+**		uint8_t     - the error code
+**          ERRVAL_SUCCESS              0       // success
+**          ERRVAL_CMD_WRONGPARAMS      0xF9    // wrong sample counts
+**
+**	Description:
+**		This function arms the trigger for a new capture, discarding the samples of the previous one.
+**      The total number of samples must be between 1 and TRIGGER_MAX_SAMPLES.
+**      The immediate trigger source does not accept pre-trigger samples.
+**      The capture is then performed by TRIGGER_Process.
+**
+*/
+uint8_t TRIGGER_Arm(uint8_t cbPre, uint8_t cbPost)
+{
+    if((cbPre + cbPost) == 0 || (cbPre + cbPost) > TRIGGER_MAX_SAMPLES ||
+        (cbPre && bTrigSrc == TRIGGER_SRC_IMMEDIATE))
+    {
+        return ERRVAL_CMD_WRONGPARAMS;
+    }
+    TRIGGER_Disarm();
+    cbTrigPre = cbPre;
+    cbTrigPost = cbPost;
+    cntTrigPre = 0;
+    cntTrigPost = 0;
+    idxTrigPre = 0;
+    fTrigPending = 0;
+    if(bTrigSrc == TRIGGER_SRC_PIN)
+    {
+        bTrigLevel = digitalRead(bTrigPin);
+        if(bTrigIntr != NOT_AN_INTERRUPT)
+        {
+            attachInterrupt(bTrigIntr, TRIGGER_PinISR, bTrigEdge == TRIGGER_EDGE_RISING ? RISING: FALLING);
+        }
+    }
+    // the timer trigger uses dwTrigTime as the scheduled trigger time
+    dwTrigTime = micros() + dwTrigInterval;
+    bTrigState = TRIGGER_STATE_ARMED;
+    return ERRVAL_SUCCESS;
+}
+
+/***	TRIGGER_Disarm
+**
+**	Parameters:
+**      none
+**
+**	Return Value:
+**      none
+**
+**	Description:
+**		This function cancels the capture in progress, or releases a completed capture.
+**
+*/
+void TRIGGER_Disarm()
+{
+    if(bTrigState == TRIGGER_STATE_ARMED && bTrigSrc == TRIGGER_SRC_PIN && bTrigIntr != NOT_AN_INTERRUPT)
+    {
+        detachInterrupt(bTrigIntr);
+    }
+    bTrigState = TRIGGER_STATE_IDLE;
+}
+
+/***	TRIGGER_Fire
+**
+**	Parameters:
+**      none
+**
+**	Return Value:
+**      none
+**
+**	Description:
+**		This function generates the software (bus) trigger. The trigger time is taken when the function is called.
+**      It only takes effect when the bus trigger source is selected and the trigger is armed.
+**      The function can be called from an interrupt handler.
+**
+*/
+void TRIGGER_Fire()
+{
+    if(bTrigState == TRIGGER_STATE_ARMED && bTrigSrc == TRIGGER_SRC_BUS && !fTrigPending)
+    {
+        dwTrigPending = micros();
+        fTrigPending = 1;
+    }
+}
+
+/***	TRIGGER_Process
+**
+**	Parameters:
+**      uint8_t *pbErr          - Pointer to the error parameter, the error code is stored here when the capture fails
+**
+**	Return Value:
+**		uint8_t     - the capture state, one of TRIGGER_STATE_xxx
+**
+**	Description:
+**		This function advances the capture and must be called repeatedly while the trigger is armed.
+**      At each call it checks the trigger, then, while the trigger is not detected, it acquires one pre-trigger sample 
+**      (when pre-trigger samples are requested).
+**      When the trigger is detected, all the post-trigger samples are acquired before returning.
+**      The trigger is checked again after each pre-trigger sample, as an interrupt (pin interrupt handler or TRIGGER_Fire) 
+**      can signal it while the sample is acquired: the sample is then classified by its timestamp against the trigger timestamp,
+**      a result read after the trigger being the first post-trigger sample (dropped when no post-trigger samples are requested).
+**      For the timer source, the post-trigger samples are spaced by the timer interval, starting at the trigger time,
+**      sleeping between them (see IDLE_Wait).
+**      If a sample cannot be acquired, the capture is cancelled, the error code is stored in pbErr
+**      and TRIGGER_STATE_IDLE is returned.
+**      The function returns immediately when the trigger is not armed.
+**
+*/
+uint8_t TRIGGER_Process(uint8_t *pbErr)
+{
+    uint8_t bErrCode = ERRVAL_SUCCESS;
+    uint32_t dwNext;
+    uint8_t fTrig;
+    DMMSAMPLE smp;
+    if(bTrigState != TRIGGER_STATE_ARMED)
+    {
+        return bTrigState;
+    }
+    // the trigger is checked first, so that no pre-trigger sample is acquired after the trigger instant
+    fTrig = TRIGGER_FCheckTrigger();
+    if(!fTrig && cbTrigPre)
+    {
+        bErrCode = DMM_GetSample(&smp);
+        // the trigger can be signaled by an interrupt during the sample, its timestamp tells on which side the sample is
+        fTrig = TRIGGER_FCheckTrigger();
+        if(!fTrig || (int32_t)(smp.dwTime - dwTrigTime) <= 0)
+        {
+            rgTrigSamples[idxTrigPre] = smp;
+            if(++idxTrigPre >= cbTrigPre)
+            {
+                idxTrigPre = 0;
+            }
+            if(cntTrigPre < cbTrigPre)
+            {
+                cntTrigPre++;
+            }
+        }
+        else if(cbTrigPost)
+        {
+            // the result was read after the trigger, it is the first post-trigger sample
+            rgTrigSamples[cbTrigPre] = smp;
+            cntTrigPost = 1;
+        }
+    }
+    if(bErrCode == ERRVAL_SUCCESS && fTrig)
+    {
+        dwNext = dwTrigTime + cntTrigPost * dwTrigInterval;
+        while(bErrCode == ERRVAL_SUCCESS && cntTrigPost < cbTrigPost)
+        {
+            if(bTrigSrc == TRIGGER_SRC_TIMER)
+            {
+                // sleep until the scheduled sample time
+                IDLE_Wait(dwNext - dwTrigInterval, dwTrigInterval);
+                dwNext += dwTrigInterval;
+            }
+            bErrCode = DMM_GetSample(&rgTrigSamples[cbTrigPre + cntTrigPost]);
+            cntTrigPost++;
+        }
+        if(bErrCode == ERRVAL_SUCCESS)
+        {
+            TRIGGER_Disarm();
+            bTrigState = TRIGGER_STATE_DONE;
+        }
+    }
+    if(bErrCode != ERRVAL_SUCCESS)
+    {
+        TRIGGER_Disarm();
+        if(pbErr)
+        {
+            *pbErr = bErrCode;
+        }
+    }
+    return bTrigState;
+}
+
+/***	TRIGGER_GetState
+**
+**	Parameters:
+**      none
+**
+**	Return Value:
+**		uint8_t     - the capture state, one of TRIGGER_STATE_xxx
+**
+**	Description:
+**		This function returns the capture state.
+**
+*/
+uint8_t TRIGGER_GetState()
+{
+    return bTrigState;
+}
+
+/***	TRIGGER_GetCount
+**
+**	Parameters:
+**      none
+**
+**	Return Value:
+**		uint8_t     - the number of samples of the completed capture
+**
+**	Description:
+**		This function returns the number of samples (pre and post trigger) of the completed capture,
+**      or 0 if no capture is completed.
+**
+*/
+uint8_t TRIGGER_GetCount()
+{
+    return (bTrigState == TRIGGER_STATE_DONE) ? (cntTrigPre + cntTrigPost): 0;
+}
+
+/***	TRIGGER_GetPreCount
+**
+**	Parameters:
+**      none
+**
+**	Return Value:
+**		uint8_t     - the number of pre-trigger samples of the completed capture
+**
+**	Description:
+**		This function returns the number of pre-trigger samples of the completed capture, which can be smaller
+**      than the requested one if the trigger came before the ring buffer was filled.
+**      The pre-trigger samples are the first ones returned by TRIGGER_GetSample.
+**
+*/
+uint8_t TRIGGER_GetPreCount()
+{
+    return (bTrigState == TRIGGER_STATE_DONE) ? cntTrigPre: 0;
+}
+
+/***	TRIGGER_GetTriggerTime
+**
+**	Parameters:
+**      none
+**
+**	Return Value:
+**		uint32_t    - the trigger timestamp (micros)
+**
+**	Description:
+**		This function returns the timestamp of the trigger of the completed capture.
+**      For the pin source it is taken in the interrupt handler, or when the edge was polled.
+**
+*/
+uint32_t TRIGGER_GetTriggerTime()
+{
+    return dwTrigTime;
+}
+
+/***	TRIGGER_GetSample
+**
+**	Parameters:
+**      uint8_t idx             - the sample index, 0 for the oldest sample
+**      DMMSAMPLE *pSample     - Pointer to the sample structure to be filled
+**
+**	Return Value:
+**		uint8_t     - the error code
+**          ERRVAL_SUCCESS              0       // success
+**          ERRVAL_CMD_WRONGPARAMS      0xF9    // no completed capture or wrong index
+**
+**	Description:
+**		This function retrieves one sample of the completed capture, in chronological order:
+**      the pre-trigger samples followed by the post-trigger samples.
+**
+*/
+uint8_t TRIGGER_GetSample(uint8_t idx, DMMSAMPLE *pSample)
+{
+    if(idx >= TRIGGER_GetCount())
+    {
+        return ERRVAL_CMD_WRONGPARAMS;
+    }
+    if(idx < cntTrigPre)
+    {
+        // the oldest pre-trigger sample follows the last written one in the ring buffer
+        idx = (idxTrigPre + cbTrigPre - cntTrigPre + idx) % cbTrigPre;
+    }
+    else
+    {
+        idx = cbTrigPre + idx - cntTrigPre;
+    }
+    *pSample = rgTrigSamples[idx];
+    return ERRVAL_SUCCESS;
+}
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Local Functions                                                   */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/***	TRIGGER_PinISR
+**
+**	Parameters:
+**      none
+**
+**	Return Value:
+**      none
+**
+**	Description:
+**		This function is the external interrupt handler of the trigger pin. It timestamps the first edge.
+**
+*/
+void TRIGGER_PinISR()
+{
+    if(!fTrigPending)
+    {
+        dwTrigPending = micros();
+        fTrigPending = 1;
+    }
+}
+
+/***	TRIGGER_FCheckTrigger
+**
+**	Parameters:
+**      none
+**
+**	Return Value:
+**		uint8_t     - 1 if the trigger was detected, 0 otherwise
+**
+**	Description:
+**		This function checks the selected trigger source and sets the trigger timestamp when the trigger is detected.
+**      For the timer source, the timestamp is the scheduled trigger time.
+**
+*/
+uint8_t TRIGGER_FCheckTrigger()
+{
+    uint8_t bLevel;
+    uint8_t fTrig = 0;
+    switch(bTrigSrc)
+    {
+        case TRIGGER_SRC_IMMEDIATE:
+            dwTrigTime = micros();
+            fTrig = 1;
+            break;
+        case TRIGGER_SRC_PIN:
+            if(bTrigIntr == NOT_AN_INTERRUPT)
+            {
+                bLevel = digitalRead(bTrigPin);
+                if(bLevel != bTrigLevel && bLevel == (bTrigEdge == TRIGGER_EDGE_RISING ? HIGH: LOW))
+                {
+                    dwTrigPending = micros();
+                    fTrigPending = 1;
+                }
+                bTrigLevel = bLevel;
+            }
+            // the edge is signaled as a pending trigger
+            __attribute__((fallthrough));
+        case TRIGGER_SRC_BUS:
+            noInterrupts();
+            if(fTrigPending)
+            {
+                dwTrigTime = dwTrigPending;
+                fTrig = 1;
+            }
+            interrupts();
+            break;
+        case TRIGGER_SRC_TIMER:
+            fTrig = ((int32_t)(micros() - dwTrigTime) >= 0);
+            break;
+    }
+    return fTrig;
+}
+
+/* *****************************************************************************
+ End of File
+ */
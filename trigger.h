@@ -0,0 +1,67 @@
+/* ************************************************************************** */
+/** Descriptive File Name
+
+  @Company
+    Digilent
+
+  @File Name
+    trigger.h
+
+  @Description
+        This file contains the declarations for the TRIGGER module functions.
+        The TRIGGER functions are defined in trigger.c source file.
+
+ */
+/* ************************************************************************** */
+
+#ifndef _TRIGGER_H    /* Guard against multiple inclusion */
+#define _TRIGGER_H
+
+#include "stdint.h"
+#include "dmm.h"
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Constants                                                         */
+/* ************************************************************************** */
+// trigger sources
+#define TRIGGER_SRC_IMMEDIATE       0   // the capture starts as soon as it is armed
+#define TRIGGER_SRC_PIN             1   // the capture starts on an edge of a digital input pin
+#define TRIGGER_SRC_BUS             2   // the capture starts when TRIGGER_Fire is called (sketch code or DMMTriggerFire command)
+#define TRIGGER_SRC_TIMER           3   // the capture starts one interval after arming, the samples are spaced by the interval
+#define TRIGGER_CNT_SRC             4
+
+// pin trigger edges
+#define TRIGGER_EDGE_RISING         0
+#define TRIGGER_EDGE_FALLING        1
+
+// capture states
+#define TRIGGER_STATE_IDLE          0   // not armed
+#define TRIGGER_STATE_ARMED         1   // armed, acquiring the pre-trigger samples and waiting for the trigger
+#define TRIGGER_STATE_DONE          2   // the capture is complete, the samples can be retrieved
+
+#define TRIGGER_MAX_SAMPLES         16  // the total number of pre and post trigger samples
+#define TRIGGER_MIN_INTERVAL        1000    // minimum timer interval (us)
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+uint8_t TRIGGER_SetSource(uint8_t bSource, uint8_t bPin, uint8_t bEdge, uint32_t dwInterval);
+uint8_t TRIGGER_GetSource();
+uint8_t TRIGGER_Arm(uint8_t cbPre, uint8_t cbPost);
+void TRIGGER_Disarm();
+void TRIGGER_Fire();
+uint8_t TRIGGER_Process(uint8_t *pbErr);
+uint8_t TRIGGER_GetState();
+uint8_t TRIGGER_GetCount();
+uint8_t TRIGGER_GetPreCount();
+uint32_t TRIGGER_GetTriggerTime();
+uint8_t TRIGGER_GetSample(uint8_t idx, DMMSAMPLE *pSample);
+
+#endif /* _TRIGGER_H */
+
+/* *****************************************************************************
+ End of File
+ */
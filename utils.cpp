@@ -36,6 +36,12 @@
 
 #include "utils.h"
 
+/* ************************************************************************** */
+// powers of 10, used to scale the fractional part
+const static PROGMEM uint32_t rgPow10[UTILS_MAX_PRECISION + 1] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+char *UTILS_PutDigits(char *pDigit, uint32_t val, uint8_t cDigits);
+
 /* ************************************************************************** */
 
 /* ------------------------------------------------------------ */
@@ -74,7 +80,7 @@ uint8_t GetBufferChecksum(uint8_t *pBuf, int len)
 }
 
 /* ------------------------------------------------------------ */
-/***    GetBufferChecksum
+/***    SPrintfDouble
 **
 **	Synopsis:
 **		SPrintfDouble(szMsg, dMeasuredVal, 6)
@@ -82,57 +88,129 @@ uint8_t GetBufferChecksum(uint8_t *pBuf, int len)
 **	Parameters:
 **		char *pString 			- the string where the double value will be printed
 **		double dVal				- the value to be printed
-**		unsigned char precision	- precision: the umber of digits to be considered after decimal point 
+**		unsigned char precision	- precision: the umber of digits to be considered after decimal point, at most UTILS_MAX_PRECISION
 **      
 **	Return Values:
-**      none
+**      the length of the printed string
 **
 **	Errors:
 **		none
 **
 **	Description:
-**		This function prints the provided value in a string. It individually prints the integer and fractional part of the number. 
+**		This function prints the provided value in a string, with the requested number of decimals (rounded).
+**		The value is split in two 32 bits integers (integer part and scaled fractional part), whose digits are
+**		generated right to left and then copied in a single pass in pString, so no strlen / strcat are needed.
+**		Values whose integer part exceeds 32 bits are printed as "OVF", not a number values as "NAN".
 **		The function was implemented because sprintf lacks the capability of printing double values in Arduino.
 **
 */
 uint8_t SPrintfDouble(char *pString, double dVal, uint8_t precision)
 {
-	uint8_t i, lenInt;
-	uint32_t fract, precisionFactor;
-	// 1. Print the integer part
-	itoa(int(dVal), pString, 10);
-	lenInt = strlen(pString);
-
-	// 2. Print decimal point
-	pString[lenInt] = '.';
-
-	// 3. Print the fractional part
-	// 3.1. Compute precision factor (10 power precision)
-	precisionFactor = 1;
-	for(i = 0; i < precision; i++)
+	char rgDigits[UTILS_MAX_PRECISION + 10];	// integer and fractional digits, least significant first
+	char *pDigit;
+	char *pDst = pString;
+	uint32_t intPart, fract, precisionFactor;
+	uint8_t fNeg = 0;
+	if(dVal != dVal)
+	{
+		strcpy(pString, "NAN");
+		return 3;
+	}
+	if(dVal < 0)
+	{
+		fNeg = 1;
+		dVal = -dVal;
+	}
+	if(dVal >= 4294967295.0)
 	{
-		precisionFactor *= 10;
+		strcpy(pString, fNeg ? "-OVF": "OVF");
+		return 3 + fNeg;
 	}
-	
-	// 3.2. Compute fractional part as integer (fractional part multiplied by precision factor)
-	if(dVal >= 0)
+	if(precision > UTILS_MAX_PRECISION)
 	{
-		fract = (dVal - int(dVal)) * precisionFactor;
+		precision = UTILS_MAX_PRECISION;
 	}
-	else
+	// 1. Split the value in integer part and rounded fractional part, multiplied by 10 power precision
+	precisionFactor = pgm_read_dword(&rgPow10[precision]);
+	intPart = (uint32_t)dVal;
+	fract = (uint32_t)((dVal - intPart) * precisionFactor + 0.5);
+	if(fract >= precisionFactor)
 	{
-		fract = (int(dVal)- dVal ) * precisionFactor;
+		// the rounding carries into the integer part
+		fract -= precisionFactor;
+		intPart++;
 	}
-	// 3.3. Print the fractional part in the string, starting with the right part and padding left (until decimal point) with leading 0s. 
-	// For example if fract = 12, then the string will be filled with 000012 after decimal point
-	for(i = precision; i > 0; i--)
+	// 2. Generate the digits, the fractional part padded with leading 0s
+	pDigit = precision ? UTILS_PutDigits(rgDigits, fract, precision): rgDigits;
+	pDigit = UTILS_PutDigits(pDigit, intPart, 1);
+
+	// 3. Copy the digits in the string, most significant first. Do not print the sign of a value rounded to 0.
+	if(fNeg && (intPart || fract))
+	{
+		*pDst++ = '-';
+	}
+	while(pDigit > rgDigits + precision)
+	{
+		*pDst++ = *--pDigit;
+	}
+	if(precision)
 	{
-		pString[lenInt + i] = '0' + (fract % 10);
-		fract /= 10;
+		*pDst++ = '.';
+		while(pDigit > rgDigits)
+		{
+			*pDst++ = *--pDigit;
+		}
 	}
 	// 4. Place the terminating 0;
-	pString[lenInt + precision + 1] = 0;
-	return lenInt + precision + 1;
+	*pDst = 0;
+	return pDst - pString;
+}
+
+/* ------------------------------------------------------------ */
+/***    UTILS_PutDigits
+**
+**	Parameters:
+**		char *pDigit 			- the buffer where the digits are placed, least significant first
+**		uint32_t val			- the value to be printed
+**		uint8_t cDigits			- the minimum number of digits, the value is padded with 0s
+**      
+**	Return Values:
+**      the position after the last placed digit
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		This function places the decimal digits of val in the buffer, starting with the least significant one.
+**		Once the value fits 16 bits, the 16 bits division is used, which is much faster than the 32 bits one on AVR.
+**
+*/
+char *UTILS_PutDigits(char *pDigit, uint32_t val, uint8_t cDigits)
+{
+	uint32_t q;
+	uint16_t w, wq;
+	while(val > 0xFFFF)
+	{
+		q = val / 10;
+		*pDigit++ = '0' + (uint8_t)(val - q * 10);
+		val = q;
+		if(cDigits)
+		{
+			cDigits--;
+		}
+	}
+	w = (uint16_t)val;
+	do
+	{
+		wq = w / 10;
+		*pDigit++ = '0' + (uint8_t)(w - wq * 10);
+		w = wq;
+		if(cDigits)
+		{
+			cDigits--;
+		}
+	} while(w || cDigits);
+	return pDigit;
 }
 
 /* *****************************************************************************
@@ -29,6 +29,7 @@ unsigned char GetBufferChecksum(uint8_t *pBuf, int len);
 uint8_t SPrintfDouble(char *pString, double dVal, uint8_t precision);
 
 /************************** Constant Definitions *****************************/
+#define UTILS_MAX_PRECISION     9   // maximum number of decimals printed by SPrintfDouble
 
 
 /***************** Macros (Inline Functions) Definitions *********************/